@@ -0,0 +1,149 @@
+# frozen_string_literal: true
+
+# Minimal benchmark harness for the bench/ suites.
+#
+# Each benchmark is a block that performs +n+ operations; the harness
+# picks +n+ so one batch takes roughly BATCH_SECONDS, warms up, then
+# times batches until BENCH_TIME seconds have passed. Each batch gives
+# one average time per op; those are summarized as mean/median/p95/min/max
+# nanoseconds, and the whole run is written as JSON so results from
+# different commits can be compared with `rake bench:compare`.
+#
+# Environment:
+#   BENCH=regex      only run benchmarks whose name matches
+#   BENCH_TIME=secs  measuring time per benchmark (default 1.0)
+#   BENCH_OUT=path   JSON output path (default tmp/bench/<suite>-<commit>.json)
+
+require 'json'
+require 'time'
+require 'etc'
+require 'fileutils'
+
+module TeekBench
+  BATCH_SECONDS = 0.01
+  WARMUP_SECONDS = 0.2
+
+  class Suite
+    attr_reader :name, :results
+
+    def initialize(name)
+      @name = name
+      @results = []
+      @filter = ENV['BENCH'] && Regexp.new(ENV['BENCH'])
+      @measure_time = Float(ENV.fetch('BENCH_TIME', '1.0'))
+      @meta = {}
+    end
+
+    # Extra metadata for the JSON header (Tcl/Tk versions, ...).
+    def meta(**info)
+      @meta.merge!(info)
+    end
+
+    # Time a block that performs +n+ operations per call.
+    #
+    # @param name [String] benchmark name, e.g. "tcl_eval"
+    # @param group [Symbol] :micro or :macro
+    # @param params [Hash] recorded with the result (sizes, counts)
+    # @yield [n] perform n operations
+    def measure(name, group: :micro, **params, &block)
+      return if @filter && !@filter.match?(name)
+
+      n = calibrate(&block)
+      warm_until = now + WARMUP_SECONDS
+      block.call(n) while now < warm_until
+
+      samples = []
+      stop_at = now + @measure_time
+      while now < stop_at || samples.size < 3
+        t0 = now
+        block.call(n)
+        samples << (now - t0) * 1e9 / n
+      end
+
+      result = summarize(name, group, params, n, samples)
+      @results << result
+      report(result)
+      result
+    end
+
+    # Write the JSON report.
+    #
+    # @return [String] the path written
+    def write(path = nil)
+      path ||= ENV['BENCH_OUT'] || File.join('tmp', 'bench', "#{@name}-#{commit || 'nogit'}.json")
+      FileUtils.mkdir_p(File.dirname(path))
+      File.write(path, JSON.pretty_generate(header.merge(results: @results)))
+      puts "\nWrote #{path}"
+      path
+    end
+
+    private
+
+    def now
+      Process.clock_gettime(Process::CLOCK_MONOTONIC)
+    end
+
+    # Grow n until one call takes about BATCH_SECONDS
+    def calibrate(&block)
+      n = 1
+      loop do
+        t0 = now
+        block.call(n)
+        elapsed = now - t0
+        return n if elapsed >= BATCH_SECONDS || n >= 1_000_000
+        n = elapsed <= 0 ? n * 10 : [(n * BATCH_SECONDS / elapsed).ceil, n * 10].min
+      end
+    end
+
+    def summarize(name, group, params, n, samples)
+      sorted = samples.sort
+      mean = samples.sum / samples.size
+      {
+        name: name,
+        group: group,
+        params: params,
+        batch: n,
+        batches: samples.size,
+        ns_per_op: {
+          mean: mean.round(1),
+          median: sorted[sorted.size / 2].round(1),
+          p95: sorted[(sorted.size * 0.95).floor.clamp(0, sorted.size - 1)].round(1),
+          min: sorted.first.round(1),
+          max: sorted.last.round(1),
+        },
+        ops_per_sec: (1e9 / mean).round(1),
+      }
+    end
+
+    def report(result)
+      ns = result[:ns_per_op]
+      params = result[:params].map { |k, v| "#{k}=#{v}" }.join(' ')
+      puts format("%-34s %12.1f ns/op  (p95 %10.1f)  %14.1f ops/s  %s",
+                  result[:name], ns[:median], ns[:p95], result[:ops_per_sec], params)
+    end
+
+    def header
+      {
+        suite: @name,
+        commit: commit,
+        dirty: dirty?,
+        timestamp: Time.now.utc.iso8601,
+        ruby: RUBY_DESCRIPTION,
+        platform: RUBY_PLATFORM,
+        cpus: Etc.nprocessors,
+        bench_time: @measure_time,
+      }.merge(@meta)
+    end
+
+    def commit
+      @commit ||= begin
+        sha = `git rev-parse --short HEAD 2>/dev/null`.strip
+        sha.empty? ? nil : sha
+      end
+    end
+
+    def dirty?
+      !`git status --porcelain --untracked-files=no 2>/dev/null`.strip.empty?
+    end
+  end
+end
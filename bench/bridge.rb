@@ -0,0 +1,122 @@
+# frozen_string_literal: true
+
+# Ruby <-> Tcl bridge hot paths. Needs a display (run under xvfb-run on
+# CI); see bench_helper.rb for the environment knobs.
+#
+#   rake bench
+#   xvfb-run -a rake bench BENCH=photo
+
+require 'teek'
+require_relative 'bench_helper'
+
+app = Teek::App.new
+interp = app.interp
+suite = TeekBench::Suite.new('bridge')
+suite.meta(tcl: interp.tcl_version, tk: interp.tk_version)
+
+puts "teek bridge benchmarks (Tcl #{interp.tcl_version}, Tk #{interp.tk_version}, #{RUBY_DESCRIPTION})\n\n"
+
+# ---------------------------------------------------------
+# Command invocation
+# ---------------------------------------------------------
+
+suite.measure('tcl_eval') do |n|
+  n.times { interp.tcl_eval('set ::bench_x 1') }
+end
+
+suite.measure('tcl_invoke') do |n|
+  n.times { interp.tcl_invoke('set', '::bench_x', '1') }
+end
+
+suite.measure('app.command', widget: 'canvas') do |n|
+  app.command(:canvas, '.bench_cmd') unless app.tcl_eval('winfo exists .bench_cmd') == '1'
+  n.times { app.command('.bench_cmd', :cget, :width) }
+end
+
+# ---------------------------------------------------------
+# Callbacks (Tcl -> Ruby)
+# ---------------------------------------------------------
+
+calls = 0
+callback_id = app.register_callback(proc { |*| calls += 1 })
+
+suite.measure('callback_dispatch', args: 0) do |n|
+  id = callback_id.to_s
+  n.times { interp.tcl_invoke('ruby_callback', id) }
+end
+
+suite.measure('callback_dispatch', args: 3) do |n|
+  id = callback_id.to_s
+  n.times { interp.tcl_invoke('ruby_callback', id, 'a', '42', '3.5') }
+end
+
+suite.measure('callback_from_script') do |n|
+  script = "ruby_callback #{callback_id}"
+  n.times { interp.tcl_eval(script) }
+end
+
+# ---------------------------------------------------------
+# Cross-thread round trips (queue_command_internal)
+# ---------------------------------------------------------
+
+# A background thread calls into Tcl and waits for each result while the
+# main thread services the event queue.
+suite.measure('cross_thread_tcl_eval', group: :macro) do |n|
+  worker = Thread.new { n.times { interp.tcl_eval('set ::bench_x 1') } }
+  interp.do_one_event(Teek::ALL_EVENTS | Teek::DONT_WAIT) || Thread.pass while worker.alive?
+  worker.join
+end
+
+# ---------------------------------------------------------
+# List conversion
+# ---------------------------------------------------------
+
+[10, 1000].each do |size|
+  words = Array.new(size) { |i| "item #{i}" }
+  list = Teek.make_list(*words)
+
+  suite.measure('split_list', elements: size) do |n|
+    n.times { Teek.split_list(list) }
+  end
+
+  suite.measure('make_list', elements: size) do |n|
+    n.times { Teek.make_list(*words) }
+  end
+end
+
+# ---------------------------------------------------------
+# Photo writes
+# ---------------------------------------------------------
+
+[16, 64, 256, 1024].each do |side|
+  photo = Teek::Photo.new(app, width: side, height: side)
+  pixels = ([200, 100, 50, 255].pack('C4') * (side * side)).freeze
+
+  suite.measure('photo_put_block', size: "#{side}x#{side}", bytes: pixels.bytesize) do |n|
+    n.times { photo.put_block(pixels, side, side) }
+  end
+
+  photo.delete
+end
+
+# ---------------------------------------------------------
+# Event loop throughput
+# ---------------------------------------------------------
+
+# Tcl timer events: schedule n `after 0` handlers, then drain them.
+suite.measure('event_loop_after_0', group: :macro) do |n|
+  interp.tcl_eval("set ::bench_n 0; for {set i 0} {$i < #{n}} {incr i} {after 0 {incr ::bench_n}}")
+  interp.do_one_event(Teek::ALL_EVENTS | Teek::DONT_WAIT) until interp.tcl_eval('set ::bench_n').to_i >= n
+end
+
+# Ruby procs queued as Tcl events (the BackgroundWork delivery path).
+suite.measure('event_loop_queue_for_main', group: :macro) do |n|
+  ran = 0
+  bump = proc { ran += 1 }
+  n.times { interp.queue_for_main(bump) }
+  interp.do_one_event(Teek::ALL_EVENTS | Teek::DONT_WAIT) while ran < n
+end
+
+app.unregister_callback(callback_id)
+suite.write
+app.destroy
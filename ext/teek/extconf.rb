@@ -93,8 +93,12 @@ end
 
 find_tcltk
 
+# zlib for the native PNG decoder (Photo.decode_async). Optional: without
+# it PPM still decodes and PNG raises a clear error.
+have_header('zlib.h') && have_library('z', 'inflate', 'zlib.h')
+
 # Source files for the extension
-$srcs = ['tcltkbridge.c', 'tkphoto.c', 'tkfont.c', 'tkwin.c', 'tkeventsource.c', 'tkdrop.c']
+$srcs = ['tcltkbridge.c', 'tkpixconv.c', 'tkphoto.c', 'tkimgdecode.c', 'tkresample.c', 'tkmmap.c', 'tkframebuffer.c', 'tkfont.c', 'tkwin.c', 'tkcanvas.c', 'tkeventsource.c', 'tkstats.c', 'tktrace.c', 'tkdrop.c']
 
 # Platform-specific file drop target
 case RbConfig::CONFIG['host_os']
@@ -178,6 +178,7 @@ static void interp_deleted_callback(ClientData, Tcl_Interp *);
 struct ruby_thread_event {
     Tcl_Event event;           /* Must be first - Tcl casts to this */
     struct tcltk_interp *tip;  /* Interpreter context */
+    long long queued_us;       /* Enqueue time for Teek.stats/tracer, 0 when off */
 };
 
 /* Ruby Queue class for thread synchronization */
@@ -186,6 +187,12 @@ static VALUE cQueue = Qundef;
 /* Track callback depth for unsafe operation detection */
 static int rbtk_callback_depth = 0;
 
+/* Set while interp_mainloop waits in Tcl_DoOneEvent without the GVL, so
+ * Teek.stats can count callbacks that had to reacquire it. Main thread
+ * only; cleared for the duration of a callback so nested event
+ * processing (app.update) isn't counted. */
+static int mainloop_gvl_released = 0;
+
 /* Callback control flow exceptions - for signaling break/continue/return to Tcl */
 
 /* ---------------------------------------------------------
@@ -433,12 +440,13 @@ struct ruby_callback_ctx {
     int objc;
     Tcl_Obj *const *objv;
     int result;
+    long long stats_start;  /* Teek.stats dispatch start, 0 when off */
+    int reacquired_gvl;
 };
 
-static void *
-ruby_callback_proc_body(void *arg)
+static void
+ruby_callback_dispatch(struct ruby_callback_ctx *ctx)
 {
-    struct ruby_callback_ctx *ctx = (struct ruby_callback_ctx *)arg;
     struct tcltk_interp *tip = (struct tcltk_interp *)ctx->clientData;
     Tcl_Interp *interp = ctx->interp;
     int objc = ctx->objc;
@@ -451,7 +459,7 @@ ruby_callback_proc_body(void *arg)
         Tcl_SetResult(interp, "wrong # args: should be \"ruby_callback id ?args?\"",
                       TCL_STATIC);
         ctx->result = TCL_ERROR;
-        return NULL;
+        return;
     }
 
     /* Look up proc by ID */
@@ -462,7 +470,7 @@ ruby_callback_proc_body(void *arg)
         Tcl_SetObjResult(interp, Tcl_ObjPrintf("unknown callback id: %s",
                          Tcl_GetString(objv[1])));
         ctx->result = TCL_ERROR;
-        return NULL;
+        return;
     }
 
     /* Build args array */
@@ -494,15 +502,15 @@ ruby_callback_proc_body(void *arg)
         VALUE msg = rb_funcall(errinfo, rb_intern("message"), 0);
         Tcl_SetResult(interp, StringValueCStr(msg), TCL_VOLATILE);
         ctx->result = TCL_ERROR;
-        return NULL;
+        return;
     }
 
     /* Check return value for Tcl control flow signals.
      * Callbacks wrapped by Teek::App#register_callback use catch/throw
      * and return these symbols when the user throws :teek_break etc. */
-    if (result == ID2SYM(rb_intern("break"))) { ctx->result = TCL_BREAK; return NULL; }
-    if (result == ID2SYM(rb_intern("continue"))) { ctx->result = TCL_CONTINUE; return NULL; }
-    if (result == ID2SYM(rb_intern("return"))) { ctx->result = TCL_RETURN; return NULL; }
+    if (result == ID2SYM(rb_intern("break"))) { ctx->result = TCL_BREAK; return; }
+    if (result == ID2SYM(rb_intern("continue"))) { ctx->result = TCL_CONTINUE; return; }
+    if (result == ID2SYM(rb_intern("return"))) { ctx->result = TCL_RETURN; return; }
 
     /* Return result to Tcl */
     if (!NIL_P(result)) {
@@ -511,6 +519,18 @@ ruby_callback_proc_body(void *arg)
     }
 
     ctx->result = TCL_OK;
+}
+
+static void *
+ruby_callback_proc_body(void *arg)
+{
+    struct ruby_callback_ctx *ctx = (struct ruby_callback_ctx *)arg;
+
+    ruby_callback_dispatch(ctx);
+    if (ctx->stats_start) {
+        teek_stats_callback(ctx->stats_start, ctx->reacquired_gvl,
+                            ctx->result == TCL_ERROR);
+    }
     return NULL;
 }
 
@@ -523,8 +543,31 @@ static int
 ruby_callback_proc(ClientData clientData, Tcl_Interp *interp,
                    int objc, Tcl_Obj *const objv[])
 {
-    struct ruby_callback_ctx ctx = { clientData, interp, objc, objv, TCL_OK };
+    struct ruby_callback_ctx ctx = { clientData, interp, objc, objv, TCL_OK,
+                                     TEEK_STATS_START(), mainloop_gvl_released };
+    long long trace_start = teek_trace_begin();
+
+    mainloop_gvl_released = 0;
     rb_thread_call_with_gvl(ruby_callback_proc_body, &ctx);
+    mainloop_gvl_released = ctx.reacquired_gvl;
+
+    if (trace_start && objc >= 2) {
+        /* Bound widget: the first argument that looks like a window path
+         * (bind ... %W, <Destroy> handlers, ...) - "." or "." followed by
+         * a name, so numbers like ".5" don't count */
+        const char *widget = NULL;
+        int i;
+        for (i = 2; i < objc && !widget; i++) {
+            const char *arg = Tcl_GetString(objv[i]);
+            char c = arg[1];
+            if (arg[0] == '.' && (c == '\0' || c == '_' ||
+                                  (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))) {
+                widget = arg;
+            }
+        }
+        teek_trace_span(TEEK_TRACE_CALLBACK, "callback", widget,
+                        strtoll(Tcl_GetString(objv[1]), NULL, 10), trace_start);
+    }
     return ctx.result;
 }
 
@@ -718,8 +761,11 @@ execute_queued_eval(VALUE arg)
     struct tcltk_interp *tip = (struct tcltk_interp *)args[0];
     VALUE script = args[1];
     const char *script_cstr = StringValueCStr(script);
+    long long stats_start = TEEK_STATS_START();
     int result = Tcl_Eval(tip->interp, script_cstr);
 
+    if (stats_start) teek_stats_script(script_cstr, stats_start);
+
     if (result != TCL_OK) {
         raise_tcl_error(tip->interp, result);
     }
@@ -736,6 +782,7 @@ execute_queued_invoke(VALUE arg)
     int argc = (int)RARRAY_LEN(argv_ary);
     Tcl_Obj **objv;
     int i, result;
+    long long stats_start;
 
     objv = ALLOCA_N(Tcl_Obj *, argc);
     for (i = 0; i < argc; i++) {
@@ -755,7 +802,9 @@ execute_queued_invoke(VALUE arg)
         Tcl_IncrRefCount(objv[i]);
     }
 
+    stats_start = TEEK_STATS_START();
     result = Tcl_EvalObjv(tip->interp, argc, objv, 0);
+    if (stats_start) teek_stats_command(Tcl_GetString(objv[0]), stats_start);
 
     for (i = 0; i < argc; i++) {
         Tcl_DecrRefCount(objv[i]);
@@ -782,11 +831,15 @@ ruby_thread_event_handler_body(void *arg)
     VALUE cmd, type, queue, result, exception;
     int state;
     VALUE exec_args[2];
+    long long trace_start;
 
     /* Pop the command from the GC-protected queue */
     cmd = rb_ary_shift(rte->tip->thread_queue);
     if (NIL_P(cmd)) return NULL;
 
+    if (rte->queued_us && teek_stats_enabled) teek_stats_queue_wait(rte->queued_us);
+    trace_start = teek_trace_begin();
+
     type = rb_hash_aref(cmd, ID2SYM(sym_type));
     queue = rb_hash_aref(cmd, ID2SYM(sym_queue));
     result = Qnil;
@@ -807,6 +860,23 @@ ruby_thread_event_handler_body(void *arg)
         state = 0;
     }
 
+    if (trace_start) {
+        const char *name = "queued proc";
+        const char *detail = NULL;
+        VALUE what = Qnil;
+
+        if (type == sym_eval) {
+            name = "queued eval";
+            what = exec_args[1];
+        } else if (type == sym_invoke) {
+            name = "queued invoke";
+            what = rb_ary_entry(exec_args[1], 0);
+        }
+        if (RB_TYPE_P(what, T_STRING)) detail = RSTRING_PTR(what);
+        teek_trace_span(TEEK_TRACE_THREAD_EVENT, name, detail,
+                        rte->queued_us ? trace_start - rte->queued_us : 0, trace_start);
+    }
+
     if (state) {
         exception = rb_errinfo();
         rb_set_errinfo(Qnil);
@@ -833,7 +903,11 @@ ruby_thread_event_handler_body(void *arg)
 static int
 ruby_thread_event_handler(Tcl_Event *evPtr, int flags)
 {
+    int gvl_released = mainloop_gvl_released;
+
+    mainloop_gvl_released = 0;
     rb_thread_call_with_gvl(ruby_thread_event_handler_body, (void *)evPtr);
+    mainloop_gvl_released = gvl_released;
     return 1; /* Event handled, Tcl will free the event struct */
 }
 
@@ -859,6 +933,8 @@ queue_command_internal(struct tcltk_interp *tip, VALUE cmd_hash, int wait_for_re
     rte = (struct ruby_thread_event *)ckalloc(sizeof(struct ruby_thread_event));
     rte->event.proc = ruby_thread_event_handler;
     rte->tip = tip;
+    rte->queued_us = (teek_stats_enabled || teek_trace_enabled) ? teek_stats_now_us() : 0;
+    if (teek_stats_enabled) teek_stats_queue_push(RARRAY_LEN(tip->thread_queue));
 
     /* Queue to main thread and wake it up */
     current_thread = Tcl_GetCurrentThread();
@@ -926,6 +1002,7 @@ interp_tcl_eval(VALUE self, VALUE script)
     struct tcltk_interp *tip = get_interp(self);
     Tcl_ThreadId current = Tcl_GetCurrentThread();
     const char *script_cstr;
+    long long stats_start;
     int result;
 
     StringValue(script);
@@ -940,7 +1017,9 @@ interp_tcl_eval(VALUE self, VALUE script)
 
     /* On main thread - execute directly */
     script_cstr = StringValueCStr(script);
+    stats_start = TEEK_STATS_START();
     result = Tcl_Eval(tip->interp, script_cstr);
+    if (stats_start) teek_stats_script(script_cstr, stats_start);
 
     if (result != TCL_OK) {
         raise_tcl_error(tip->interp, result);
@@ -964,6 +1043,7 @@ interp_tcl_invoke(int argc, VALUE *argv, VALUE self)
     Tcl_ThreadId current = Tcl_GetCurrentThread();
     Tcl_Obj **objv;
     int i, result;
+    long long stats_start;
     VALUE ret;
 
     if (argc == 0) {
@@ -1000,7 +1080,9 @@ interp_tcl_invoke(int argc, VALUE *argv, VALUE self)
     }
 
     /* Invoke the command */
+    stats_start = TEEK_STATS_START();
     result = Tcl_EvalObjv(tip->interp, argc, objv, 0);
+    if (stats_start) teek_stats_command(Tcl_GetString(objv[0]), stats_start);
 
     /* Clean up Tcl objects */
     for (i = 0; i < argc; i++) {
@@ -1211,7 +1293,11 @@ keepalive_timer_proc(ClientData clientData)
 static void *
 do_one_event_func(void *arg)
 {
+    mainloop_gvl_released = 1;
+    teek_trace_iteration_begin();
     Tcl_DoOneEvent(TCL_ALL_EVENTS);
+    teek_trace_iteration_end();
+    mainloop_gvl_released = 0;
     return NULL;
 }
 
@@ -1656,18 +1742,42 @@ Init_tcltklib(void)
     rb_define_method(cInterp, "on_main_thread?", interp_on_main_thread_p, 0);
     rb_define_method(cInterp, "create_console", interp_create_console, 0);
 
+    /* Pixel format conversion kernels (tkpixconv.c) */
+    Init_tkpixconv(mTeek);
+
     /* Photo image functions (tkphoto.c) */
     Init_tkphoto(cInterp);
 
+    /* Arbitrary-ratio photo resampling (tkresample.c) */
+    Init_tkresample(cInterp);
+
+    /* PNG/PPM decoding without the GVL (tkimgdecode.c) */
+    Init_tkimgdecode(mTeek);
+
+    /* Memory-mapped raw frame sources (tkmmap.c) */
+    Init_tkmmap(mTeek);
+
+    /* Dirty-rect photo framebuffer (tkframebuffer.c) */
+    Init_tkframebuffer(mTeek);
+
     /* Font functions (tkfont.c) */
     Init_tkfont(cInterp);
 
     /* Tk window query functions (tkwin.c) */
     Init_tkwin(cInterp);
 
+    /* Batched canvas item commands (tkcanvas.c) */
+    Init_tkcanvas(cInterp);
+
     /* External event source integration (tkeventsource.c) */
     Init_tkeventsource(mTeek);
 
+    /* Bridge instrumentation counters (tkstats.c) */
+    Init_tkstats(mTeek);
+
+    /* Event-loop tracer (tktrace.c) */
+    Init_tktrace(mTeek);
+
     /* File drop target support (tkdrop.c) */
     Init_tkdrop(cInterp);
 
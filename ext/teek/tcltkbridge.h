@@ -33,16 +33,101 @@ struct tcltk_interp *get_interp(VALUE self);
 /* Photo image functions - defined in tkphoto.c */
 void Init_tkphoto(VALUE cInterp);
 
+/* Pixel formats for teek_pixconv, named by byte order in memory.
+ * Values are shared with other extensions (teek-sdl2) - append only. */
+enum teek_pixfmt {
+    TEEK_PIXFMT_RGBA = 0,
+    TEEK_PIXFMT_BGRA = 1,
+    TEEK_PIXFMT_ARGB = 2,
+    TEEK_PIXFMT_ABGR = 3,
+    TEEK_PIXFMT_RGB  = 4,
+    TEEK_PIXFMT_GRAY = 5
+};
+
+#define TEEK_PIXCONV_PREMULTIPLY   1
+#define TEEK_PIXCONV_UNPREMULTIPLY 2
+
+typedef int (*teek_pixconv_fn)(const unsigned char *src, int src_fmt,
+                               unsigned char *dst, int dst_fmt,
+                               size_t npixels, int flags);
+
+/* SIMD pixel format conversion - defined in tkpixconv.c */
+int teek_pixconv(const unsigned char *src, int src_fmt,
+                 unsigned char *dst, int dst_fmt,
+                 size_t npixels, int flags);
+int teek_pixfmt_bytes(int fmt);
+void teek_pixconv_init(void);
+const char *teek_pixconv_impl(void);
+int teek_cpu_has(const char *feature);
+void Init_tkpixconv(VALUE mTeek);
+
+/* Photo :format option (:rgba/:argb/:rgb/:gray) to enum teek_pixfmt -
+ * defined in tkphoto.c */
+int teek_photo_format_opt(VALUE val);
+
+/* Photo resampling (nearest/bilinear/area) - defined in tkresample.c */
+void Init_tkresample(VALUE cInterp);
+
+/* Off-main-thread PNG/PPM decoding - defined in tkimgdecode.c */
+void Init_tkimgdecode(VALUE mTeek);
+
+/* Teek::MappedFile (mmap'd raw frames into photos) - defined in tkmmap.c */
+void Init_tkmmap(VALUE mTeek);
+
+/* Teek::PhotoFramebuffer - defined in tkframebuffer.c */
+void Init_tkframebuffer(VALUE mTeek);
+
 /* Font functions - defined in tkfont.c */
 void Init_tkfont(VALUE cInterp);
 
 /* Tk window query functions - defined in tkwin.c */
 void Init_tkwin(VALUE cInterp);
 
+/* Batched canvas item commands - defined in tkcanvas.c */
+void Init_tkcanvas(VALUE cInterp);
+
 /* External event source integration - defined in tkeventsource.c */
 void Init_tkeventsource(VALUE mTeek);
 
 /* File drop target support - defined in tkdrop.c */
 void Init_tkdrop(VALUE cInterp);
 
+/* Bridge instrumentation (Teek.stats) - defined in tkstats.c.
+ * Hooks take the start time from TEEK_STATS_START(), which is 0 when
+ * stats are off; the record functions ignore a 0 start. Call with the
+ * GVL held. */
+extern int teek_stats_enabled;
+long long teek_stats_now_us(void);
+#define TEEK_STATS_START() (teek_stats_enabled ? teek_stats_now_us() : 0LL)
+void teek_stats_command(const char *name, long long start_us);
+void teek_stats_script(const char *script, long long start_us);
+void teek_stats_callback(long long start_us, int reacquired_gvl, int failed);
+void teek_stats_queue_push(long depth);
+void teek_stats_queue_wait(long long queued_us);
+void Init_tkstats(VALUE mTeek);
+
+/* Event-loop tracer (Teek::Tracer) - defined in tktrace.c. Span kinds
+ * are shared with other extensions (teek-sdl2) - append only. */
+enum teek_trace_kind {
+    TEEK_TRACE_ITERATION    = 0,
+    TEEK_TRACE_WAIT         = 1,
+    TEEK_TRACE_CALLBACK     = 2,
+    TEEK_TRACE_THREAD_EVENT = 3,
+    TEEK_TRACE_EXTERNAL     = 4
+};
+
+typedef long long (*teek_trace_begin_fn)(void);
+typedef void (*teek_trace_span_fn)(int kind, const char *name, const char *detail,
+                                   long long value, long long start_us);
+
+/* teek_trace_begin returns 0 when tracing is off; teek_trace_span
+ * ignores a 0 start. Neither needs the GVL. */
+extern int teek_trace_enabled;
+long long teek_trace_begin(void);
+void teek_trace_span(int kind, const char *name, const char *detail,
+                     long long value, long long start_us);
+void teek_trace_iteration_begin(void);
+void teek_trace_iteration_end(void);
+void Init_tktrace(VALUE mTeek);
+
 #endif /* TCLTKBRIDGE_H */
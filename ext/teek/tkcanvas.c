@@ -0,0 +1,575 @@
+/* tkcanvas.c - Batched canvas item commands
+ *
+ * Animated canvases send thousands of small coords/itemconfigure
+ * commands per frame. Through Interp#tcl_invoke each one costs a Ruby
+ * method call, a String per argument and a result String; the functions
+ * here take a frame's worth of commands at once and build the Tcl
+ * arguments straight from Ruby numbers.
+ */
+
+#include "tcltkbridge.h"
+#include "ruby/io/buffer.h"
+#include <string.h>
+
+/* Convert one op argument to a new (zero refcount) Tcl_Obj.
+ *
+ * Integers and Floats become numeric objects without a string round
+ * trip, Arrays become Tcl lists (so coordinate lists are one argument).
+ * Returns NULL for anything else; doesn't raise, so the caller can
+ * release what it has already built. */
+static Tcl_Obj *
+canvas_arg_obj(VALUE val)
+{
+    switch (TYPE(val)) {
+    case T_STRING:
+        return Tcl_NewStringObj(RSTRING_PTR(val), (Tcl_Size)RSTRING_LEN(val));
+    case T_SYMBOL: {
+        VALUE str = rb_sym2str(val);
+        return Tcl_NewStringObj(RSTRING_PTR(str), (Tcl_Size)RSTRING_LEN(str));
+    }
+    case T_FIXNUM:
+        return Tcl_NewWideIntObj((Tcl_WideInt)FIX2LONG(val));
+    case T_FLOAT:
+        return Tcl_NewDoubleObj(RFLOAT_VALUE(val));
+    case T_TRUE:
+        return Tcl_NewWideIntObj(1);
+    case T_FALSE:
+        return Tcl_NewWideIntObj(0);
+    case T_NIL:
+        return Tcl_NewObj();
+    case T_ARRAY: {
+        long i, n = RARRAY_LEN(val);
+        Tcl_Obj *list = Tcl_NewListObj(0, NULL);
+
+        for (i = 0; i < n; i++) {
+            Tcl_Obj *elem = canvas_arg_obj(RARRAY_AREF(val, i));
+            if (!elem) {
+                Tcl_IncrRefCount(list);
+                Tcl_DecrRefCount(list);
+                return NULL;
+            }
+            Tcl_ListObjAppendElement(NULL, list, elem);
+        }
+        return list;
+    }
+    default:
+        return NULL;
+    }
+}
+
+/* Record how far a failed batch got on the exception raised for it:
+ * TclError#created_ids (ids of the items created before the failure)
+ * and #failed_index (the op or item that failed). */
+static void
+batch_error_progress(VALUE err, VALUE ids, long index)
+{
+    rb_ivar_set(err, rb_intern("@created_ids"), ids);
+    rb_ivar_set(err, rb_intern("@failed_index"), LONG2NUM(index));
+}
+
+/* ---------------------------------------------------------
+ * Interp#canvas_apply(canvas_path, ops)
+ *
+ * Run a batch of canvas widget commands in one call. Each op is an
+ * Array [subcommand, *args], evaluated as "canvas_path subcommand args..."
+ * with Tcl_EvalObjv - no script parsing and no per-command result
+ * String.
+ *
+ * Arguments may be String, Symbol, Integer, Float, true/false, nil
+ * (empty string) or Array (a Tcl list, e.g. a coordinate list for
+ * "coords" or "create"). Numbers are passed to Tk as numeric objects.
+ *
+ * Ops run in order. If one fails, the ones before it stay applied and
+ * an error is raised naming the failed op's index. A TclError's
+ * created_ids and failed_index say which items the batch created and
+ * where it stopped, so the caller can adopt or delete them.
+ *
+ * Arguments:
+ *   canvas_path - Tk path of the canvas widget
+ *   ops         - Array of op Arrays
+ *
+ * Returns:
+ *   Array of Integer item ids, one for each "create" op, in order
+ *
+ * See: https://www.tcl-lang.org/man/tcl9.0/TkCmd/canvas.html
+ * --------------------------------------------------------- */
+
+static VALUE
+interp_canvas_apply(VALUE self, VALUE canvas_path, VALUE ops)
+{
+    struct tcltk_interp *tip = get_interp(self);
+    Tcl_Obj **objv;
+    Tcl_Obj *path;
+    VALUE tmpbuf;
+    VALUE ids = rb_ary_new();
+    VALUE err = Qnil;
+    long i, n, max_args = 0;
+
+    StringValue(canvas_path);
+    Check_Type(ops, T_ARRAY);
+
+    n = RARRAY_LEN(ops);
+    for (i = 0; i < n; i++) {
+        VALUE op = RARRAY_AREF(ops, i);
+        if (!RB_TYPE_P(op, T_ARRAY) || RARRAY_LEN(op) == 0) {
+            rb_raise(rb_eArgError, "canvas op %ld must be a non-empty Array", i);
+        }
+        if (RARRAY_LEN(op) > max_args) max_args = RARRAY_LEN(op);
+    }
+    if (n == 0) return ids;
+
+    objv = ALLOCV_N(Tcl_Obj *, tmpbuf, max_args + 1);
+    path = Tcl_NewStringObj(RSTRING_PTR(canvas_path), (Tcl_Size)RSTRING_LEN(canvas_path));
+    Tcl_IncrRefCount(path);
+    objv[0] = path;
+
+    for (i = 0; i < n; i++) {
+        VALUE op = rb_ary_entry(ops, i);
+        long j = 0, argc;
+        int result, is_create;
+
+        /* Re-checked: a Tcl callback run by an earlier op may have
+         * modified the batch */
+        if (!RB_TYPE_P(op, T_ARRAY) || RARRAY_LEN(op) == 0 || RARRAY_LEN(op) > max_args) {
+            err = rb_exc_new_str(rb_eArgError,
+                rb_sprintf("canvas op %ld changed while the batch was running", i));
+            break;
+        }
+        argc = RARRAY_LEN(op);
+        for (j = 0; j < argc; j++) {
+            VALUE arg = RARRAY_AREF(op, j);
+            Tcl_Obj *obj = canvas_arg_obj(arg);
+            if (!obj) {
+                err = rb_exc_new_str(rb_eTypeError,
+                    rb_sprintf("canvas op %ld: can't pass %s to Tcl", i, rb_obj_classname(arg)));
+                break;
+            }
+            Tcl_IncrRefCount(obj);
+            objv[j + 1] = obj;
+        }
+
+        if (NIL_P(err)) {
+            is_create = strcmp(Tcl_GetString(objv[1]), "create") == 0;
+            result = Tcl_EvalObjv(tip->interp, (Tcl_Size)(argc + 1), objv, 0);
+            if (result != TCL_OK) {
+                err = rb_exc_new_str(eTclError,
+                    rb_sprintf("%s (canvas op %ld)", Tcl_GetStringResult(tip->interp), i));
+            } else if (is_create) {
+                Tcl_WideInt id = 0;
+                Tcl_GetWideIntFromObj(NULL, Tcl_GetObjResult(tip->interp), &id);
+                rb_ary_push(ids, LL2NUM((LONG_LONG)id));
+            }
+        }
+
+        while (j-- > 0) {
+            Tcl_DecrRefCount(objv[j + 1]);
+        }
+        if (!NIL_P(err)) break;
+    }
+
+    Tcl_DecrRefCount(path);
+    ALLOCV_END(tmpbuf);
+
+    if (!NIL_P(err)) {
+        batch_error_progress(err, ids, i);
+        rb_exc_raise(err);
+    }
+    return ids;
+}
+
+/* Packed coordinate input: a String or IO::Buffer of native-endian
+ * float64 (pack("d*")) or float32 (pack("f*")) values. The source is
+ * locked against modification while the batch runs. */
+struct packed_coords {
+    VALUE src;
+    const unsigned char *ptr;
+    size_t count;        /* number of coordinates */
+    int is_f32;
+};
+
+static void
+packed_coords_open(struct packed_coords *pc, VALUE src, VALUE format)
+{
+    size_t elem, bytes;
+    const void *base;
+
+    if (NIL_P(format) || format == ID2SYM(rb_intern("float64"))) {
+        pc->is_f32 = 0;
+    } else if (format == ID2SYM(rb_intern("float32"))) {
+        pc->is_f32 = 1;
+    } else {
+        rb_raise(rb_eArgError, "format must be :float64 or :float32");
+    }
+    elem = pc->is_f32 ? sizeof(float) : sizeof(double);
+
+    if (RB_TYPE_P(src, T_STRING)) {
+        base = RSTRING_PTR(src);
+        bytes = (size_t)RSTRING_LEN(src);
+    } else if (rb_obj_is_kind_of(src, rb_cIOBuffer)) {
+        rb_io_buffer_get_bytes_for_reading(src, &base, &bytes);
+    } else {
+        rb_raise(rb_eTypeError, "coords must be a String or IO::Buffer (got %s)",
+                 rb_obj_classname(src));
+    }
+    if (bytes % elem != 0) {
+        rb_raise(rb_eArgError, "coords buffer size %zu is not a multiple of %zu",
+                 bytes, elem);
+    }
+
+    pc->src = src;
+    pc->ptr = base;
+    pc->count = bytes / elem;
+
+    if (RB_TYPE_P(src, T_STRING)) rb_str_locktmp(src);
+    else rb_io_buffer_lock(src);
+}
+
+static void
+packed_coords_close(struct packed_coords *pc)
+{
+    if (RB_TYPE_P(pc->src, T_STRING)) rb_str_unlocktmp(pc->src);
+    else rb_io_buffer_unlock(pc->src);
+}
+
+/* A new Tcl list of n coordinates starting at index first */
+static Tcl_Obj *
+packed_coords_list(const struct packed_coords *pc, size_t first, long n, Tcl_Obj **elems)
+{
+    long k;
+
+    for (k = 0; k < n; k++) {
+        double v;
+        if (pc->is_f32) {
+            float f;
+            memcpy(&f, pc->ptr + (first + k) * sizeof(float), sizeof(float));
+            v = f;
+        } else {
+            memcpy(&v, pc->ptr + (first + k) * sizeof(double), sizeof(double));
+        }
+        elems[k] = Tcl_NewDoubleObj(v);
+    }
+    return Tcl_NewListObj((Tcl_Size)n, elems);
+}
+
+/* Coordinates per item when :per_item isn't given */
+static long
+default_per_item(const char *type)
+{
+    if (strcmp(type, "text") == 0 || strcmp(type, "image") == 0 ||
+        strcmp(type, "bitmap") == 0 || strcmp(type, "window") == 0) {
+        return 2;
+    }
+    if (strcmp(type, "rectangle") == 0 || strcmp(type, "oval") == 0 ||
+        strcmp(type, "arc") == 0 || strcmp(type, "line") == 0) {
+        return 4;
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------
+ * Interp#canvas_create_many(canvas_path, type, coords, opts = {})
+ *
+ * Create one canvas item per group of coordinates in a packed float
+ * buffer, all with the same item options. Each item is a single
+ * "create" built from Tcl_NewDoubleObj coordinates and option objects
+ * shared across the whole batch, so there's no per-item string
+ * formatting on either side.
+ *
+ * Arguments:
+ *   canvas_path - Tk path of the canvas widget
+ *   type        - item type (String or Symbol)
+ *   coords      - String or IO::Buffer of packed native-endian floats
+ *   opts        - Hash:
+ *     :per_item - coordinates per item (default 2 for text/image/
+ *                 bitmap/window, 4 for rectangle/oval/arc/line;
+ *                 required for polygon and multi-segment lines)
+ *     :format   - :float64 (pack("d*"), default) or :float32 (pack("f*"))
+ *     :options  - Hash of item options applied to every item,
+ *                 e.g. { fill: "red", tags: "points" }
+ *
+ * Items are created in buffer order. If Tk rejects one, the items
+ * before it stay on the canvas and the TclError's created_ids holds
+ * their ids (failed_index is the rejected item), as for canvas_apply.
+ *
+ * Returns:
+ *   Array of Integer item ids, in buffer order
+ *
+ * See: https://www.tcl-lang.org/man/tcl9.0/TkCmd/canvas.html#M38
+ * --------------------------------------------------------- */
+
+/* State shared between interp_canvas_create_many and its rb_ensure
+ * body/cleanup. The packed buffer is locked from packed_coords_open
+ * until create_many_cleanup, whatever raises in between. */
+struct create_many_args {
+    struct tcltk_interp *tip;
+    VALUE canvas_path;
+    VALUE pairs;             /* item options as [[key, value], ...], or nil */
+    VALUE ids;
+    VALUE tmpbuf;
+    const char *type_str;
+    struct packed_coords pc;
+    Tcl_Obj **objv;
+    long per_item;
+    long nopts;
+    long nheld;              /* leading objv slots holding a reference (slot 3 excepted) */
+};
+
+static VALUE
+create_many_body(VALUE arg)
+{
+    struct create_many_args *a = (struct create_many_args *)arg;
+    Tcl_Obj **objv, **elems;
+    long nitems, nfixed, i, k;
+
+    if (a->pc.count % (size_t)a->per_item != 0) {
+        rb_raise(rb_eArgError, "%zu coordinates is not a multiple of per_item (%ld)",
+                 a->pc.count, a->per_item);
+    }
+    nitems = (long)(a->pc.count / (size_t)a->per_item);
+    a->ids = rb_ary_new_capa(nitems);
+
+    /* objv: path create type coords -opt val ... ; slot 3 varies per item */
+    nfixed = 4 + 2 * a->nopts;
+    objv = a->objv = ALLOCV_N(Tcl_Obj *, a->tmpbuf, nfixed + a->per_item);
+    elems = objv + nfixed;
+
+    objv[0] = Tcl_NewStringObj(RSTRING_PTR(a->canvas_path), (Tcl_Size)RSTRING_LEN(a->canvas_path));
+    objv[1] = Tcl_NewStringObj("create", -1);
+    objv[2] = Tcl_NewStringObj(a->type_str, -1);
+    objv[3] = NULL;
+    for (k = 0; k < 3; k++) Tcl_IncrRefCount(objv[k]);
+    a->nheld = 4;
+
+    for (k = 0; k < a->nopts; k++) {
+        VALUE pair = RARRAY_AREF(a->pairs, k);
+        VALUE key = rb_sprintf("-%"PRIsVALUE, RARRAY_AREF(pair, 0));
+        Tcl_Obj *val = canvas_arg_obj(RARRAY_AREF(pair, 1));
+
+        if (!val) {
+            rb_raise(rb_eTypeError, "option %"PRIsVALUE": can't pass %s to Tcl",
+                     RARRAY_AREF(pair, 0), rb_obj_classname(RARRAY_AREF(pair, 1)));
+        }
+        objv[4 + 2 * k] = Tcl_NewStringObj(RSTRING_PTR(key), (Tcl_Size)RSTRING_LEN(key));
+        objv[5 + 2 * k] = val;
+        Tcl_IncrRefCount(objv[4 + 2 * k]);
+        Tcl_IncrRefCount(objv[5 + 2 * k]);
+        a->nheld = 6 + 2 * k;
+    }
+
+    for (i = 0; i < nitems; i++) {
+        int result;
+
+        objv[3] = packed_coords_list(&a->pc, (size_t)i * a->per_item, a->per_item, elems);
+        Tcl_IncrRefCount(objv[3]);
+        result = Tcl_EvalObjv(a->tip->interp, (Tcl_Size)nfixed, objv, 0);
+        Tcl_DecrRefCount(objv[3]);
+
+        if (result != TCL_OK) {
+            VALUE err = rb_exc_new_str(eTclError,
+                rb_sprintf("%s (item %ld)", Tcl_GetStringResult(a->tip->interp), i));
+            batch_error_progress(err, a->ids, i);
+            rb_exc_raise(err);
+        } else {
+            Tcl_WideInt id = 0;
+            Tcl_GetWideIntFromObj(NULL, Tcl_GetObjResult(a->tip->interp), &id);
+            rb_ary_push(a->ids, LL2NUM((LONG_LONG)id));
+        }
+    }
+    return a->ids;
+}
+
+static VALUE
+create_many_cleanup(VALUE arg)
+{
+    struct create_many_args *a = (struct create_many_args *)arg;
+    long k;
+
+    if (a->objv) {
+        for (k = 0; k < a->nheld; k++) {
+            if (k != 3) Tcl_DecrRefCount(a->objv[k]);
+        }
+        ALLOCV_END(a->tmpbuf);
+    }
+    packed_coords_close(&a->pc);
+    return Qnil;
+}
+
+static VALUE
+interp_canvas_create_many(int argc, VALUE *argv, VALUE self)
+{
+    VALUE canvas_path, type, coords, opts, item_opts;
+    struct create_many_args a;
+    long per_item;
+    const char *type_str;
+
+    memset(&a, 0, sizeof(a));
+    a.tip = get_interp(self);
+    a.pairs = Qnil;
+    a.ids = Qnil;
+
+    rb_scan_args(argc, argv, "31", &canvas_path, &type, &coords, &opts);
+    StringValue(canvas_path);
+    if (SYMBOL_P(type)) type = rb_sym2str(type);
+    StringValue(type);
+    type_str = StringValueCStr(type);
+
+    per_item = default_per_item(type_str);
+    item_opts = Qnil;
+    if (!NIL_P(opts)) {
+        VALUE v;
+        Check_Type(opts, T_HASH);
+        v = rb_hash_aref(opts, ID2SYM(rb_intern("per_item")));
+        if (!NIL_P(v)) per_item = NUM2LONG(v);
+        item_opts = rb_hash_aref(opts, ID2SYM(rb_intern("options")));
+    }
+    if (per_item <= 0) {
+        rb_raise(rb_eArgError, "per_item is required for %s items", type_str);
+    }
+    if (!NIL_P(item_opts)) {
+        Check_Type(item_opts, T_HASH);
+        a.pairs = rb_funcall(item_opts, rb_intern("to_a"), 0);
+        a.nopts = RARRAY_LEN(a.pairs);
+    }
+
+    a.canvas_path = canvas_path;
+    a.type_str = type_str;
+    a.per_item = per_item;
+
+    packed_coords_open(&a.pc, coords, NIL_P(opts) ? Qnil
+                       : rb_hash_aref(opts, ID2SYM(rb_intern("format"))));
+    return rb_ensure(create_many_body, (VALUE)&a, create_many_cleanup, (VALUE)&a);
+}
+
+/* ---------------------------------------------------------
+ * Interp#canvas_set_coords_many(canvas_path, ids, coords, opts = {})
+ *
+ * Move many existing items at once: item ids[i] gets the i-th group
+ * of coordinates from a packed float buffer, via "coords" with a
+ * Tcl_NewDoubleObj list. The number of coordinates per item is the
+ * buffer's coordinate count divided by ids.size.
+ *
+ * Arguments:
+ *   canvas_path - Tk path of the canvas widget
+ *   ids         - Array of Integer item ids
+ *   coords      - String or IO::Buffer of packed native-endian floats
+ *   opts        - Hash:
+ *     :format   - :float64 (default) or :float32
+ *
+ * Returns:
+ *   Integer number of items updated
+ * --------------------------------------------------------- */
+
+/* rb_ensure state for interp_canvas_set_coords_many, as for
+ * create_many_args */
+struct set_coords_many_args {
+    struct tcltk_interp *tip;
+    VALUE canvas_path;
+    VALUE ids;
+    VALUE tmpbuf;
+    struct packed_coords pc;
+    Tcl_Obj **objv;
+    long done;
+};
+
+static VALUE
+set_coords_many_body(VALUE arg)
+{
+    struct set_coords_many_args *a = (struct set_coords_many_args *)arg;
+    Tcl_Obj **objv, **elems;
+    long nids = RARRAY_LEN(a->ids), per_item;
+
+    if (nids == 0) return INT2FIX(0);
+    if (a->pc.count == 0 || a->pc.count % (size_t)nids != 0) {
+        rb_raise(rb_eArgError, "%zu coordinates can't be split evenly across %ld items",
+                 a->pc.count, nids);
+    }
+    per_item = (long)(a->pc.count / (size_t)nids);
+
+    objv = a->objv = ALLOCV_N(Tcl_Obj *, a->tmpbuf, 4 + per_item);
+    elems = objv + 4;
+    objv[0] = Tcl_NewStringObj(RSTRING_PTR(a->canvas_path), (Tcl_Size)RSTRING_LEN(a->canvas_path));
+    objv[1] = Tcl_NewStringObj("coords", -1);
+    Tcl_IncrRefCount(objv[0]);
+    Tcl_IncrRefCount(objv[1]);
+
+    /* ids is re-read each time: a Tcl callback run by an earlier item
+     * may have changed it, in which case NUM2LL raises */
+    for (a->done = 0; a->done < nids && a->done < RARRAY_LEN(a->ids); a->done++) {
+        long i = a->done;
+        Tcl_WideInt id = (Tcl_WideInt)NUM2LL(rb_ary_entry(a->ids, i));
+        int result;
+
+        objv[2] = Tcl_NewWideIntObj(id);
+        objv[3] = packed_coords_list(&a->pc, (size_t)i * per_item, per_item, elems);
+        Tcl_IncrRefCount(objv[2]);
+        Tcl_IncrRefCount(objv[3]);
+        result = Tcl_EvalObjv(a->tip->interp, 4, objv, 0);
+        Tcl_DecrRefCount(objv[2]);
+        Tcl_DecrRefCount(objv[3]);
+
+        if (result != TCL_OK) {
+            rb_raise(eTclError, "%s (item %ld)", Tcl_GetStringResult(a->tip->interp), i);
+        }
+    }
+    return LONG2NUM(a->done);
+}
+
+static VALUE
+set_coords_many_cleanup(VALUE arg)
+{
+    struct set_coords_many_args *a = (struct set_coords_many_args *)arg;
+
+    if (a->objv) {
+        Tcl_DecrRefCount(a->objv[0]);
+        Tcl_DecrRefCount(a->objv[1]);
+        ALLOCV_END(a->tmpbuf);
+    }
+    packed_coords_close(&a->pc);
+    return Qnil;
+}
+
+static VALUE
+interp_canvas_set_coords_many(int argc, VALUE *argv, VALUE self)
+{
+    VALUE canvas_path, ids, coords, opts;
+    struct set_coords_many_args a;
+    long nids, i;
+
+    memset(&a, 0, sizeof(a));
+    a.tip = get_interp(self);
+
+    rb_scan_args(argc, argv, "31", &canvas_path, &ids, &coords, &opts);
+    StringValue(canvas_path);
+    ids = rb_convert_type(ids, T_ARRAY, "Array", "to_ary");
+    if (!NIL_P(opts)) Check_Type(opts, T_HASH);
+
+    nids = RARRAY_LEN(ids);
+    for (i = 0; i < nids; i++) {
+        VALUE id = RARRAY_AREF(ids, i);
+        if (!RB_INTEGER_TYPE_P(id)) {
+            rb_raise(rb_eTypeError, "ids[%ld] is not an Integer", i);
+        }
+        (void)NUM2LL(id); /* range check before anything is locked */
+    }
+
+    a.canvas_path = canvas_path;
+    a.ids = ids;
+
+    packed_coords_open(&a.pc, coords, NIL_P(opts) ? Qnil
+                       : rb_hash_aref(opts, ID2SYM(rb_intern("format"))));
+    return rb_ensure(set_coords_many_body, (VALUE)&a, set_coords_many_cleanup, (VALUE)&a);
+}
+
+/* ---------------------------------------------------------
+ * Init_tkcanvas - Register batched canvas methods on Interp
+ *
+ * Called from Init_tcltklib in tcltkbridge.c.
+ * --------------------------------------------------------- */
+
+void
+Init_tkcanvas(VALUE cInterp)
+{
+    rb_define_method(cInterp, "canvas_apply", interp_canvas_apply, 2);
+    rb_define_method(cInterp, "canvas_create_many", interp_canvas_create_many, -1);
+    rb_define_method(cInterp, "canvas_set_coords_many", interp_canvas_set_coords_many, -1);
+}
@@ -7,15 +7,44 @@
  * The consumer passes a C function pointer via a Ruby method call at
  * registration time. The Tcl event source setup/check procs call that
  * pointer directly — no rb_funcall, no method dispatch.
+ *
+ * Every registered source is served by one multiplexing Tcl event
+ * source: a priority-ordered list where each entry has its own interval
+ * and time budget. The notifier blocks until the earliest entry is due,
+ * and each turn runs only the entries that are.
+ *
+ * A source doesn't have to poll. Besides (or instead of) a fixed
+ * interval, the check function can be triggered by:
+ *   - file descriptor readiness (Tcl_CreateFileHandler, Unix only)
+ *   - a wakeup from any thread (teek_event_source_wake -> Tcl_ThreadAlert)
+ *   - a one-shot deadline with microsecond resolution
+ * so the notifier only wakes up when the consumer has real work.
  */
 
 #include "tcltkbridge.h"
 #include <stdint.h>
 
+#define EVENT_SOURCE_MAX_FDS 8
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ES_FLAG_SET(p)   __atomic_store_n((p), 1, __ATOMIC_RELEASE)
+#define ES_FLAG_TAKE(p)  __atomic_exchange_n((p), 0, __ATOMIC_ACQ_REL)
+#define ES_FLAG_PEEK(p)  __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#else
+#define ES_FLAG_SET(p)   (*(p) = 1)
+#define ES_FLAG_TAKE(p)  es_flag_take(p)
+#define ES_FLAG_PEEK(p)  (*(p))
+static int es_flag_take(volatile int *p) { int v = *p; *p = 0; return v; }
+#endif
+
 static VALUE cEventSource;
 
 /* ---------------------------------------------------------
  * Event source struct — wrapped as Ruby TypedData
+ *
+ * All sources share one Tcl event source (the multiplexer below).
+ * They sit in a list ordered by priority; each loop turn the
+ * multiplexer runs only the ones that are due.
  * --------------------------------------------------------- */
 
 typedef void (*event_source_check_fn)(void *client_data);
@@ -23,13 +52,43 @@ typedef void (*event_source_check_fn)(void *client_data);
 struct event_source {
     event_source_check_fn check_fn;  /* C function pointer from consumer */
     void *client_data;               /* Opaque data from consumer */
-    Tcl_Time max_block;              /* Max block time for setup proc */
-    int registered;                  /* Whether Tcl event source is active */
+    long long interval_us;           /* Polling interval, 0 for event-driven */
+    long long next_due_us;           /* When a polled source runs next */
+    long long budget_us;             /* Expected max run time, 0 for none */
+    int priority;                    /* Higher runs first */
+    int registered;                  /* Whether linked into the multiplexer */
+    int running;                     /* check_fn calls in progress */
+    int orphaned;                    /* GC'd while running; es_run frees it */
+    unsigned long visit;             /* Last multiplexer scan that reached it */
+    volatile int wake_pending;       /* Set by teek_event_source_wake (any thread) */
+    int deferred;                    /* Due, but pushed to the next turn by the turn budget */
+    int has_deadline;                /* One-shot deadline armed */
+    long long deadline_us;           /* Absolute time of the deadline */
+    int nfds;                        /* Watched file descriptors */
+    int fds[EVENT_SOURCE_MAX_FDS];
+    int fd_masks[EVENT_SOURCE_MAX_FDS];  /* TCL_READABLE/TCL_WRITABLE per fd */
+    unsigned long long runs;         /* Stats for EventSource#stats */
+    unsigned long long overruns;
+    unsigned long long total_us;
+    unsigned long long max_us;
+    struct event_source *next;
 };
 
+/* Multiplexer state. Tcl event sources are per thread; the multiplexer
+ * lives in the thread that registered the first source. */
+static struct event_source *mux_head;
+static int mux_installed;
+static Tcl_ThreadId mux_thread;
+static long long mux_turn_budget_us;  /* Per-turn time for all sources, 0 for none */
+static unsigned long mux_gen;        /* Bumped whenever the list changes */
+static unsigned long mux_scan_id;    /* Last scan started, see mux_check_proc */
+static int mux_in_check;             /* Inside mux_check_proc */
+
 /* Forward declarations */
-static void es_setup_proc(ClientData cd, int flags);
-static void es_check_proc(ClientData cd, int flags);
+static void mux_setup_proc(ClientData cd, int flags);
+static void mux_check_proc(ClientData cd, int flags);
+static void mux_unlink(struct event_source *es);
+static void es_remove_fds(struct event_source *es);
 
 /* ---------------------------------------------------------
  * TypedData functions
@@ -40,8 +99,13 @@ event_source_free(void *ptr)
 {
     struct event_source *es = ptr;
     if (es->registered) {
-        Tcl_DeleteEventSource(es_setup_proc, es_check_proc, (ClientData)es);
-        es->registered = 0;
+        es_remove_fds(es);
+        mux_unlink(es);
+    }
+    /* Collected from inside its own check_fn: es_run still needs it */
+    if (es->running) {
+        es->orphaned = 1;
+        return;
     }
     xfree(es);
 }
@@ -62,39 +126,308 @@ static const rb_data_type_t event_source_type = {
     .flags = RUBY_TYPED_FREE_IMMEDIATELY,
 };
 
+/* ---------------------------------------------------------
+ * Multiplexer list
+ * --------------------------------------------------------- */
+
+/* Insert in priority order, after sources of equal priority */
+static void
+mux_link(struct event_source *es)
+{
+    struct event_source **pp = &mux_head;
+
+    while (*pp && (*pp)->priority >= es->priority) {
+        pp = &(*pp)->next;
+    }
+    es->next = *pp;
+    *pp = es;
+    es->registered = 1;
+    mux_gen++;
+
+    if (!mux_installed) {
+        mux_thread = Tcl_GetCurrentThread();
+        Tcl_CreateEventSource(mux_setup_proc, mux_check_proc, NULL);
+        mux_installed = 1;
+    }
+}
+
+static void
+mux_unlink(struct event_source *es)
+{
+    struct event_source **pp = &mux_head;
+
+    while (*pp && *pp != es) {
+        pp = &(*pp)->next;
+    }
+    if (*pp) *pp = es->next;
+    es->next = NULL;
+    es->registered = 0;
+    mux_gen++;
+
+    /* Tcl_DoOneEvent is walking its event sources while mux_check_proc
+     * runs, so removing ours then would free the entry under it; the
+     * check proc does it on the way out instead. */
+    if (!mux_head && mux_installed && !mux_in_check) {
+        Tcl_DeleteEventSource(mux_setup_proc, mux_check_proc, NULL);
+        mux_installed = 0;
+    }
+}
+
 /* ---------------------------------------------------------
  * Tcl event source callbacks (hot path — pure C)
  * --------------------------------------------------------- */
 
+static long long
+es_now_us(void)
+{
+    Tcl_Time now;
+    Tcl_GetTime(&now);
+    return (long long)now.sec * 1000000LL + now.usec;
+}
+
+/* Whether es should run this turn. Consumes a pending wakeup and an
+ * expired deadline. */
+static int
+es_due(struct event_source *es, long long now)
+{
+    int due = es->deferred;
+
+    if (ES_FLAG_TAKE(&es->wake_pending)) due = 1;
+    if (es->has_deadline && es->deadline_us <= now) {
+        es->has_deadline = 0;
+        due = 1;
+    }
+    if (es->interval_us > 0 && es->next_due_us <= now) due = 1;
+    return due;
+}
+
+/* Run the consumer's check function and account for the time it took.
+ * A polled source that overruns its budget has its next run pushed
+ * back by the excess, so one slow consumer gets proportionally fewer
+ * turns instead of starving the rest. Returns the time after the run.
+ *
+ * check_fn may unregister any source, es included, and a GC it triggers
+ * may collect es; see event_source_free. */
+static long long
+es_run(struct event_source *es, long long start)
+{
+    long long end, elapsed;
+
+    es->running++;
+    es->check_fn(es->client_data);
+    es->running--;
+
+    end = es_now_us();
+    if (es->orphaned && !es->running) {
+        xfree(es);
+        return end;
+    }
+    elapsed = end - start;
+    if (elapsed < 0) elapsed = 0;
+
+    es->runs++;
+    es->total_us += (unsigned long long)elapsed;
+    if ((unsigned long long)elapsed > es->max_us) es->max_us = (unsigned long long)elapsed;
+
+    if (es->interval_us > 0) {
+        es->next_due_us = start + es->interval_us;
+    }
+    if (es->budget_us > 0 && elapsed > es->budget_us) {
+        es->overruns++;
+        if (es->interval_us > 0) es->next_due_us += elapsed - es->budget_us;
+    }
+    return end;
+}
+
 /*
  * Setup proc: called before Tcl_WaitForEvent.
- * Caps the block time so our check proc runs frequently.
+ * Blocks no longer than until the earliest source is due (next polling
+ * time or deadline), and not at all if one was woken or deferred. With
+ * only event-driven sources idle, the block time is left alone.
  */
 static void
-es_setup_proc(ClientData cd, int flags)
+mux_setup_proc(ClientData cd, int flags)
 {
-    struct event_source *es = (struct event_source *)cd;
+    struct event_source *es;
+    long long now, wait = 0;
+    int cap = 0;
+    Tcl_Time block;
 
     if (!(flags & TCL_FILE_EVENTS) && !(flags & TCL_ALL_EVENTS))
         return;
 
-    Tcl_SetMaxBlockTime(&es->max_block);
+    now = es_now_us();
+    for (es = mux_head; es; es = es->next) {
+        if (es->deferred || ES_FLAG_PEEK(&es->wake_pending)) {
+            wait = 0;
+            cap = 1;
+            break;
+        }
+        if (es->interval_us > 0 && (!cap || es->next_due_us - now < wait)) {
+            wait = es->next_due_us - now;
+            cap = 1;
+        }
+        if (es->has_deadline && (!cap || es->deadline_us - now < wait)) {
+            wait = es->deadline_us - now;
+            cap = 1;
+        }
+    }
+    if (!cap) return;
+    if (wait < 0) wait = 0;
+
+    block.sec = wait / 1000000;
+    block.usec = (long)(wait % 1000000);
+    Tcl_SetMaxBlockTime(&block);
 }
 
 /*
  * Check proc: called after Tcl_WaitForEvent returns.
- * Calls the consumer's C function pointer directly.
- * No rb_funcall, no Ruby method dispatch — just a function pointer call.
+ * Runs each due source's C function pointer, highest priority first.
+ * Once the turn budget is spent, the remaining due sources are deferred
+ * to the next turn so Tk events get serviced in between.
+ * No rb_funcall, no Ruby method dispatch — just function pointer calls.
+ *
+ * A check_fn can unregister (or drop the last reference to) any source,
+ * so after a run that changed the list the scan starts over from the
+ * head, skipping the sources this scan already reached. A nested scan
+ * (check_fn running Tcl_DoOneEvent) takes a higher id, so the outer one
+ * skips what it reached too.
  */
 static void
-es_check_proc(ClientData cd, int flags)
+mux_check_proc(ClientData cd, int flags)
 {
-    struct event_source *es = (struct event_source *)cd;
+    struct event_source *es;
+    long long now, turn_start;
+    unsigned long scan, gen;
 
     if (!(flags & TCL_FILE_EVENTS) && !(flags & TCL_ALL_EVENTS))
         return;
 
-    es->check_fn(es->client_data);
+    scan = ++mux_scan_id;
+    mux_in_check++;
+    now = turn_start = es_now_us();
+    es = mux_head;
+    while (es) {
+        if (es->visit >= scan) {
+            es = es->next;
+            continue;
+        }
+        es->visit = scan;
+        if (!es_due(es, now)) {
+            es = es->next;
+            continue;
+        }
+
+        if (mux_turn_budget_us > 0 && now - turn_start >= mux_turn_budget_us) {
+            es->deferred = 1;
+            es = es->next;
+            continue;
+        }
+        es->deferred = 0;
+        gen = mux_gen;
+        now = es_run(es, now);
+        es = mux_gen == gen ? es->next : mux_head;
+    }
+    mux_in_check--;
+
+    if (!mux_in_check && !mux_head && mux_installed) {
+        Tcl_DeleteEventSource(mux_setup_proc, mux_check_proc, NULL);
+        mux_installed = 0;
+    }
+}
+
+/* ---------------------------------------------------------
+ * File descriptors
+ *
+ * Tcl keeps one file handler per descriptor, so sources don't own
+ * theirs: the multiplexer has one handler per watched fd, asking for
+ * the union of every watcher's mask, and runs each watcher whose mask
+ * matched. The handler goes away with the last watcher.
+ * --------------------------------------------------------- */
+
+#ifndef _WIN32
+static void
+mux_file_proc(ClientData cd, int mask)
+{
+    int fd = (int)(intptr_t)cd;
+    struct event_source *es;
+    unsigned long scan, gen;
+    int i, hit;
+
+    scan = ++mux_scan_id;
+    es = mux_head;
+    while (es) {
+        if (es->visit >= scan) {
+            es = es->next;
+            continue;
+        }
+        es->visit = scan;
+        hit = 0;
+        for (i = 0; i < es->nfds; i++) {
+            if (es->fds[i] == fd && (es->fd_masks[i] & mask)) hit = 1;
+        }
+        if (!hit) {
+            es = es->next;
+            continue;
+        }
+        gen = mux_gen;
+        es_run(es, es_now_us());
+        es = mux_gen == gen ? es->next : mux_head;
+    }
+}
+
+/* Point the fd's Tcl handler at the current set of watchers */
+static void
+mux_sync_fd(int fd)
+{
+    struct event_source *es;
+    int i, mask = 0;
+
+    for (es = mux_head; es; es = es->next) {
+        for (i = 0; i < es->nfds; i++) {
+            if (es->fds[i] == fd) mask |= es->fd_masks[i];
+        }
+    }
+    if (mask) {
+        Tcl_CreateFileHandler(fd, mask, mux_file_proc, (ClientData)(intptr_t)fd);
+    } else {
+        Tcl_DeleteFileHandler(fd);
+    }
+}
+#endif
+
+static void
+es_remove_fds(struct event_source *es)
+{
+#ifndef _WIN32
+    int fds[EVENT_SOURCE_MAX_FDS];
+    int i, n = es->nfds;
+
+    for (i = 0; i < n; i++) fds[i] = es->fds[i];
+    es->nfds = 0;
+    for (i = 0; i < n; i++) mux_sync_fd(fds[i]);
+#endif
+    es->nfds = 0;
+}
+
+/*
+ * teek_event_source_wake(handle)
+ *
+ * Make the source's check function run on its next event loop
+ * iteration, waking the notifier if it is blocked. Safe to call from
+ * any thread (e.g. an audio or decoder thread); it only sets a flag
+ * and calls Tcl_ThreadAlert. Consumers get the address via
+ * Teek._event_source_wake_fn_ptr and the handle via EventSource#handle.
+ * The source must stay registered while other threads may call this.
+ */
+static void
+teek_event_source_wake(void *handle)
+{
+    struct event_source *es = (struct event_source *)handle;
+
+    if (!es || !es->registered) return;
+    ES_FLAG_SET(&es->wake_pending);
+    Tcl_ThreadAlert(mux_thread);
 }
 
 /* ---------------------------------------------------------
@@ -102,45 +435,73 @@ es_check_proc(ClientData cd, int flags)
  * --------------------------------------------------------- */
 
 /*
- * Teek._register_event_source(check_fn_ptr, client_data_ptr, interval_ms) -> EventSource
+ * Teek._register_event_source(check_fn_ptr, client_data_ptr, interval_ms, opts = {}) -> EventSource
  *
- * Registers a C function as a Tcl event source. The function will be called
- * on every event loop iteration with no Ruby overhead.
+ * Registers a C function with the event source multiplexer. The function
+ * is called with no Ruby overhead: every interval_ms for a polled source,
+ * and otherwise only when the source is woken, a watched fd is ready, or
+ * a deadline passes. Sources that aren't due are skipped, and the notifier
+ * blocks until the earliest one is.
  *
  * check_fn_ptr:    Integer — address of a C function with signature void(*)(void*)
  * client_data_ptr: Integer — address passed to check_fn (0 for NULL)
- * interval_ms:     Integer — max block time in ms (e.g. 16 for ~60fps)
+ * interval_ms:     Integer — polling interval in ms (e.g. 16 for ~60fps), or
+ *                  nil/0 for an event-driven source whose check_fn runs
+ *                  only on fd readiness (#watch_fd), wakeups (#wake) and
+ *                  deadlines (#wake_after)
+ * opts:            Hash —
+ *                  :priority  — Integer, higher runs first in a turn (default 0)
+ *                  :budget_us — Integer, expected max run time; a polled
+ *                               source that overruns it is delayed by the
+ *                               excess (default: no budget)
  *
  * Returns an opaque EventSource object. Hold a reference to keep it alive.
  * Call #unregister or let GC collect it to remove the event source.
  */
 static VALUE
-teek_register_event_source(VALUE self, VALUE fn_ptr, VALUE data_ptr, VALUE interval)
+teek_register_event_source(int argc, VALUE *argv, VALUE self)
 {
     struct event_source *es;
-    VALUE obj;
-    int ms;
+    VALUE fn_ptr, data_ptr, interval, opts, obj;
+    event_source_check_fn fn;
+    long long budget = 0;
+    int ms, priority = 0;
+
+    rb_scan_args(argc, argv, "31", &fn_ptr, &data_ptr, &interval, &opts);
 
     /* Validate */
-    event_source_check_fn fn = (event_source_check_fn)(uintptr_t)NUM2ULL(fn_ptr);
+    fn = (event_source_check_fn)(uintptr_t)NUM2ULL(fn_ptr);
     if (!fn) {
         rb_raise(rb_eArgError, "check_fn_ptr must not be NULL");
     }
+    if (mux_installed && Tcl_GetCurrentThread() != mux_thread) {
+        rb_raise(rb_eRuntimeError, "event sources must all be registered from one thread");
+    }
 
-    ms = NUM2INT(interval);
-    if (ms < 1) ms = 1;
+    ms = NIL_P(interval) ? 0 : NUM2INT(interval);
+    if (ms < 0) ms = 0;
+
+    if (!NIL_P(opts)) {
+        VALUE v;
+        Check_Type(opts, T_HASH);
+        v = rb_hash_aref(opts, ID2SYM(rb_intern("priority")));
+        if (!NIL_P(v)) priority = NUM2INT(v);
+        v = rb_hash_aref(opts, ID2SYM(rb_intern("budget_us")));
+        if (!NIL_P(v)) budget = NUM2LL(v);
+        if (budget < 0) budget = 0;
+    }
 
-    /* Allocate and populate */
+    /* Allocate and populate (zeroed by TypedData_Make_Struct) */
     obj = TypedData_Make_Struct(cEventSource, struct event_source, &event_source_type, es);
     es->check_fn = fn;
     es->client_data = (void *)(uintptr_t)NUM2ULL(data_ptr);
-    es->max_block.sec = ms / 1000;
-    es->max_block.usec = (ms % 1000) * 1000;
-    es->registered = 0;
+    es->interval_us = (long long)ms * 1000;
+    es->next_due_us = es_now_us();
+    es->budget_us = budget;
+    es->priority = priority;
 
-    /* Register with Tcl */
-    Tcl_CreateEventSource(es_setup_proc, es_check_proc, (ClientData)es);
-    es->registered = 1;
+    /* Hook into the multiplexer (installing it with Tcl if needed) */
+    mux_link(es);
 
     return obj;
 }
@@ -148,8 +509,9 @@ teek_register_event_source(VALUE self, VALUE fn_ptr, VALUE data_ptr, VALUE inter
 /*
  * EventSource#unregister -> nil
  *
- * Explicitly removes the event source from Tcl's notifier.
- * Safe to call multiple times.
+ * Explicitly removes the event source from the multiplexer; the shared
+ * Tcl event source goes away with the last one. Safe to call multiple
+ * times.
  */
 static VALUE
 event_source_unregister(VALUE self)
@@ -158,12 +520,250 @@ event_source_unregister(VALUE self)
     TypedData_Get_Struct(self, struct event_source, &event_source_type, es);
 
     if (es->registered) {
-        Tcl_DeleteEventSource(es_setup_proc, es_check_proc, (ClientData)es);
-        es->registered = 0;
+        es_remove_fds(es);
+        es->has_deadline = 0;
+        es->deferred = 0;
+        mux_unlink(es);
     }
     return Qnil;
 }
 
+static struct event_source *
+get_registered_source(VALUE self)
+{
+    struct event_source *es;
+    TypedData_Get_Struct(self, struct event_source, &event_source_type, es);
+    if (!es->registered) {
+        rb_raise(rb_eRuntimeError, "event source is not registered");
+    }
+    return es;
+}
+
+/*
+ * EventSource#watch_fd(fd, mask = :readable) -> self
+ *
+ * Run check_fn whenever fd is ready, via Tcl_CreateFileHandler, instead
+ * of polling for it. mask is :readable, :writable, or an Array of both.
+ * Up to 8 descriptors per source; watching an fd again replaces its mask.
+ * Several sources may watch the same fd; each runs when it's ready.
+ * Must be called on the thread that registered the source.
+ * Raises NotImplementedError on Windows, where Tcl has no file handlers.
+ */
+static VALUE
+event_source_watch_fd(int argc, VALUE *argv, VALUE self)
+{
+#ifdef _WIN32
+    rb_raise(rb_eNotImpError, "watch_fd is not supported on Windows");
+    return Qnil;
+#else
+    struct event_source *es = get_registered_source(self);
+    VALUE vfd, vmask, list;
+    int fd, mask = 0, i, slot;
+    long k;
+
+    rb_scan_args(argc, argv, "11", &vfd, &vmask);
+    fd = NUM2INT(vfd);
+    if (fd < 0) {
+        rb_raise(rb_eArgError, "invalid file descriptor: %d", fd);
+    }
+
+    list = NIL_P(vmask) ? rb_ary_new_from_args(1, ID2SYM(rb_intern("readable")))
+                        : rb_Array(vmask);
+    for (k = 0; k < RARRAY_LEN(list); k++) {
+        VALUE m = RARRAY_AREF(list, k);
+        if (m == ID2SYM(rb_intern("readable"))) mask |= TCL_READABLE;
+        else if (m == ID2SYM(rb_intern("writable"))) mask |= TCL_WRITABLE;
+        else rb_raise(rb_eArgError, "mask must be :readable and/or :writable");
+    }
+    if (!mask) {
+        rb_raise(rb_eArgError, "mask must be :readable and/or :writable");
+    }
+
+    slot = es->nfds;
+    for (i = 0; i < es->nfds; i++) {
+        if (es->fds[i] == fd) slot = i;
+    }
+    if (slot == EVENT_SOURCE_MAX_FDS) {
+        rb_raise(rb_eArgError, "an event source can watch at most %d descriptors",
+                 EVENT_SOURCE_MAX_FDS);
+    }
+
+    es->fds[slot] = fd;
+    es->fd_masks[slot] = mask;
+    if (slot == es->nfds) es->nfds++;
+    mux_sync_fd(fd);
+    return self;
+#endif
+}
+
+/*
+ * EventSource#unwatch_fd(fd) -> true/false
+ *
+ * Stop watching fd. Returns whether it was being watched.
+ */
+static VALUE
+event_source_unwatch_fd(VALUE self, VALUE vfd)
+{
+    struct event_source *es;
+    int fd = NUM2INT(vfd), i;
+
+    TypedData_Get_Struct(self, struct event_source, &event_source_type, es);
+    for (i = 0; i < es->nfds; i++) {
+        if (es->fds[i] == fd) {
+            es->nfds--;
+            es->fds[i] = es->fds[es->nfds];
+            es->fd_masks[i] = es->fd_masks[es->nfds];
+#ifndef _WIN32
+            mux_sync_fd(fd);
+#endif
+            return Qtrue;
+        }
+    }
+    return Qfalse;
+}
+
+/*
+ * EventSource#wake_after(ms) -> self
+ *
+ * Arm a one-shot deadline: check_fn runs once ms milliseconds from now
+ * (Float for sub-millisecond precision), with the notifier blocking
+ * exactly until then rather than waking on a fixed interval. Replaces
+ * any deadline already armed.
+ */
+static VALUE
+event_source_wake_after(VALUE self, VALUE ms)
+{
+    struct event_source *es = get_registered_source(self);
+    double delay = NUM2DBL(ms);
+
+    if (delay < 0) delay = 0;
+    es->deadline_us = es_now_us() + (long long)(delay * 1000.0);
+    es->has_deadline = 1;
+    return self;
+}
+
+/*
+ * EventSource#cancel_wake -> true/false
+ *
+ * Disarm the deadline set by #wake_after. Returns whether one was armed.
+ */
+static VALUE
+event_source_cancel_wake(VALUE self)
+{
+    struct event_source *es;
+    int had;
+
+    TypedData_Get_Struct(self, struct event_source, &event_source_type, es);
+    had = es->has_deadline;
+    es->has_deadline = 0;
+    return had ? Qtrue : Qfalse;
+}
+
+/*
+ * EventSource#wake -> nil
+ *
+ * Ruby-side teek_event_source_wake: check_fn runs on the next event
+ * loop iteration. Callable from any Ruby thread.
+ */
+static VALUE
+event_source_wake(VALUE self)
+{
+    struct event_source *es;
+    TypedData_Get_Struct(self, struct event_source, &event_source_type, es);
+    teek_event_source_wake(es);
+    return Qnil;
+}
+
+/*
+ * EventSource#handle -> Integer
+ *
+ * Address to pass to teek_event_source_wake from C.
+ */
+static VALUE
+event_source_handle(VALUE self)
+{
+    struct event_source *es;
+    TypedData_Get_Struct(self, struct event_source, &event_source_type, es);
+    return ULL2NUM((uintptr_t)es);
+}
+
+/*
+ * EventSource#polled? -> true/false
+ *
+ * Whether check_fn also runs on a fixed interval.
+ */
+static VALUE
+event_source_polled_p(VALUE self)
+{
+    struct event_source *es;
+    TypedData_Get_Struct(self, struct event_source, &event_source_type, es);
+    return es->interval_us > 0 ? Qtrue : Qfalse;
+}
+
+/*
+ * EventSource#priority -> Integer
+ */
+static VALUE
+event_source_priority(VALUE self)
+{
+    struct event_source *es;
+    TypedData_Get_Struct(self, struct event_source, &event_source_type, es);
+    return INT2NUM(es->priority);
+}
+
+/*
+ * EventSource#stats -> Hash
+ *
+ * { runs:, overruns:, total_us:, max_us: } — how often check_fn ran,
+ * how many runs exceeded :budget_us, and time spent in it.
+ */
+static VALUE
+event_source_stats(VALUE self)
+{
+    struct event_source *es;
+    VALUE h = rb_hash_new();
+
+    TypedData_Get_Struct(self, struct event_source, &event_source_type, es);
+    rb_hash_aset(h, ID2SYM(rb_intern("runs")), ULL2NUM(es->runs));
+    rb_hash_aset(h, ID2SYM(rb_intern("overruns")), ULL2NUM(es->overruns));
+    rb_hash_aset(h, ID2SYM(rb_intern("total_us")), ULL2NUM(es->total_us));
+    rb_hash_aset(h, ID2SYM(rb_intern("max_us")), ULL2NUM(es->max_us));
+    return h;
+}
+
+/*
+ * Teek._event_source_turn_budget_us -> Integer
+ * Teek._event_source_turn_budget_us = usec
+ *
+ * Time all sources together may spend per event loop turn (0, the
+ * default, for no limit). Due sources left over when it runs out are
+ * deferred to the next turn, lower priorities first.
+ */
+static VALUE
+teek_get_turn_budget(VALUE self)
+{
+    return LL2NUM(mux_turn_budget_us);
+}
+
+static VALUE
+teek_set_turn_budget(VALUE self, VALUE usec)
+{
+    long long v = NUM2LL(usec);
+    mux_turn_budget_us = v > 0 ? v : 0;
+    return usec;
+}
+
+/*
+ * Teek._event_source_wake_fn_ptr -> Integer
+ *
+ * Address of teek_event_source_wake, signature void(*)(void *handle).
+ */
+static VALUE
+teek_event_source_wake_fn_ptr(VALUE self)
+{
+    return ULL2NUM((uintptr_t)teek_event_source_wake);
+}
+
 /*
  * EventSource#registered? -> true/false
  */
@@ -189,7 +789,22 @@ Init_tkeventsource(VALUE mTeek)
 
     rb_define_method(cEventSource, "unregister", event_source_unregister, 0);
     rb_define_method(cEventSource, "registered?", event_source_registered_p, 0);
+    rb_define_method(cEventSource, "polled?", event_source_polled_p, 0);
+    rb_define_method(cEventSource, "priority", event_source_priority, 0);
+    rb_define_method(cEventSource, "stats", event_source_stats, 0);
+    rb_define_method(cEventSource, "watch_fd", event_source_watch_fd, -1);
+    rb_define_method(cEventSource, "unwatch_fd", event_source_unwatch_fd, 1);
+    rb_define_method(cEventSource, "wake_after", event_source_wake_after, 1);
+    rb_define_method(cEventSource, "cancel_wake", event_source_cancel_wake, 0);
+    rb_define_method(cEventSource, "wake", event_source_wake, 0);
+    rb_define_method(cEventSource, "handle", event_source_handle, 0);
 
     rb_define_module_function(mTeek, "_register_event_source",
-                             teek_register_event_source, 3);
+                             teek_register_event_source, -1);
+    rb_define_module_function(mTeek, "_event_source_wake_fn_ptr",
+                             teek_event_source_wake_fn_ptr, 0);
+    rb_define_module_function(mTeek, "_event_source_turn_budget_us",
+                             teek_get_turn_budget, 0);
+    rb_define_module_function(mTeek, "_event_source_turn_budget_us=",
+                             teek_set_turn_budget, 1);
 }
@@ -5,37 +5,111 @@
  */
 
 #include "tcltkbridge.h"
+#include <ruby/encoding.h>
+
+static VALUE cFontHandle;
+static ID id_font_handles;
 
 /* ---------------------------------------------------------
- * Interp#text_width(font_name, text)
- *
- * Measure pixel width of text string using Tk_TextWidth.
- * Faster than querying via Tcl font measure command.
- *
- * Arguments:
- *   font_name - Font description string (e.g., "Helvetica 12", "TkDefaultFont")
- *   text      - Text string to measure
+ * Teek::FontHandle - a Tk_Font held open across calls
  *
- * Returns integer pixel width.
+ * Every string-font call below goes through Tk_GetFont/Tk_FreeFont,
+ * which re-parses the description and looks it up in Tk's font cache
+ * each time. A handle does that once and keeps the Tk_Font until
+ * #release.
  *
- * See: https://www.tcl-lang.org/man/tcl9.0/TkLib/MeasureChar.html
+ * Handles are created by Interp#font_handle and registered on the
+ * interp (hidden ivar, keyed by font description), so they stay alive
+ * until released and the same description always returns the same
+ * handle. The Tk_Font is only ever freed from #release with the interp
+ * still alive: once the interp is deleted Tk has torn down its font
+ * cache (and the font with it), and a GC'd handle can only be one whose
+ * interp is being collected too - so dfree never calls into Tk.
  * --------------------------------------------------------- */
 
+/* Glyph advance widths are memoized for U+0000..U+024F (ASCII, Latin-1
+ * and Latin Extended-A/B) - enough for most table/list content. */
+#define GLYPH_CACHE_SIZE 0x250
+
+/* A named font changes in place under "font configure" (same Tk_Font,
+ * new size or weight), so the cache is stamped with the font's metrics
+ * and the width of this string, and rebuilt when they no longer match */
+#define GLYPH_CACHE_PROBE "Wm0il"
+
+struct font_handle {
+    VALUE interp;              /* Teek::Interp (GC-marked) */
+    VALUE name;                /* Frozen String (GC-marked) */
+    Tk_Font tkfont;            /* NULL once released */
+    short *glyph_w;            /* GLYPH_CACHE_SIZE widths, -1 = not measured
+                                * yet; allocated on first fit_text */
+    int glyph_key[4];          /* ascent, descent, linespace, probe width
+                                * the widths were measured at */
+};
+
+static void
+fh_mark(void *ptr)
+{
+    struct font_handle *fh = ptr;
+    rb_gc_mark(fh->interp);
+    rb_gc_mark(fh->name);
+}
+
+static void
+fh_free(void *ptr)
+{
+    struct font_handle *fh = ptr;
+    xfree(fh->glyph_w);
+    xfree(fh);
+}
+
+static size_t
+fh_memsize(const void *ptr)
+{
+    const struct font_handle *fh = ptr;
+    return sizeof(struct font_handle) +
+           (fh->glyph_w ? GLYPH_CACHE_SIZE * sizeof(short) : 0);
+}
+
+static const rb_data_type_t fh_type = {
+    .wrap_struct_name = "Teek::FontHandle",
+    .function = {
+        .dmark = fh_mark,
+        .dfree = fh_free,
+        .dsize = fh_memsize,
+    },
+    .flags = RUBY_TYPED_FREE_IMMEDIATELY,
+};
+
 static VALUE
-interp_text_width(VALUE self, VALUE font_name, VALUE text)
+fh_alloc(VALUE klass)
 {
-    struct tcltk_interp *tip = get_interp(self);
-    Tk_Window mainWin;
-    Tk_Font tkfont;
-    const char *font_str;
-    const char *text_str;
-    int width;
+    struct font_handle *fh;
+    VALUE obj = TypedData_Make_Struct(klass, struct font_handle, &fh_type, fh);
+    fh->interp = Qnil;
+    fh->name = Qnil;
+    fh->tkfont = NULL;
+    fh->glyph_w = NULL;
+    return obj;
+}
 
-    StringValue(font_name);
-    StringValue(text);
+/* Live handle, or raise: released, or its interp has been deleted */
+static struct font_handle *
+get_fh(VALUE self)
+{
+    struct font_handle *fh;
+    TypedData_Get_Struct(self, struct font_handle, &fh_type, fh);
+    if (!fh->tkfont) {
+        rb_raise(eTclError, "font handle has been released");
+    }
+    get_interp(fh->interp);
+    return fh;
+}
 
-    font_str = StringValueCStr(font_name);
-    text_str = StringValueCStr(text);
+static Tk_Font
+get_tkfont(struct tcltk_interp *tip, const char *font_str)
+{
+    Tk_Window mainWin;
+    Tk_Font tkfont;
 
     /* Get the main window for font allocation */
     mainWin = Tk_MainWindow(tip->interp);
@@ -43,30 +117,232 @@ interp_text_width(VALUE self, VALUE font_name, VALUE text)
         rb_raise(eTclError, "Tk not initialized (no main window)");
     }
 
-    /* Get the font */
     tkfont = Tk_GetFont(tip->interp, mainWin, font_str);
     if (!tkfont) {
         rb_raise(eTclError, "font not found: %s - %s",
                  font_str, Tcl_GetStringResult(tip->interp));
     }
+    return tkfont;
+}
+
+/* Resolve a font argument: a FontHandle of this interp is used as-is,
+ * anything else is a description looked up with Tk_GetFont. *owned is
+ * set when the caller must Tk_FreeFont the result. */
+static Tk_Font
+font_acquire(VALUE self, struct tcltk_interp *tip, VALUE font, int *owned)
+{
+    if (rb_typeddata_is_kind_of(font, &fh_type)) {
+        struct font_handle *fh = get_fh(font);
+        if (fh->interp != self) {
+            rb_raise(rb_eArgError, "font handle belongs to another interpreter");
+        }
+        *owned = 0;
+        return fh->tkfont;
+    }
+    *owned = 1;
+    return get_tkfont(tip, StringValueCStr(font));
+}
+
+static void
+font_done(Tk_Font tkfont, int owned)
+{
+    if (owned) Tk_FreeFont(tkfont);
+}
+
+/* ---------------------------------------------------------
+ * Interp#font_handle(font_name)
+ *
+ * Get a Teek::FontHandle for a font description, creating it on first
+ * use. Later calls with the same description return the same handle
+ * until it is released.
+ *
+ * Arguments:
+ *   font_name - Font description string (e.g., "Helvetica 12", "TkDefaultFont")
+ *
+ * Returns a Teek::FontHandle.
+ *
+ * See: https://www.tcl-lang.org/man/tcl9.0/TkLib/GetFont.html
+ * --------------------------------------------------------- */
+
+static VALUE
+interp_font_handle(VALUE self, VALUE font_name)
+{
+    struct tcltk_interp *tip = get_interp(self);
+    struct font_handle *fh;
+    VALUE handles, handle;
+
+    StringValue(font_name);
+
+    handles = rb_ivar_get(self, id_font_handles);
+    if (NIL_P(handles)) {
+        handles = rb_hash_new();
+        rb_ivar_set(self, id_font_handles, handles);
+    }
+
+    handle = rb_hash_aref(handles, font_name);
+    if (!NIL_P(handle)) return handle;
+
+    handle = fh_alloc(cFontHandle);
+    TypedData_Get_Struct(handle, struct font_handle, &fh_type, fh);
+    fh->tkfont = get_tkfont(tip, StringValueCStr(font_name));
+    RB_OBJ_WRITE(handle, &fh->interp, self);
+    RB_OBJ_WRITE(handle, &fh->name, rb_str_new_frozen(font_name));
+
+    rb_hash_aset(handles, fh->name, handle);
+    return handle;
+}
+
+/* FontHandle#name - the font description it was created from */
+static VALUE
+fh_name(VALUE self)
+{
+    struct font_handle *fh;
+    TypedData_Get_Struct(self, struct font_handle, &fh_type, fh);
+    return fh->name;
+}
+
+/* FontHandle#interp */
+static VALUE
+fh_interp(VALUE self)
+{
+    struct font_handle *fh;
+    TypedData_Get_Struct(self, struct font_handle, &fh_type, fh);
+    return fh->interp;
+}
+
+static VALUE
+fh_released_p(VALUE self)
+{
+    struct font_handle *fh;
+    TypedData_Get_Struct(self, struct font_handle, &fh_type, fh);
+    return fh->tkfont ? Qfalse : Qtrue;
+}
+
+/* ---------------------------------------------------------
+ * FontHandle#release
+ *
+ * Free the Tk_Font and unregister the handle; the next
+ * Interp#font_handle for the same description makes a new one.
+ * Releasing twice, or after the interp was deleted, is a no-op.
+ * --------------------------------------------------------- */
+
+static VALUE
+fh_release(VALUE self)
+{
+    struct font_handle *fh;
+    struct tcltk_interp *tip;
+    VALUE handles;
+
+    TypedData_Get_Struct(self, struct font_handle, &fh_type, fh);
+    if (!fh->tkfont) return Qnil;
+
+    TypedData_Get_Struct(fh->interp, struct tcltk_interp, &interp_type, tip);
+    if (!tip->deleted && tip->interp) {
+        Tk_FreeFont(fh->tkfont);
+    }
+    fh->tkfont = NULL;
+    xfree(fh->glyph_w);
+    fh->glyph_w = NULL;
+
+    handles = rb_ivar_get(fh->interp, id_font_handles);
+    if (!NIL_P(handles) && rb_hash_aref(handles, fh->name) == self) {
+        rb_hash_delete(handles, fh->name);
+    }
+    return Qnil;
+}
+
+/* ---------------------------------------------------------
+ * Interp#text_width(font, text)
+ *
+ * Measure pixel width of text string using Tk_TextWidth.
+ * Faster than querying via Tcl font measure command.
+ *
+ * Arguments:
+ *   font - Font description string (e.g., "Helvetica 12", "TkDefaultFont")
+ *          or a Teek::FontHandle
+ *   text - Text string to measure
+ *
+ * Returns integer pixel width.
+ *
+ * See: https://www.tcl-lang.org/man/tcl9.0/TkLib/MeasureChar.html
+ * --------------------------------------------------------- */
+
+static VALUE
+interp_text_width(VALUE self, VALUE font, VALUE text)
+{
+    struct tcltk_interp *tip = get_interp(self);
+    Tk_Font tkfont;
+    const char *text_str;
+    int owned, width;
+
+    StringValue(text);
+    text_str = StringValueCStr(text);
+
+    tkfont = font_acquire(self, tip, font, &owned);
 
     /* Measure the text width */
     width = Tk_TextWidth(tkfont, text_str, (int)strlen(text_str));
 
-    /* Release the font */
-    Tk_FreeFont(tkfont);
+    font_done(tkfont, owned);
 
     return INT2NUM(width);
 }
 
 /* ---------------------------------------------------------
- * Interp#font_metrics(font_name)
+ * Interp#text_widths(font, strings)
+ *
+ * Measure a whole array of strings with one font lookup, for layout
+ * code that sizes many cells per redraw.
+ *
+ * Arguments:
+ *   font    - Font description string or a Teek::FontHandle
+ *   strings - Array of Strings
+ *
+ * Returns Array of integer pixel widths, in the same order.
+ *
+ * See: https://www.tcl-lang.org/man/tcl9.0/TkLib/MeasureChar.html
+ * --------------------------------------------------------- */
+
+static VALUE
+interp_text_widths(VALUE self, VALUE font, VALUE strings)
+{
+    struct tcltk_interp *tip = get_interp(self);
+    Tk_Font tkfont;
+    VALUE result;
+    long i, n;
+    int owned;
+
+    Check_Type(strings, T_ARRAY);
+    n = RARRAY_LEN(strings);
+
+    /* Type-check everything first so a bad element can't leak the font */
+    for (i = 0; i < n; i++) {
+        Check_Type(RARRAY_AREF(strings, i), T_STRING);
+    }
+
+    tkfont = font_acquire(self, tip, font, &owned);
+
+    result = rb_ary_new_capa(n);
+    for (i = 0; i < n; i++) {
+        VALUE str = RARRAY_AREF(strings, i);
+        rb_ary_push(result, INT2NUM(Tk_TextWidth(tkfont, RSTRING_PTR(str),
+                                                 (int)RSTRING_LEN(str))));
+    }
+
+    font_done(tkfont, owned);
+
+    return result;
+}
+
+/* ---------------------------------------------------------
+ * Interp#font_metrics(font)
  *
  * Get font metrics using Tk_GetFontMetrics.
  * Faster than querying via Tcl font metrics command.
  *
  * Arguments:
- *   font_name - Font description string (e.g., "Helvetica 12", "TkDefaultFont")
+ *   font - Font description string (e.g., "Helvetica 12", "TkDefaultFont")
+ *          or a Teek::FontHandle
  *
  * Returns Hash with:
  *   :ascent   - Pixels from baseline to top of highest character
@@ -77,54 +353,39 @@ interp_text_width(VALUE self, VALUE font_name, VALUE text)
  * --------------------------------------------------------- */
 
 static VALUE
-interp_font_metrics(VALUE self, VALUE font_name)
+interp_font_metrics(VALUE self, VALUE font)
 {
     struct tcltk_interp *tip = get_interp(self);
-    Tk_Window mainWin;
     Tk_Font tkfont;
     Tk_FontMetrics fm;
-    const char *font_str;
     VALUE result;
+    int owned;
 
-    StringValue(font_name);
-    font_str = StringValueCStr(font_name);
-
-    /* Get the main window for font allocation */
-    mainWin = Tk_MainWindow(tip->interp);
-    if (!mainWin) {
-        rb_raise(eTclError, "Tk not initialized (no main window)");
-    }
-
-    /* Get the font */
-    tkfont = Tk_GetFont(tip->interp, mainWin, font_str);
-    if (!tkfont) {
-        rb_raise(eTclError, "font not found: %s - %s",
-                 font_str, Tcl_GetStringResult(tip->interp));
-    }
+    tkfont = font_acquire(self, tip, font, &owned);
 
     /* Get font metrics */
     Tk_GetFontMetrics(tkfont, &fm);
 
+    font_done(tkfont, owned);
+
     /* Build result hash */
     result = rb_hash_new();
     rb_hash_aset(result, ID2SYM(rb_intern("ascent")), INT2NUM(fm.ascent));
     rb_hash_aset(result, ID2SYM(rb_intern("descent")), INT2NUM(fm.descent));
     rb_hash_aset(result, ID2SYM(rb_intern("linespace")), INT2NUM(fm.linespace));
 
-    /* Release the font */
-    Tk_FreeFont(tkfont);
-
     return result;
 }
 
 /* ---------------------------------------------------------
- * Interp#measure_chars(font_name, text, max_pixels, opts={})
+ * Interp#measure_chars(font, text, max_pixels, opts={})
  *
  * Measure how many characters/bytes of text fit within a pixel width limit.
  * Useful for text truncation, ellipsis, and line wrapping.
  *
  * Arguments:
- *   font_name  - Font description string (e.g., "Helvetica 12")
+ *   font       - Font description string (e.g., "Helvetica 12")
+ *                or a Teek::FontHandle
  *   text       - Text string to measure
  *   max_pixels - Maximum pixel width allowed (-1 for unlimited)
  *   opts       - Optional hash:
@@ -143,23 +404,20 @@ static VALUE
 interp_measure_chars(int argc, VALUE *argv, VALUE self)
 {
     struct tcltk_interp *tip = get_interp(self);
-    VALUE font_name, text, max_pixels_val, opts;
-    Tk_Window mainWin;
+    VALUE font, text, max_pixels_val, opts;
     Tk_Font tkfont;
-    const char *font_str;
     const char *text_str;
     int max_pixels;
     int flags;
     int length;
     int num_bytes;
+    int owned;
     VALUE result;
 
-    rb_scan_args(argc, argv, "31", &font_name, &text, &max_pixels_val, &opts);
+    rb_scan_args(argc, argv, "31", &font, &text, &max_pixels_val, &opts);
 
-    StringValue(font_name);
     StringValue(text);
 
-    font_str = StringValueCStr(font_name);
     text_str = StringValueCStr(text);
     max_pixels = NUM2INT(max_pixels_val);
 
@@ -175,25 +433,13 @@ interp_measure_chars(int argc, VALUE *argv, VALUE self)
         if (RTEST(val)) flags |= TK_AT_LEAST_ONE;
     }
 
-    /* Get the main window for font allocation */
-    mainWin = Tk_MainWindow(tip->interp);
-    if (!mainWin) {
-        rb_raise(eTclError, "Tk not initialized (no main window)");
-    }
-
-    /* Get the font */
-    tkfont = Tk_GetFont(tip->interp, mainWin, font_str);
-    if (!tkfont) {
-        rb_raise(eTclError, "font not found: %s - %s",
-                 font_str, Tcl_GetStringResult(tip->interp));
-    }
+    tkfont = font_acquire(self, tip, font, &owned);
 
     /* Measure characters */
     num_bytes = Tk_MeasureChars(tkfont, text_str, (int)strlen(text_str),
                                  max_pixels, flags, &length);
 
-    /* Release the font */
-    Tk_FreeFont(tkfont);
+    font_done(tkfont, owned);
 
     /* Build result hash */
     result = rb_hash_new();
@@ -203,6 +449,183 @@ interp_measure_chars(int argc, VALUE *argv, VALUE self)
     return result;
 }
 
+/* ---------------------------------------------------------
+ * Text fitting (Interp#fit_text)
+ *
+ * Truncating a column of strings to a pixel width by bisecting with
+ * measure_chars costs several Tk measurements per string. Instead,
+ * each FontHandle memoizes the advance width of every ASCII/Latin
+ * glyph it has seen, and a string made only of those glyphs is fitted
+ * by summing cached widths - no Tk call at all once the cache is warm.
+ * Strings with other characters fall back to Tk_MeasureChars.
+ *
+ * Summing advances matches Tk's own measurement on X11 and Windows,
+ * which don't kern. Core Text on macOS can, so there the chosen prefix
+ * is checked with Tk_TextWidth and backed off a character if kerning
+ * pushed it over.
+ * --------------------------------------------------------- */
+
+/* Decode one UTF-8 character at s (n bytes available). Returns its
+ * length, or 0 if the sequence is malformed. */
+static int
+utf8_decode(const unsigned char *s, long n, int *cp)
+{
+    if (s[0] < 0x80) { *cp = s[0]; return 1; }
+    if ((s[0] & 0xE0) == 0xC0 && n >= 2 && (s[1] & 0xC0) == 0x80) {
+        *cp = ((s[0] & 0x1F) << 6) | (s[1] & 0x3F);
+        return 2;
+    }
+    if ((s[0] & 0xF0) == 0xE0 && n >= 3) { *cp = 0x10000; return 3; }
+    if ((s[0] & 0xF8) == 0xF0 && n >= 4) { *cp = 0x10000; return 4; }
+    return 0;
+}
+
+/* Allocate the glyph cache, or clear it if the font has changed since
+ * it was filled */
+static void
+glyph_cache_check(struct font_handle *fh)
+{
+    Tk_FontMetrics fm;
+    int key[4], i;
+
+    Tk_GetFontMetrics(fh->tkfont, &fm);
+    key[0] = fm.ascent;
+    key[1] = fm.descent;
+    key[2] = fm.linespace;
+    key[3] = Tk_TextWidth(fh->tkfont, GLYPH_CACHE_PROBE, (int)strlen(GLYPH_CACHE_PROBE));
+
+    if (fh->glyph_w && memcmp(key, fh->glyph_key, sizeof(key)) == 0) return;
+    if (!fh->glyph_w) fh->glyph_w = ALLOC_N(short, GLYPH_CACHE_SIZE);
+    for (i = 0; i < GLYPH_CACHE_SIZE; i++) fh->glyph_w[i] = -1;
+    memcpy(fh->glyph_key, key, sizeof(key));
+}
+
+static int
+glyph_width(struct font_handle *fh, const unsigned char *s, int len, int cp)
+{
+    if (fh->glyph_w[cp] < 0) {
+        fh->glyph_w[cp] = (short)Tk_TextWidth(fh->tkfont, (const char *)s, len);
+    }
+    return fh->glyph_w[cp];
+}
+
+/* Bytes of str to keep so that prefix + ellipsis fits in max_pixels, or
+ * -1 if the whole string fits. */
+static long
+fit_one(struct font_handle *fh, const char *str, long len, int max_pixels,
+        int ell_w)
+{
+    const unsigned char *s = (const unsigned char *)str;
+    long pos = 0, cut = 0;
+    int w = 0;
+    int bytes, width;
+
+    while (pos < len) {
+        int cp, n = utf8_decode(s + pos, len - pos, &cp);
+        if (n == 0 || cp >= GLYPH_CACHE_SIZE) goto slow;
+        w += glyph_width(fh, s + pos, n, cp);
+        if (w > max_pixels) break;
+        pos += n;
+        if (w + ell_w <= max_pixels) cut = pos;
+    }
+    if (pos == len) return -1;
+
+#ifdef __APPLE__
+    while (cut > 0 && Tk_TextWidth(fh->tkfont, str, (int)cut) + ell_w > max_pixels) {
+        do { cut--; } while (cut > 0 && (s[cut] & 0xC0) == 0x80);
+    }
+#endif
+    return cut;
+
+slow:
+    bytes = Tk_MeasureChars(fh->tkfont, str, (int)len, max_pixels, 0, &width);
+    if (bytes >= len) return -1;
+    if (max_pixels - ell_w < 0) return 0;
+    return Tk_MeasureChars(fh->tkfont, str, (int)len, max_pixels - ell_w, 0, &width);
+}
+
+/* ---------------------------------------------------------
+ * Interp#fit_text(font, strings, max_pixels, opts={})
+ *
+ * Truncate many strings to a pixel width in one call, appending an
+ * ellipsis to those that had to be cut.
+ *
+ * Arguments:
+ *   font       - Font description string or a Teek::FontHandle. A
+ *                description goes through Interp#font_handle, so its
+ *                glyph width cache carries over between calls (and
+ *                is rebuilt if the font is reconfigured).
+ *   strings    - Array of UTF-8 Strings
+ *   max_pixels - Width to fit each string into
+ *   opts       - Optional hash:
+ *                :ellipsis - String appended to cut strings
+ *                            (default "..."; "" to just clip)
+ *
+ * Returns Array of Strings in the same order: the original object when
+ * it already fits, otherwise the longest prefix (whole characters) that
+ * fits together with the ellipsis, plus the ellipsis. A string becomes
+ * "" if not even the ellipsis fits.
+ *
+ * See: https://www.tcl-lang.org/man/tcl9.0/TkLib/MeasureChar.html
+ * --------------------------------------------------------- */
+
+static VALUE
+interp_fit_text(int argc, VALUE *argv, VALUE self)
+{
+    VALUE font, strings, max_val, opts, ellipsis, result, handle;
+    struct font_handle *fh;
+    int max_pixels, ell_w;
+    long i, n;
+
+    rb_scan_args(argc, argv, "31", &font, &strings, &max_val, &opts);
+
+    Check_Type(strings, T_ARRAY);
+    max_pixels = NUM2INT(max_val);
+    if (max_pixels < 0) {
+        /* Tk_MeasureChars reads a negative limit as "unlimited" */
+        rb_raise(rb_eArgError, "max_pixels must be non-negative");
+    }
+
+    ellipsis = Qnil;
+    if (!NIL_P(opts) && TYPE(opts) == T_HASH) {
+        ellipsis = rb_hash_aref(opts, ID2SYM(rb_intern("ellipsis")));
+    }
+    ellipsis = NIL_P(ellipsis) ? rb_str_new_cstr("...") : rb_str_dup(StringValue(ellipsis));
+    rb_enc_associate(ellipsis, rb_utf8_encoding());
+
+    n = RARRAY_LEN(strings);
+    for (i = 0; i < n; i++) {
+        Check_Type(RARRAY_AREF(strings, i), T_STRING);
+    }
+
+    handle = rb_typeddata_is_kind_of(font, &fh_type) ? font : interp_font_handle(self, font);
+    fh = get_fh(handle);
+    if (fh->interp != self) {
+        rb_raise(rb_eArgError, "font handle belongs to another interpreter");
+    }
+    glyph_cache_check(fh);
+
+    ell_w = Tk_TextWidth(fh->tkfont, RSTRING_PTR(ellipsis), (int)RSTRING_LEN(ellipsis));
+
+    result = rb_ary_new_capa(n);
+    for (i = 0; i < n; i++) {
+        VALUE str = RARRAY_AREF(strings, i);
+        long cut = fit_one(fh, RSTRING_PTR(str), RSTRING_LEN(str), max_pixels, ell_w);
+        if (cut < 0) {
+            rb_ary_push(result, str);
+        } else if (ell_w > max_pixels) {
+            rb_ary_push(result, rb_utf8_str_new("", 0));
+        } else {
+            VALUE out = rb_utf8_str_new(RSTRING_PTR(str), cut);
+            rb_str_buf_append(out, ellipsis);
+            rb_ary_push(result, out);
+        }
+    }
+
+    RB_GC_GUARD(handle);
+    return result;
+}
+
 /* ---------------------------------------------------------
  * Init_tkfont - Register font methods on Teek::Interp class
  *
@@ -212,7 +635,22 @@ interp_measure_chars(int argc, VALUE *argv, VALUE self)
 void
 Init_tkfont(VALUE cInterp)
 {
+    VALUE mTeek = rb_define_module("Teek");
+
+    /* No leading @ - hidden from Ruby-level instance_variables */
+    id_font_handles = rb_intern("font_handles");
+
     rb_define_method(cInterp, "text_width", interp_text_width, 2);
+    rb_define_method(cInterp, "text_widths", interp_text_widths, 2);
     rb_define_method(cInterp, "font_metrics", interp_font_metrics, 1);
     rb_define_method(cInterp, "measure_chars", interp_measure_chars, -1);
+    rb_define_method(cInterp, "font_handle", interp_font_handle, 1);
+    rb_define_method(cInterp, "fit_text", interp_fit_text, -1);
+
+    cFontHandle = rb_define_class_under(mTeek, "FontHandle", rb_cObject);
+    rb_undef_alloc_func(cFontHandle);
+    rb_define_method(cFontHandle, "name", fh_name, 0);
+    rb_define_method(cFontHandle, "interp", fh_interp, 0);
+    rb_define_method(cFontHandle, "released?", fh_released_p, 0);
+    rb_define_method(cFontHandle, "release", fh_release, 0);
 }
@@ -0,0 +1,588 @@
+/* tkframebuffer.c - Persistent RGBA framebuffer with dirty-rect flushing
+ *
+ * Teek::PhotoFramebuffer owns a width*height*4 RGBA buffer in C memory
+ * and remembers which regions were written since the last flush. #flush
+ * pushes only those regions to the target photo, one Tk_PhotoPutBlock
+ * per dirty rectangle, using the block's pitch to address a sub-region
+ * of the full buffer in place (no repacking, no Ruby String per flush).
+ *
+ * Paint-style apps that touch a handful of pixels per event no longer
+ * have to materialize and push a whole bounding box themselves.
+ */
+
+#include "tcltkbridge.h"
+#include <string.h>
+
+static VALUE cPhotoFramebuffer;
+
+/* Dirty rects beyond this count are merged into their nearest neighbor.
+ * Each flushed rect is one Tk_PhotoPutBlock call, so a small cap keeps
+ * flush cost bounded even when writes are scattered. */
+#define FB_MAX_DIRTY 8
+
+/* Two rects are merged when their union wastes fewer than this many
+ * pixels - cheaper to push a few clean pixels than to make another
+ * Tk_PhotoPutBlock call (each one recomputes Tk's dither/alpha state). */
+#define FB_MERGE_SLACK 1024
+
+/* Half-open rectangle: [x0, x1) x [y0, y1) */
+struct fb_rect {
+    int x0, y0, x1, y1;
+};
+
+struct photo_framebuffer {
+    VALUE interp;              /* Teek::Interp (GC-marked) */
+    VALUE photo_path;          /* Frozen String (GC-marked) */
+    unsigned char *pixels;     /* RGBA, width * height * 4 bytes */
+    int width;
+    int height;
+    struct fb_rect dirty[FB_MAX_DIRTY];
+    int ndirty;
+};
+
+/* ---------------------------------------------------------
+ * TypedData functions
+ * --------------------------------------------------------- */
+
+static void
+fb_mark(void *ptr)
+{
+    struct photo_framebuffer *fb = ptr;
+    rb_gc_mark(fb->interp);
+    rb_gc_mark(fb->photo_path);
+}
+
+static void
+fb_free(void *ptr)
+{
+    struct photo_framebuffer *fb = ptr;
+    xfree(fb->pixels);
+    xfree(fb);
+}
+
+static size_t
+fb_memsize(const void *ptr)
+{
+    const struct photo_framebuffer *fb = ptr;
+    return sizeof(struct photo_framebuffer) + (size_t)fb->width * fb->height * 4;
+}
+
+static const rb_data_type_t fb_type = {
+    .wrap_struct_name = "Teek::PhotoFramebuffer",
+    .function = {
+        .dmark = fb_mark,
+        .dfree = fb_free,
+        .dsize = fb_memsize,
+    },
+    .flags = RUBY_TYPED_FREE_IMMEDIATELY,
+};
+
+static VALUE
+fb_alloc(VALUE klass)
+{
+    struct photo_framebuffer *fb;
+    VALUE obj = TypedData_Make_Struct(klass, struct photo_framebuffer, &fb_type, fb);
+    fb->interp = Qnil;
+    fb->photo_path = Qnil;
+    fb->pixels = NULL;
+    fb->width = 0;
+    fb->height = 0;
+    fb->ndirty = 0;
+    return obj;
+}
+
+static struct photo_framebuffer *
+get_fb(VALUE self)
+{
+    struct photo_framebuffer *fb;
+    TypedData_Get_Struct(self, struct photo_framebuffer, &fb_type, fb);
+    if (!fb->pixels) {
+        rb_raise(rb_eRuntimeError, "framebuffer not initialized");
+    }
+    return fb;
+}
+
+/* ---------------------------------------------------------
+ * Dirty rectangle bookkeeping
+ * --------------------------------------------------------- */
+
+static long
+rect_area(const struct fb_rect *r)
+{
+    return (long)(r->x1 - r->x0) * (r->y1 - r->y0);
+}
+
+static struct fb_rect
+rect_union(const struct fb_rect *a, const struct fb_rect *b)
+{
+    struct fb_rect u;
+    u.x0 = a->x0 < b->x0 ? a->x0 : b->x0;
+    u.y0 = a->y0 < b->y0 ? a->y0 : b->y0;
+    u.x1 = a->x1 > b->x1 ? a->x1 : b->x1;
+    u.y1 = a->y1 > b->y1 ? a->y1 : b->y1;
+    return u;
+}
+
+/* Pixels a union would cover that neither input does (overlap counted
+ * once, so overlapping rects always report <= 0 waste). */
+static long
+union_waste(const struct fb_rect *a, const struct fb_rect *b)
+{
+    struct fb_rect u = rect_union(a, b);
+    return rect_area(&u) - rect_area(a) - rect_area(b);
+}
+
+static void
+fb_mark_dirty(struct photo_framebuffer *fb, int x0, int y0, int x1, int y1)
+{
+    struct fb_rect r = { x0, y0, x1, y1 };
+    int i, merged;
+
+    if (x0 >= x1 || y0 >= y1) return;
+
+    /* Fast path for per-pixel strokes: already covered */
+    for (i = 0; i < fb->ndirty; i++) {
+        struct fb_rect *d = &fb->dirty[i];
+        if (x0 >= d->x0 && y0 >= d->y0 && x1 <= d->x1 && y1 <= d->y1) return;
+    }
+
+    /* Fold into any rect that's cheap to grow, then keep folding the grown
+     * rect into others - a merge can make two previously distant rects
+     * neighbors. */
+    do {
+        merged = 0;
+        for (i = 0; i < fb->ndirty; i++) {
+            if (union_waste(&r, &fb->dirty[i]) <= FB_MERGE_SLACK) {
+                r = rect_union(&r, &fb->dirty[i]);
+                fb->dirty[i] = fb->dirty[--fb->ndirty];
+                merged = 1;
+                break;
+            }
+        }
+    } while (merged);
+
+    if (fb->ndirty < FB_MAX_DIRTY) {
+        fb->dirty[fb->ndirty++] = r;
+        return;
+    }
+
+    /* Full: merge into whichever rect grows the least */
+    {
+        int best = 0;
+        long best_waste = union_waste(&r, &fb->dirty[0]);
+        for (i = 1; i < fb->ndirty; i++) {
+            long w = union_waste(&r, &fb->dirty[i]);
+            if (w < best_waste) {
+                best = i;
+                best_waste = w;
+            }
+        }
+        fb->dirty[best] = rect_union(&r, &fb->dirty[best]);
+    }
+}
+
+/* Clip x/y/w/h to the buffer. Returns 0 if nothing is left. */
+static int
+fb_clip(const struct photo_framebuffer *fb, int *x, int *y, int *w, int *h)
+{
+    int x0 = *x, y0 = *y, x1 = *x + *w, y1 = *y + *h;
+
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > fb->width) x1 = fb->width;
+    if (y1 > fb->height) y1 = fb->height;
+    if (x0 >= x1 || y0 >= y1) return 0;
+
+    *x = x0;
+    *y = y0;
+    *w = x1 - x0;
+    *h = y1 - y0;
+    return 1;
+}
+
+static int
+channel_value(VALUE v)
+{
+    int c = NUM2INT(v);
+    if (c < 0 || c > 255) {
+        rb_raise(rb_eArgError, "color channel out of range 0..255: %d", c);
+    }
+    return c;
+}
+
+/* ---------------------------------------------------------
+ * PhotoFramebuffer#initialize(interp, photo_path, width, height)
+ *
+ * Allocates a zeroed (fully transparent) RGBA buffer. Nothing is dirty
+ * yet - call #reload first to start from the photo's current contents,
+ * or #clear to push the transparent buffer on the next flush.
+ * --------------------------------------------------------- */
+
+static VALUE
+fb_initialize(VALUE self, VALUE interp, VALUE photo_path, VALUE width_val, VALUE height_val)
+{
+    struct photo_framebuffer *fb;
+    int width, height;
+
+    TypedData_Get_Struct(self, struct photo_framebuffer, &fb_type, fb);
+
+    /* Validates the interp argument's type (raises TypeError otherwise) */
+    get_interp(interp);
+    StringValue(photo_path);
+    width = NUM2INT(width_val);
+    height = NUM2INT(height_val);
+
+    if (width <= 0 || height <= 0) {
+        rb_raise(rb_eArgError, "width and height must be positive");
+    }
+
+    xfree(fb->pixels);
+    fb->pixels = ZALLOC_N(unsigned char, (size_t)width * height * 4);
+    fb->width = width;
+    fb->height = height;
+    fb->ndirty = 0;
+    RB_OBJ_WRITE(self, &fb->interp, interp);
+    RB_OBJ_WRITE(self, &fb->photo_path, rb_str_new_frozen(photo_path));
+
+    return self;
+}
+
+static VALUE
+fb_width(VALUE self)
+{
+    return INT2NUM(get_fb(self)->width);
+}
+
+static VALUE
+fb_height(VALUE self)
+{
+    return INT2NUM(get_fb(self)->height);
+}
+
+static VALUE
+fb_photo_path(VALUE self)
+{
+    return get_fb(self)->photo_path;
+}
+
+/* ---------------------------------------------------------
+ * PhotoFramebuffer#set_pixel(x, y, r, g, b, a = 255)
+ *
+ * Writes one pixel. Coordinates outside the buffer are ignored, so
+ * brush strokes can run off the edge without bounds checks in Ruby.
+ * --------------------------------------------------------- */
+
+static VALUE
+fb_set_pixel(int argc, VALUE *argv, VALUE self)
+{
+    struct photo_framebuffer *fb = get_fb(self);
+    VALUE x_val, y_val, r_val, g_val, b_val, a_val;
+    unsigned char *p;
+    int x, y;
+
+    rb_scan_args(argc, argv, "51", &x_val, &y_val, &r_val, &g_val, &b_val, &a_val);
+
+    x = NUM2INT(x_val);
+    y = NUM2INT(y_val);
+    if (x < 0 || x >= fb->width || y < 0 || y >= fb->height) {
+        return self;
+    }
+
+    p = fb->pixels + ((size_t)y * fb->width + x) * 4;
+    p[0] = (unsigned char)channel_value(r_val);
+    p[1] = (unsigned char)channel_value(g_val);
+    p[2] = (unsigned char)channel_value(b_val);
+    p[3] = NIL_P(a_val) ? 255 : (unsigned char)channel_value(a_val);
+
+    fb_mark_dirty(fb, x, y, x + 1, y + 1);
+    return self;
+}
+
+/* ---------------------------------------------------------
+ * PhotoFramebuffer#get_pixel(x, y) -> [r, g, b, a]
+ *
+ * Reads from the C buffer, not the photo - unflushed writes are visible.
+ * --------------------------------------------------------- */
+
+static VALUE
+fb_get_pixel(VALUE self, VALUE x_val, VALUE y_val)
+{
+    struct photo_framebuffer *fb = get_fb(self);
+    const unsigned char *p;
+    int x = NUM2INT(x_val);
+    int y = NUM2INT(y_val);
+
+    if (x < 0 || x >= fb->width || y < 0 || y >= fb->height) {
+        rb_raise(rb_eArgError, "coordinates (%d, %d) outside framebuffer bounds (%d x %d)",
+                 x, y, fb->width, fb->height);
+    }
+
+    p = fb->pixels + ((size_t)y * fb->width + x) * 4;
+    return rb_ary_new_from_args(4,
+        INT2FIX(p[0]), INT2FIX(p[1]), INT2FIX(p[2]), INT2FIX(p[3]));
+}
+
+/* ---------------------------------------------------------
+ * PhotoFramebuffer#fill_rect(x, y, width, height, r, g, b, a = 255)
+ *
+ * Fills a rectangle with one color, clipped to the buffer.
+ * --------------------------------------------------------- */
+
+static VALUE
+fb_fill_rect(int argc, VALUE *argv, VALUE self)
+{
+    struct photo_framebuffer *fb = get_fb(self);
+    VALUE x_val, y_val, w_val, h_val, r_val, g_val, b_val, a_val;
+    unsigned char px[4];
+    int x, y, w, h, row, col;
+
+    rb_scan_args(argc, argv, "71", &x_val, &y_val, &w_val, &h_val,
+                 &r_val, &g_val, &b_val, &a_val);
+
+    x = NUM2INT(x_val);
+    y = NUM2INT(y_val);
+    w = NUM2INT(w_val);
+    h = NUM2INT(h_val);
+    px[0] = (unsigned char)channel_value(r_val);
+    px[1] = (unsigned char)channel_value(g_val);
+    px[2] = (unsigned char)channel_value(b_val);
+    px[3] = NIL_P(a_val) ? 255 : (unsigned char)channel_value(a_val);
+
+    if (!fb_clip(fb, &x, &y, &w, &h)) return self;
+
+    /* Fill the first row pixel by pixel, then memcpy it down */
+    {
+        unsigned char *first = fb->pixels + ((size_t)y * fb->width + x) * 4;
+        for (col = 0; col < w; col++) {
+            memcpy(first + col * 4, px, 4);
+        }
+        for (row = 1; row < h; row++) {
+            memcpy(first + (size_t)row * fb->width * 4, first, (size_t)w * 4);
+        }
+    }
+
+    fb_mark_dirty(fb, x, y, x + w, y + h);
+    return self;
+}
+
+/* ---------------------------------------------------------
+ * PhotoFramebuffer#blit(pixel_data, x, y, width, height)
+ *
+ * Copies a packed RGBA block (width * height * 4 bytes, same layout as
+ * Photo#put_block) into the buffer at x/y, clipped to the buffer.
+ * --------------------------------------------------------- */
+
+static VALUE
+fb_blit(VALUE self, VALUE pixel_data, VALUE x_val, VALUE y_val, VALUE w_val, VALUE h_val)
+{
+    struct photo_framebuffer *fb = get_fb(self);
+    const unsigned char *src;
+    int x, y, w, h, cx, cy, cw, ch, row;
+    long expected_size;
+
+    StringValue(pixel_data);
+    x = NUM2INT(x_val);
+    y = NUM2INT(y_val);
+    w = NUM2INT(w_val);
+    h = NUM2INT(h_val);
+
+    if (w <= 0 || h <= 0) {
+        rb_raise(rb_eArgError, "width and height must be positive");
+    }
+
+    expected_size = (long)w * h * 4;
+    if (RSTRING_LEN(pixel_data) != expected_size) {
+        rb_raise(rb_eArgError, "pixel_data size mismatch: expected %ld bytes, got %ld",
+                 expected_size, RSTRING_LEN(pixel_data));
+    }
+
+    cx = x; cy = y; cw = w; ch = h;
+    if (!fb_clip(fb, &cx, &cy, &cw, &ch)) return self;
+
+    src = (const unsigned char *)RSTRING_PTR(pixel_data)
+          + ((size_t)(cy - y) * w + (cx - x)) * 4;
+    for (row = 0; row < ch; row++) {
+        memcpy(fb->pixels + ((size_t)(cy + row) * fb->width + cx) * 4,
+               src + (size_t)row * w * 4,
+               (size_t)cw * 4);
+    }
+
+    fb_mark_dirty(fb, cx, cy, cx + cw, cy + ch);
+    return self;
+}
+
+/* ---------------------------------------------------------
+ * PhotoFramebuffer#clear
+ *
+ * Zeroes the buffer (fully transparent) and marks all of it dirty.
+ * --------------------------------------------------------- */
+
+static VALUE
+fb_clear(VALUE self)
+{
+    struct photo_framebuffer *fb = get_fb(self);
+
+    memset(fb->pixels, 0, (size_t)fb->width * fb->height * 4);
+    fb->ndirty = 0;
+    fb_mark_dirty(fb, 0, 0, fb->width, fb->height);
+    return self;
+}
+
+/* ---------------------------------------------------------
+ * PhotoFramebuffer#dirty? / #dirty_rects
+ *
+ * dirty_rects returns [[x, y, width, height], ...] - the regions the
+ * next #flush will push, after merging.
+ * --------------------------------------------------------- */
+
+static VALUE
+fb_dirty_p(VALUE self)
+{
+    return get_fb(self)->ndirty > 0 ? Qtrue : Qfalse;
+}
+
+static VALUE
+fb_dirty_rects(VALUE self)
+{
+    struct photo_framebuffer *fb = get_fb(self);
+    VALUE ary = rb_ary_new_capa(fb->ndirty);
+    int i;
+
+    for (i = 0; i < fb->ndirty; i++) {
+        struct fb_rect *r = &fb->dirty[i];
+        rb_ary_push(ary, rb_ary_new_from_args(4,
+            INT2NUM(r->x0), INT2NUM(r->y0),
+            INT2NUM(r->x1 - r->x0), INT2NUM(r->y1 - r->y0)));
+    }
+    return ary;
+}
+
+/* ---------------------------------------------------------
+ * PhotoFramebuffer#flush -> Integer
+ *
+ * Pushes each dirty rectangle to the photo with Tk_PhotoPutBlock and
+ * clears the dirty list. block.pixelPtr points straight into the
+ * framebuffer and block.pitch is the full buffer row, so Tk reads the
+ * sub-region in place.
+ *
+ * Returns the number of Tk_PhotoPutBlock calls made (0 if clean).
+ * --------------------------------------------------------- */
+
+static VALUE
+fb_flush(VALUE self)
+{
+    struct photo_framebuffer *fb = get_fb(self);
+    struct tcltk_interp *tip;
+    Tk_PhotoHandle photo;
+    Tk_PhotoImageBlock block;
+    int i, count;
+
+    if (fb->ndirty == 0) return INT2FIX(0);
+
+    tip = get_interp(fb->interp);
+    photo = Tk_FindPhoto(tip->interp, RSTRING_PTR(fb->photo_path));
+    if (!photo) {
+        rb_raise(eTclError, "photo image not found: %s", RSTRING_PTR(fb->photo_path));
+    }
+
+    block.pitch = fb->width * 4;
+    block.pixelSize = 4;
+    block.offset[0] = 0;
+    block.offset[1] = 1;
+    block.offset[2] = 2;
+    block.offset[3] = 3;
+
+    count = fb->ndirty;
+    for (i = 0; i < count; i++) {
+        struct fb_rect *r = &fb->dirty[i];
+
+        block.pixelPtr = fb->pixels + ((size_t)r->y0 * fb->width + r->x0) * 4;
+        block.width = r->x1 - r->x0;
+        block.height = r->y1 - r->y0;
+
+        if (Tk_PhotoPutBlock(tip->interp, photo, &block, r->x0, r->y0,
+                             block.width, block.height,
+                             TK_PHOTO_COMPOSITE_SET) != TCL_OK) {
+            /* Keep the rects not yet pushed so a retry can finish the job */
+            memmove(fb->dirty, fb->dirty + i, (count - i) * sizeof(struct fb_rect));
+            fb->ndirty = count - i;
+            rb_raise(eTclError, "Tk_PhotoPutBlock failed: %s",
+                     Tcl_GetStringResult(tip->interp));
+        }
+    }
+
+    fb->ndirty = 0;
+    return INT2FIX(count);
+}
+
+/* ---------------------------------------------------------
+ * PhotoFramebuffer#reload
+ *
+ * Copies the photo's current pixels into the buffer (the overlapping
+ * region; anything outside the photo is left as-is) and clears the
+ * dirty list, so the framebuffer starts in sync with what's on screen.
+ * --------------------------------------------------------- */
+
+static VALUE
+fb_reload(VALUE self)
+{
+    struct photo_framebuffer *fb = get_fb(self);
+    struct tcltk_interp *tip = get_interp(fb->interp);
+    Tk_PhotoHandle photo;
+    Tk_PhotoImageBlock block;
+    int w, h, x, y;
+
+    photo = Tk_FindPhoto(tip->interp, RSTRING_PTR(fb->photo_path));
+    if (!photo) {
+        rb_raise(eTclError, "photo image not found: %s", RSTRING_PTR(fb->photo_path));
+    }
+
+    if (!Tk_PhotoGetImage(photo, &block)) {
+        rb_raise(eTclError, "failed to get photo image data");
+    }
+
+    w = block.width < fb->width ? block.width : fb->width;
+    h = block.height < fb->height ? block.height : fb->height;
+
+    for (y = 0; y < h; y++) {
+        const unsigned char *src = block.pixelPtr + (size_t)y * block.pitch;
+        unsigned char *dst = fb->pixels + (size_t)y * fb->width * 4;
+        for (x = 0; x < w; x++) {
+            *dst++ = src[block.offset[0]];
+            *dst++ = src[block.offset[1]];
+            *dst++ = src[block.offset[2]];
+            *dst++ = (block.pixelSize >= 4) ? src[block.offset[3]] : 255;
+            src += block.pixelSize;
+        }
+    }
+
+    fb->ndirty = 0;
+    return self;
+}
+
+/* ---------------------------------------------------------
+ * Init_tkframebuffer - Register Teek::PhotoFramebuffer
+ *
+ * Called from Init_tcltklib in tcltkbridge.c
+ * --------------------------------------------------------- */
+
+void
+Init_tkframebuffer(VALUE mTeek)
+{
+    cPhotoFramebuffer = rb_define_class_under(mTeek, "PhotoFramebuffer", rb_cObject);
+    rb_define_alloc_func(cPhotoFramebuffer, fb_alloc);
+
+    rb_define_method(cPhotoFramebuffer, "initialize", fb_initialize, 4);
+    rb_define_method(cPhotoFramebuffer, "width", fb_width, 0);
+    rb_define_method(cPhotoFramebuffer, "height", fb_height, 0);
+    rb_define_method(cPhotoFramebuffer, "photo_path", fb_photo_path, 0);
+    rb_define_method(cPhotoFramebuffer, "set_pixel", fb_set_pixel, -1);
+    rb_define_method(cPhotoFramebuffer, "get_pixel", fb_get_pixel, 2);
+    rb_define_method(cPhotoFramebuffer, "fill_rect", fb_fill_rect, -1);
+    rb_define_method(cPhotoFramebuffer, "blit", fb_blit, 5);
+    rb_define_method(cPhotoFramebuffer, "clear", fb_clear, 0);
+    rb_define_method(cPhotoFramebuffer, "dirty?", fb_dirty_p, 0);
+    rb_define_method(cPhotoFramebuffer, "dirty_rects", fb_dirty_rects, 0);
+    rb_define_method(cPhotoFramebuffer, "flush", fb_flush, 0);
+    rb_define_method(cPhotoFramebuffer, "reload", fb_reload, 0);
+}
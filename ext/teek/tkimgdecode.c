@@ -0,0 +1,754 @@
+/* tkimgdecode.c - PNG/PPM decoding without the GVL
+ *
+ * Tk's own image format handlers run on the main thread inside
+ * `image create photo -file ...`, so a screen full of large PNGs
+ * freezes input while they decode. This decodes PNG and PPM/PGM
+ * straight to packed RGBA with the GVL released, so a Ruby worker
+ * thread can do it while the main thread keeps servicing events;
+ * Photo.decode_async then hands the result to Tk with one
+ * Tk_PhotoPutBlock (see lib/teek/photo.rb).
+ *
+ * Nothing here touches Tcl/Tk - it's plain C on byte buffers and is
+ * safe to run on any thread.
+ */
+
+#include "tcltkbridge.h"
+#include <ruby/thread.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif
+
+/* Decoded images are returned as Ruby Strings, so cap the RGBA size
+ * well inside a long and inside what Tk will accept for a photo. */
+#define DECODE_MAX_BYTES ((uint64_t)1 << 30)
+
+struct decode_job {
+    /* Input: either a path to read, or bytes already copied out of Ruby */
+    char *path;
+    unsigned char *input;
+    size_t input_len;
+
+    /* Output */
+    unsigned char *rgba;
+    int width;
+    int height;
+
+    /* Failure reporting - filled in without the GVL, raised after */
+    int sys_errno;
+    char error[160];
+
+    volatile int interrupted;
+};
+
+static void
+decode_fail(struct decode_job *job, const char *msg)
+{
+    if (!job->error[0]) {
+        snprintf(job->error, sizeof(job->error), "%s", msg);
+    }
+}
+
+/* Allocate the RGBA output, checking the size first */
+static int
+decode_alloc_output(struct decode_job *job, uint32_t width, uint32_t height)
+{
+    uint64_t bytes = (uint64_t)width * height * 4;
+
+    if (width == 0 || height == 0) {
+        decode_fail(job, "image has zero width or height");
+        return 0;
+    }
+    if (width > INT32_MAX || height > INT32_MAX || bytes > DECODE_MAX_BYTES) {
+        decode_fail(job, "image too large");
+        return 0;
+    }
+    job->rgba = malloc((size_t)bytes);
+    if (!job->rgba) {
+        decode_fail(job, "out of memory");
+        return 0;
+    }
+    job->width = (int)width;
+    job->height = (int)height;
+    return 1;
+}
+
+/* ---------------------------------------------------------
+ * PPM / PGM (P2, P3, P5, P6)
+ * --------------------------------------------------------- */
+
+struct pnm_reader {
+    const unsigned char *p;
+    const unsigned char *end;
+};
+
+static void
+pnm_skip_space(struct pnm_reader *r)
+{
+    while (r->p < r->end) {
+        if (*r->p == '#') {
+            while (r->p < r->end && *r->p != '\n') r->p++;
+        } else if (*r->p == ' ' || *r->p == '\t' || *r->p == '\r' || *r->p == '\n') {
+            r->p++;
+        } else {
+            break;
+        }
+    }
+}
+
+static int
+pnm_read_uint(struct pnm_reader *r, uint32_t *out)
+{
+    uint64_t v = 0;
+    int digits = 0;
+
+    pnm_skip_space(r);
+    while (r->p < r->end && *r->p >= '0' && *r->p <= '9') {
+        v = v * 10 + (*r->p - '0');
+        if (v > UINT32_MAX) return 0;
+        r->p++;
+        digits++;
+    }
+    *out = (uint32_t)v;
+    return digits > 0;
+}
+
+static int
+decode_pnm(struct decode_job *job, const unsigned char *data, size_t len)
+{
+    struct pnm_reader r;
+    uint32_t width, height, maxval, v;
+    int kind, channels, binary, wide;
+    size_t i, npixels;
+    unsigned char *out;
+
+    kind = data[1] - '0';
+    channels = (kind == 3 || kind == 6) ? 3 : 1;
+    binary = (kind == 5 || kind == 6);
+
+    r.p = data + 2;
+    r.end = data + len;
+    if (!pnm_read_uint(&r, &width) || !pnm_read_uint(&r, &height) ||
+        !pnm_read_uint(&r, &maxval)) {
+        decode_fail(job, "invalid PPM header");
+        return 0;
+    }
+    if (maxval == 0 || maxval > 65535) {
+        decode_fail(job, "invalid PPM maxval");
+        return 0;
+    }
+    if (!decode_alloc_output(job, width, height)) return 0;
+
+    npixels = (size_t)width * height;
+    out = job->rgba;
+    wide = maxval > 255;
+
+    if (binary) {
+        size_t sample_bytes = wide ? 2 : 1;
+        /* Exactly one whitespace byte separates the header from the raster */
+        r.p++;
+        if (r.p > r.end || (size_t)(r.end - r.p) < npixels * channels * sample_bytes) {
+            decode_fail(job, "truncated PPM data");
+            return 0;
+        }
+    }
+
+    for (i = 0; i < npixels; i++) {
+        unsigned char px[3];
+        int c;
+
+        if ((i & 0xFFFF) == 0 && job->interrupted) {
+            decode_fail(job, "interrupted");
+            return 0;
+        }
+        for (c = 0; c < channels; c++) {
+            if (binary) {
+                if (wide) {
+                    v = ((uint32_t)r.p[0] << 8) | r.p[1];
+                    r.p += 2;
+                } else {
+                    v = *r.p++;
+                }
+            } else if (!pnm_read_uint(&r, &v)) {
+                decode_fail(job, "truncated PPM data");
+                return 0;
+            }
+            if (v > maxval) v = maxval;
+            px[c] = (maxval == 255) ? (unsigned char)v
+                                    : (unsigned char)((v * 255 + maxval / 2) / maxval);
+        }
+        out[0] = px[0];
+        out[1] = channels == 3 ? px[1] : px[0];
+        out[2] = channels == 3 ? px[2] : px[0];
+        out[3] = 255;
+        out += 4;
+    }
+    return 1;
+}
+
+/* ---------------------------------------------------------
+ * PNG
+ *
+ * All color types and bit depths, tRNS transparency and Adam7
+ * interlacing. 16-bit samples keep their high byte. Ancillary chunks
+ * (gamma, color profiles, text) are skipped, as Tk's own reader does.
+ * --------------------------------------------------------- */
+
+#ifdef HAVE_ZLIB_H
+
+struct png_info {
+    uint32_t width, height;
+    int depth;
+    int color_type;
+    int interlace;
+    int channels;
+    int bits_per_pixel;
+    unsigned char palette[256][4];
+    int palette_len;
+    int has_trns;
+    uint16_t trns_key[3];    /* gray or RGB key, raw sample values */
+};
+
+static uint32_t
+png_u32(const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static unsigned char
+paeth(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return (unsigned char)a;
+    if (pb <= pc) return (unsigned char)b;
+    return (unsigned char)c;
+}
+
+/* Undo one row's filter in place. prev is the previous unfiltered row
+ * of the same pass, or NULL for the first. */
+static int
+png_unfilter(unsigned char *row, const unsigned char *prev, size_t len, int bpp, int type)
+{
+    size_t i;
+
+    switch (type) {
+    case 0:
+        break;
+    case 1:
+        for (i = bpp; i < len; i++) row[i] += row[i - bpp];
+        break;
+    case 2:
+        if (prev) for (i = 0; i < len; i++) row[i] += prev[i];
+        break;
+    case 3:
+        for (i = 0; i < len; i++) {
+            int left = i >= (size_t)bpp ? row[i - bpp] : 0;
+            int up = prev ? prev[i] : 0;
+            row[i] += (unsigned char)((left + up) >> 1);
+        }
+        break;
+    case 4:
+        for (i = 0; i < len; i++) {
+            int left = i >= (size_t)bpp ? row[i - bpp] : 0;
+            int up = prev ? prev[i] : 0;
+            int up_left = (prev && i >= (size_t)bpp) ? prev[i - bpp] : 0;
+            row[i] += paeth(left, up, up_left);
+        }
+        break;
+    default:
+        return 0;
+    }
+    return 1;
+}
+
+/* Raw sample n of an unfiltered row (depth 1-16) */
+static inline uint32_t
+png_sample(const unsigned char *row, size_t n, int depth)
+{
+    switch (depth) {
+    case 16: return ((uint32_t)row[n * 2] << 8) | row[n * 2 + 1];
+    case 8:  return row[n];
+    default: {
+        size_t bit = n * depth;
+        int shift = 8 - depth - (int)(bit & 7);
+        return (row[bit >> 3] >> shift) & ((1u << depth) - 1);
+    }
+    }
+}
+
+static inline unsigned char
+png_scale(uint32_t v, int depth)
+{
+    switch (depth) {
+    case 16: return (unsigned char)(v >> 8);
+    case 8:  return (unsigned char)v;
+    case 4:  return (unsigned char)(v * 17);
+    case 2:  return (unsigned char)(v * 85);
+    default: return v ? 255 : 0;
+    }
+}
+
+/* Expand one unfiltered row of pw pixels to RGBA at out, stepping dx
+ * pixels between writes (1 unless interlaced). */
+static void
+png_emit_row(const struct png_info *info, const unsigned char *row, uint32_t pw,
+             unsigned char *out, int dx)
+{
+    uint32_t i;
+    int d = info->depth;
+    size_t step = (size_t)dx * 4;
+
+    for (i = 0; i < pw; i++, out += step) {
+        uint32_t r, g, b;
+        switch (info->color_type) {
+        case 0: /* gray */
+            r = png_sample(row, i, d);
+            out[0] = out[1] = out[2] = png_scale(r, d);
+            out[3] = (info->has_trns && r == info->trns_key[0]) ? 0 : 255;
+            break;
+        case 2: /* RGB */
+            r = png_sample(row, i * 3, d);
+            g = png_sample(row, i * 3 + 1, d);
+            b = png_sample(row, i * 3 + 2, d);
+            out[0] = png_scale(r, d);
+            out[1] = png_scale(g, d);
+            out[2] = png_scale(b, d);
+            out[3] = (info->has_trns && r == info->trns_key[0] &&
+                      g == info->trns_key[1] && b == info->trns_key[2]) ? 0 : 255;
+            break;
+        case 3: /* palette - indexes were bounds-checked against 256 entries */
+            memcpy(out, info->palette[png_sample(row, i, d)], 4);
+            break;
+        case 4: /* gray + alpha */
+            r = png_sample(row, i * 2, d);
+            out[0] = out[1] = out[2] = png_scale(r, d);
+            out[3] = png_scale(png_sample(row, i * 2 + 1, d), d);
+            break;
+        default: /* 6: RGBA */
+            out[0] = png_scale(png_sample(row, i * 4, d), d);
+            out[1] = png_scale(png_sample(row, i * 4 + 1, d), d);
+            out[2] = png_scale(png_sample(row, i * 4 + 2, d), d);
+            out[3] = png_scale(png_sample(row, i * 4 + 3, d), d);
+            break;
+        }
+    }
+}
+
+/* Adam7 pass origins and steps; pass 0 doubles as "not interlaced" */
+static const int adam7[7][4] = {
+    /* x0 y0 dx dy */
+    { 0, 0, 8, 8 },
+    { 4, 0, 8, 8 },
+    { 0, 4, 4, 8 },
+    { 2, 0, 4, 4 },
+    { 0, 2, 2, 4 },
+    { 1, 0, 2, 2 },
+    { 0, 1, 1, 2 },
+};
+
+static size_t
+png_row_bytes(const struct png_info *info, uint32_t pw)
+{
+    return ((size_t)pw * info->bits_per_pixel + 7) / 8;
+}
+
+static void
+png_pass_size(const struct png_info *info, int pass, uint32_t *pw, uint32_t *ph)
+{
+    if (!info->interlace) {
+        *pw = info->width;
+        *ph = info->height;
+        return;
+    }
+    *pw = info->width > (uint32_t)adam7[pass][0]
+        ? (info->width - adam7[pass][0] + adam7[pass][2] - 1) / adam7[pass][2] : 0;
+    *ph = info->height > (uint32_t)adam7[pass][1]
+        ? (info->height - adam7[pass][1] + adam7[pass][3] - 1) / adam7[pass][3] : 0;
+}
+
+static int
+png_parse_ihdr(struct decode_job *job, struct png_info *info, const unsigned char *p, uint32_t len)
+{
+    static const int channels_for[7] = { 1, 0, 3, 1, 2, 0, 4 };
+
+    if (len != 13) {
+        decode_fail(job, "invalid PNG header");
+        return 0;
+    }
+    info->width = png_u32(p);
+    info->height = png_u32(p + 4);
+    info->depth = p[8];
+    info->color_type = p[9];
+    info->interlace = p[12];
+
+    if (info->color_type > 6 || channels_for[info->color_type] == 0 ||
+        p[10] != 0 || p[11] != 0 || info->interlace > 1) {
+        decode_fail(job, "unsupported PNG color type or method");
+        return 0;
+    }
+    switch (info->depth) {
+    case 1: case 2: case 4:
+        if (info->color_type != 0 && info->color_type != 3) info->depth = 0;
+        break;
+    case 8:
+        break;
+    case 16:
+        if (info->color_type == 3) info->depth = 0;
+        break;
+    default:
+        info->depth = 0;
+    }
+    if (info->depth == 0) {
+        decode_fail(job, "unsupported PNG bit depth");
+        return 0;
+    }
+    info->channels = channels_for[info->color_type];
+    info->bits_per_pixel = info->channels * info->depth;
+    return 1;
+}
+
+static int
+decode_png(struct decode_job *job, const unsigned char *data, size_t len)
+{
+    struct png_info info;
+    const unsigned char *p = data + 8;
+    const unsigned char *end = data + len;
+    unsigned char *idat = NULL, *raw = NULL;
+    size_t idat_len = 0, idat_cap = 0, raw_len = 0, off;
+    int seen_ihdr = 0, seen_iend = 0, pass, npasses, ok = 0, i;
+    z_stream zs;
+
+    memset(&info, 0, sizeof(info));
+    /* Palette entries the file doesn't define decode as opaque black */
+    for (i = 0; i < 256; i++) info.palette[i][3] = 255;
+
+    while (!seen_iend) {
+        uint32_t clen;
+        const unsigned char *type, *cdata;
+
+        if ((size_t)(end - p) < 12) {
+            decode_fail(job, "truncated PNG data");
+            goto done;
+        }
+        clen = png_u32(p);
+        type = p + 4;
+        cdata = p + 8;
+        if (clen > (size_t)(end - cdata) - 4) {
+            decode_fail(job, "truncated PNG chunk");
+            goto done;
+        }
+
+        if (memcmp(type, "IHDR", 4) == 0) {
+            if (!png_parse_ihdr(job, &info, cdata, clen)) goto done;
+            seen_ihdr = 1;
+        } else if (!seen_ihdr) {
+            decode_fail(job, "PNG missing IHDR");
+            goto done;
+        } else if (memcmp(type, "PLTE", 4) == 0) {
+            uint32_t n = clen / 3, k;
+            if (n > 256 || clen % 3) {
+                decode_fail(job, "invalid PNG palette");
+                goto done;
+            }
+            for (k = 0; k < n; k++) {
+                info.palette[k][0] = cdata[k * 3];
+                info.palette[k][1] = cdata[k * 3 + 1];
+                info.palette[k][2] = cdata[k * 3 + 2];
+            }
+            info.palette_len = (int)n;
+        } else if (memcmp(type, "tRNS", 4) == 0) {
+            if (info.color_type == 3) {
+                uint32_t k;
+                for (k = 0; k < clen && k < 256; k++) info.palette[k][3] = cdata[k];
+            } else if (info.color_type == 0 && clen >= 2) {
+                info.trns_key[0] = (uint16_t)((cdata[0] << 8) | cdata[1]);
+                info.has_trns = 1;
+            } else if (info.color_type == 2 && clen >= 6) {
+                info.trns_key[0] = (uint16_t)((cdata[0] << 8) | cdata[1]);
+                info.trns_key[1] = (uint16_t)((cdata[2] << 8) | cdata[3]);
+                info.trns_key[2] = (uint16_t)((cdata[4] << 8) | cdata[5]);
+                info.has_trns = 1;
+            }
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            if (idat_len + clen > idat_cap) {
+                size_t cap = idat_cap ? idat_cap * 2 : 65536;
+                unsigned char *grown;
+                while (cap < idat_len + clen) cap *= 2;
+                grown = realloc(idat, cap);
+                if (!grown) {
+                    decode_fail(job, "out of memory");
+                    goto done;
+                }
+                idat = grown;
+                idat_cap = cap;
+            }
+            memcpy(idat + idat_len, cdata, clen);
+            idat_len += clen;
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            seen_iend = 1;
+        } else if (!(type[0] & 0x20)) {
+            /* Uppercase first letter: critical chunk we don't understand */
+            decode_fail(job, "unsupported critical PNG chunk");
+            goto done;
+        }
+        p = cdata + clen + 4; /* skip CRC */
+    }
+
+    if (!idat_len) {
+        decode_fail(job, "PNG has no image data");
+        goto done;
+    }
+    if (!decode_alloc_output(job, info.width, info.height)) goto done;
+
+    /* Inflated size: one filter byte plus packed samples per row, per pass */
+    npasses = info.interlace ? 7 : 1;
+    for (pass = 0; pass < npasses; pass++) {
+        uint32_t pw, ph;
+        png_pass_size(&info, pass, &pw, &ph);
+        if (pw && ph) raw_len += (png_row_bytes(&info, pw) + 1) * ph;
+    }
+    raw = malloc(raw_len);
+    if (!raw) {
+        decode_fail(job, "out of memory");
+        goto done;
+    }
+
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit(&zs) != Z_OK) {
+        decode_fail(job, "zlib init failed");
+        goto done;
+    }
+    zs.next_in = idat;
+    zs.avail_in = (uInt)idat_len;
+    zs.next_out = raw;
+    zs.avail_out = (uInt)raw_len;
+    {
+        int zr = inflate(&zs, Z_FINISH);
+        inflateEnd(&zs);
+        /* Trailing junk after the image rows is tolerated, short data isn't */
+        if ((zr != Z_STREAM_END && zr != Z_BUF_ERROR) || zs.avail_out != 0) {
+            decode_fail(job, "corrupt PNG image data");
+            goto done;
+        }
+    }
+
+    off = 0;
+    for (pass = 0; pass < npasses; pass++) {
+        uint32_t pw, ph, y;
+        size_t rb;
+        int bpp;
+        const unsigned char *prev = NULL;
+        int x0 = info.interlace ? adam7[pass][0] : 0;
+        int y0 = info.interlace ? adam7[pass][1] : 0;
+        int dx = info.interlace ? adam7[pass][2] : 1;
+        int dy = info.interlace ? adam7[pass][3] : 1;
+
+        png_pass_size(&info, pass, &pw, &ph);
+        if (!pw || !ph) continue;
+        rb = png_row_bytes(&info, pw);
+        bpp = (info.bits_per_pixel + 7) / 8;
+
+        for (y = 0; y < ph; y++) {
+            unsigned char *row = raw + off + 1;
+            unsigned char *out;
+
+            if (job->interrupted) {
+                decode_fail(job, "interrupted");
+                goto done;
+            }
+            if (!png_unfilter(row, prev, rb, bpp, raw[off])) {
+                decode_fail(job, "invalid PNG filter type");
+                goto done;
+            }
+            out = job->rgba + (((size_t)(y0 + y * dy) * info.width) + x0) * 4;
+            png_emit_row(&info, row, pw, out, dx);
+            prev = row;
+            off += rb + 1;
+        }
+    }
+    ok = 1;
+
+done:
+    free(idat);
+    free(raw);
+    return ok;
+}
+
+#endif /* HAVE_ZLIB_H */
+
+/* ---------------------------------------------------------
+ * Worker - runs without the GVL
+ * --------------------------------------------------------- */
+
+static int
+decode_read_file(struct decode_job *job)
+{
+    FILE *f = fopen(job->path, "rb");
+    size_t cap = 65536, len = 0, n;
+    unsigned char *buf;
+
+    if (!f) {
+        job->sys_errno = errno;
+        return 0;
+    }
+    buf = malloc(cap);
+    while (buf) {
+        if (len == cap) {
+            unsigned char *grown = realloc(buf, cap * 2);
+            if (!grown) {
+                free(buf);
+                buf = NULL;
+                break;
+            }
+            buf = grown;
+            cap *= 2;
+        }
+        n = fread(buf + len, 1, cap - len, f);
+        len += n;
+        if (n == 0) break;
+        if (job->interrupted) break;
+    }
+    if (!buf) {
+        decode_fail(job, "out of memory");
+    } else if (ferror(f)) {
+        job->sys_errno = errno ? errno : EIO;
+    } else if (job->interrupted) {
+        decode_fail(job, "interrupted");
+    }
+    fclose(f);
+
+    if (job->error[0] || job->sys_errno) {
+        free(buf);
+        return 0;
+    }
+    job->input = buf;
+    job->input_len = len;
+    return 1;
+}
+
+static void *
+decode_without_gvl(void *arg)
+{
+    struct decode_job *job = arg;
+    const unsigned char *d;
+    size_t len;
+
+    if (job->path && !decode_read_file(job)) return NULL;
+
+    d = job->input;
+    len = job->input_len;
+
+    if (len >= 8 && memcmp(d, "\x89PNG\r\n\x1a\n", 8) == 0) {
+#ifdef HAVE_ZLIB_H
+        decode_png(job, d, len);
+#else
+        decode_fail(job, "PNG support requires zlib, which was not found at build time");
+#endif
+    } else if (len >= 3 && d[0] == 'P' &&
+               (d[1] == '2' || d[1] == '3' || d[1] == '5' || d[1] == '6')) {
+        decode_pnm(job, d, len);
+    } else {
+        decode_fail(job, "unrecognized image format (expected PNG or PPM/PGM)");
+    }
+    return NULL;
+}
+
+static void
+decode_ubf(void *arg)
+{
+    struct decode_job *job = arg;
+    job->interrupted = 1;
+}
+
+/* Is this String image bytes rather than a path? */
+static int
+looks_like_image_data(VALUE str)
+{
+    const char *s = RSTRING_PTR(str);
+    long len = RSTRING_LEN(str);
+
+    if (len >= 8 && memcmp(s, "\x89PNG\r\n\x1a\n", 8) == 0) return 1;
+    if (len >= 3 && s[0] == 'P' && s[1] && strchr("2356", s[1]) &&
+        (s[2] == ' ' || s[2] == '\t' || s[2] == '\r' || s[2] == '\n' || s[2] == '#')) {
+        return 1;
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------
+ * Teek._decode_image(path_or_bytes) -> [width, height, rgba]
+ *
+ * Decode a PNG or PPM/PGM image to packed RGBA (4 bytes per pixel),
+ * releasing the GVL for the file read and the decode so other Ruby
+ * threads - in particular the Tk main thread - keep running.
+ *
+ * Arguments:
+ *   path_or_bytes - a String holding the encoded image (recognized by
+ *                   its PNG / PPM signature), or a file path
+ *
+ * Raises SystemCallError if the file can't be read, ArgumentError if
+ * the data isn't a valid PNG/PPM.
+ *
+ * Backs Photo.decode_async, which calls it from a worker thread.
+ * --------------------------------------------------------- */
+
+static VALUE
+teek_decode_image(VALUE self, VALUE source)
+{
+    struct decode_job job;
+    VALUE result;
+
+    StringValue(source);
+    memset(&job, 0, sizeof(job));
+
+    /* Copy the input out of Ruby: the String must not be read while
+     * another thread could modify or move it. */
+    if (looks_like_image_data(source)) {
+        job.input_len = (size_t)RSTRING_LEN(source);
+        job.input = malloc(job.input_len ? job.input_len : 1);
+        if (!job.input) rb_raise(rb_eNoMemError, "failed to allocate decode buffer");
+        memcpy(job.input, RSTRING_PTR(source), job.input_len);
+    } else {
+        const char *path = StringValueCStr(source);
+        job.path = strdup(path);
+        if (!job.path) rb_raise(rb_eNoMemError, "failed to allocate decode buffer");
+    }
+
+    rb_thread_call_without_gvl(decode_without_gvl, &job, decode_ubf, &job);
+
+    free(job.input);
+
+    if (job.sys_errno) {
+        VALUE path = rb_str_new_cstr(job.path);
+        free(job.path);
+        rb_syserr_fail_str(job.sys_errno, path);
+    }
+    if (job.error[0]) {
+        free(job.path);
+        free(job.rgba);
+        /* An interrupted decode is a pending Thread#kill/raise - let it win */
+        if (job.interrupted) rb_thread_check_ints();
+        rb_raise(rb_eArgError, "cannot decode image: %s", job.error);
+    }
+    free(job.path);
+
+    result = rb_ary_new_capa(3);
+    rb_ary_push(result, INT2NUM(job.width));
+    rb_ary_push(result, INT2NUM(job.height));
+    rb_ary_push(result, rb_str_new((const char *)job.rgba, (long)job.width * job.height * 4));
+    free(job.rgba);
+
+    return result;
+}
+
+void
+Init_tkimgdecode(VALUE mTeek)
+{
+    rb_define_module_function(mTeek, "_decode_image", teek_decode_image, 1);
+}
@@ -0,0 +1,449 @@
+/* tkmmap.c - Memory-mapped raw frame sources for photos
+ *
+ * Teek::MappedFile maps a file (or an already-open descriptor, e.g.
+ * POSIX shared memory) read-only and feeds sub-regions of it straight
+ * into Tk_PhotoPutBlock. The block points into the mapped pages, with
+ * the frame's stride as the block pitch, so a frame goes from the page
+ * cache to the photo without a Ruby String in between.
+ *
+ * The mapping is kept across calls. Each put re-checks the file size
+ * (and, for path-backed mappings, whether the path now names a
+ * different file, as with writers that rename a finished frame into
+ * place) and remaps only when one of those changed.
+ *
+ * As with any mmap, a writer that truncates the file below a frame
+ * while Tk is reading it makes the process take SIGBUS - writers
+ * should only ever grow or rewrite the file in place.
+ */
+
+#include "tcltkbridge.h"
+#include <ruby/io.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static VALUE cMappedFile;
+
+struct mapped_file {
+    VALUE source;              /* path String, IO or Integer (GC-marked) */
+    int fd;
+    int owns_fd;               /* opened from a path - close with us */
+    unsigned char *addr;       /* NULL when the file is empty or closed */
+    size_t len;
+#ifdef _WIN32
+    HANDLE mapping;
+#else
+    dev_t dev;
+    ino_t ino;
+#endif
+};
+
+/* ---------------------------------------------------------
+ * Mapping management
+ * --------------------------------------------------------- */
+
+static void
+mf_unmap(struct mapped_file *mf)
+{
+    if (!mf->addr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(mf->addr);
+    CloseHandle(mf->mapping);
+    mf->mapping = NULL;
+#else
+    munmap(mf->addr, mf->len);
+#endif
+    mf->addr = NULL;
+    mf->len = 0;
+}
+
+static void
+mf_close_fd(struct mapped_file *mf)
+{
+    if (mf->fd >= 0 && mf->owns_fd) close(mf->fd);
+    mf->fd = -1;
+    mf->owns_fd = 0;
+}
+
+/* Map the whole file. An empty file leaves addr NULL - nothing to map
+ * yet, and the next put will try again. Returns 0 or an errno value. */
+static int
+mf_map(struct mapped_file *mf, size_t len)
+{
+    if (len == 0) return 0;
+#ifdef _WIN32
+    {
+        HANDLE fh = (HANDLE)_get_osfhandle(mf->fd);
+        if (fh == INVALID_HANDLE_VALUE) return EBADF;
+        mf->mapping = CreateFileMapping(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mf->mapping) return EACCES;
+        mf->addr = MapViewOfFile(mf->mapping, FILE_MAP_READ, 0, 0, len);
+        if (!mf->addr) {
+            CloseHandle(mf->mapping);
+            mf->mapping = NULL;
+            return ENOMEM;
+        }
+    }
+#else
+    {
+        void *p = mmap(NULL, len, PROT_READ, MAP_SHARED, mf->fd, 0);
+        if (p == MAP_FAILED) return errno;
+        mf->addr = p;
+    }
+#endif
+    mf->len = len;
+    return 0;
+}
+
+static void
+mf_open_path(struct mapped_file *mf)
+{
+    const char *path = StringValueCStr(mf->source);
+    int fd = rb_cloexec_open(path, O_RDONLY
+#ifdef O_BINARY
+                             | O_BINARY
+#endif
+                             , 0);
+    if (fd < 0) rb_sys_fail(path);
+    rb_update_max_fd(fd);
+    mf->fd = fd;
+    mf->owns_fd = 1;
+}
+
+/* Bring the mapping up to date with the file: reopen a path that now
+ * names a different file, remap when the size changed. */
+static void
+mf_refresh(struct mapped_file *mf)
+{
+    struct stat st;
+    int err;
+
+    if (mf->fd < 0) {
+        rb_raise(rb_eIOError, "mapped file is closed");
+    }
+
+#ifndef _WIN32
+    if (mf->owns_fd) {
+        struct stat pst;
+        if (stat(RSTRING_PTR(mf->source), &pst) == 0 &&
+            (pst.st_dev != mf->dev || pst.st_ino != mf->ino)) {
+            mf_unmap(mf);
+            mf_close_fd(mf);
+            mf_open_path(mf);
+        }
+    }
+#endif
+
+    if (fstat(mf->fd, &st) != 0) {
+        rb_sys_fail("fstat");
+    }
+#ifndef _WIN32
+    mf->dev = st.st_dev;
+    mf->ino = st.st_ino;
+#endif
+
+    if (mf->addr && (size_t)st.st_size == mf->len) return;
+
+    mf_unmap(mf);
+    err = mf_map(mf, (size_t)st.st_size);
+    if (err) {
+        errno = err;
+        rb_sys_fail("mmap");
+    }
+}
+
+/* ---------------------------------------------------------
+ * TypedData functions
+ * --------------------------------------------------------- */
+
+static void
+mf_mark(void *ptr)
+{
+    struct mapped_file *mf = ptr;
+    rb_gc_mark(mf->source);
+}
+
+static void
+mf_free(void *ptr)
+{
+    struct mapped_file *mf = ptr;
+    mf_unmap(mf);
+    mf_close_fd(mf);
+    xfree(mf);
+}
+
+static size_t
+mf_memsize(const void *ptr)
+{
+    /* Mapped pages belong to the page cache, not the Ruby heap */
+    return sizeof(struct mapped_file);
+}
+
+static const rb_data_type_t mf_type = {
+    .wrap_struct_name = "Teek::MappedFile",
+    .function = {
+        .dmark = mf_mark,
+        .dfree = mf_free,
+        .dsize = mf_memsize,
+    },
+    .flags = RUBY_TYPED_FREE_IMMEDIATELY,
+};
+
+static VALUE
+mf_alloc(VALUE klass)
+{
+    struct mapped_file *mf;
+    VALUE obj = TypedData_Make_Struct(klass, struct mapped_file, &mf_type, mf);
+    mf->source = Qnil;
+    mf->fd = -1;
+    mf->owns_fd = 0;
+    mf->addr = NULL;
+    mf->len = 0;
+    return obj;
+}
+
+static struct mapped_file *
+get_mf(VALUE self)
+{
+    struct mapped_file *mf;
+    TypedData_Get_Struct(self, struct mapped_file, &mf_type, mf);
+    return mf;
+}
+
+/* ---------------------------------------------------------
+ * MappedFile.new(path_or_fd)
+ *
+ * Arguments:
+ *   path_or_fd - a path (String or #to_path), an IO, or an Integer file
+ *                descriptor. Paths are opened read-only and closed with
+ *                the mapping; IOs and descriptors stay owned by the
+ *                caller and must remain open while the mapping is used.
+ * --------------------------------------------------------- */
+
+static VALUE
+mf_initialize(VALUE self, VALUE source)
+{
+    struct mapped_file *mf = get_mf(self);
+
+    if (mf->fd >= 0) {
+        rb_raise(rb_eRuntimeError, "mapped file already initialized");
+    }
+
+    if (RB_INTEGER_TYPE_P(source)) {
+        mf->fd = NUM2INT(source);
+    } else if (RB_TYPE_P(source, T_FILE)) {
+        mf->fd = NUM2INT(rb_funcall(source, rb_intern("fileno"), 0));
+    } else {
+        if (rb_respond_to(source, rb_intern("to_path"))) {
+            source = rb_funcall(source, rb_intern("to_path"), 0);
+        }
+        source = rb_str_new_frozen(StringValue(source));
+    }
+    RB_OBJ_WRITE(self, &mf->source, source);
+
+    if (mf->fd < 0) {
+        if (!RB_TYPE_P(source, T_STRING)) {
+            rb_raise(rb_eArgError, "invalid file descriptor");
+        }
+        mf_open_path(mf);
+    }
+
+    mf_refresh(mf);
+    return self;
+}
+
+/* ---------------------------------------------------------
+ * MappedFile#put_photo(interp, photo_path, opts)
+ *
+ * Write a frame from the mapping to a photo image with one
+ * Tk_PhotoPutBlock. The block points straight into the mapped pages;
+ * every :format is described to Tk through the block's pixelSize and
+ * channel offsets, so no format needs converting first.
+ *
+ * Arguments:
+ *   interp     - Teek::Interp that owns the photo
+ *   photo_path - Tcl path of the photo image
+ *   opts       - Hash:
+ *                :width, :height - frame size (required)
+ *                :offset         - byte offset of the frame's first pixel
+ *                                  (default 0)
+ *                :stride         - bytes from one row to the next
+ *                                  (default width * bytes-per-pixel)
+ *                :format         - :rgba (default), :argb, :rgb or :gray
+ *                :x, :y          - destination offsets (default 0,0)
+ *                :composite      - :set (default) or :overlay
+ *
+ * Raises ArgumentError if the frame extends past the end of the file.
+ *
+ * Returns nil.
+ *
+ * See: https://www.tcl-lang.org/man/tcl8.6/TkLib/FindPhoto.htm
+ * --------------------------------------------------------- */
+
+static VALUE
+mf_put_photo(VALUE self, VALUE interp, VALUE photo_path, VALUE opts)
+{
+    struct mapped_file *mf = get_mf(self);
+    struct tcltk_interp *tip = get_interp(interp);
+    Tk_PhotoHandle photo;
+    Tk_PhotoImageBlock block;
+    VALUE val;
+    long long offset = 0, stride, end;
+    int width, height, bpp, fmt;
+    int x_off = 0, y_off = 0;
+    int comp_rule = TK_PHOTO_COMPOSITE_SET;
+
+    StringValue(photo_path);
+    Check_Type(opts, T_HASH);
+
+    width = NUM2INT(rb_hash_fetch(opts, ID2SYM(rb_intern("width"))));
+    height = NUM2INT(rb_hash_fetch(opts, ID2SYM(rb_intern("height"))));
+    if (width <= 0 || height <= 0) {
+        rb_raise(rb_eArgError, "width and height must be positive");
+    }
+
+    fmt = teek_photo_format_opt(rb_hash_aref(opts, ID2SYM(rb_intern("format"))));
+    bpp = teek_pixfmt_bytes(fmt);
+
+    val = rb_hash_aref(opts, ID2SYM(rb_intern("offset")));
+    if (!NIL_P(val)) offset = NUM2LL(val);
+    val = rb_hash_aref(opts, ID2SYM(rb_intern("stride")));
+    stride = NIL_P(val) ? (long long)width * bpp : NUM2LL(val);
+    val = rb_hash_aref(opts, ID2SYM(rb_intern("x")));
+    if (!NIL_P(val)) x_off = NUM2INT(val);
+    val = rb_hash_aref(opts, ID2SYM(rb_intern("y")));
+    if (!NIL_P(val)) y_off = NUM2INT(val);
+    val = rb_hash_aref(opts, ID2SYM(rb_intern("composite")));
+    if (!NIL_P(val) && TYPE(val) == T_SYMBOL) {
+        if (rb_intern("overlay") == SYM2ID(val)) {
+            comp_rule = TK_PHOTO_COMPOSITE_OVERLAY;
+        }
+    }
+
+    if (offset < 0) {
+        rb_raise(rb_eArgError, "offset must be non-negative");
+    }
+    if (stride < (long long)width * bpp || stride > INT_MAX) {
+        rb_raise(rb_eArgError, "stride %lld is out of range for %d pixels of %d bytes",
+                 stride, width, bpp);
+    }
+
+    mf_refresh(mf);
+
+    end = offset + stride * (height - 1) + (long long)width * bpp;
+    if ((unsigned long long)end > mf->len) {
+        rb_raise(rb_eArgError, "frame needs %lld bytes but the file has %llu",
+                 end, (unsigned long long)mf->len);
+    }
+
+    photo = Tk_FindPhoto(tip->interp, StringValueCStr(photo_path));
+    if (!photo) {
+        rb_raise(eTclError, "photo image not found: %s", StringValueCStr(photo_path));
+    }
+
+    block.pixelPtr = mf->addr + offset;
+    block.width = width;
+    block.height = height;
+    block.pitch = (int)stride;
+    block.pixelSize = bpp;
+    switch (fmt) {
+    case TEEK_PIXFMT_BGRA:
+        /* ARGB: 0xAARRGGBB stored little-endian as bytes: [B, G, R, A] */
+        block.offset[0] = 2;
+        block.offset[1] = 1;
+        block.offset[2] = 0;
+        block.offset[3] = 3;
+        break;
+    case TEEK_PIXFMT_GRAY:
+        /* One byte read as R, G and B; alpha offset past the pixel
+         * tells Tk the block is opaque */
+        block.offset[0] = 0;
+        block.offset[1] = 0;
+        block.offset[2] = 0;
+        block.offset[3] = 1;
+        break;
+    default:
+        /* RGBA, or RGB with the alpha offset past the pixel (opaque) */
+        block.offset[0] = 0;
+        block.offset[1] = 1;
+        block.offset[2] = 2;
+        block.offset[3] = 3;
+        break;
+    }
+
+    if (Tk_PhotoPutBlock(tip->interp, photo, &block, x_off, y_off,
+                         width, height, comp_rule) != TCL_OK) {
+        rb_raise(eTclError, "Tk_PhotoPutBlock failed: %s",
+                 Tcl_GetStringResult(tip->interp));
+    }
+
+    return Qnil;
+}
+
+/* MappedFile#refresh - remap now if the file changed, returns self */
+static VALUE
+mf_refresh_m(VALUE self)
+{
+    mf_refresh(get_mf(self));
+    return self;
+}
+
+/* MappedFile#size - bytes currently mapped */
+static VALUE
+mf_size(VALUE self)
+{
+    return SIZET2NUM(get_mf(self)->len);
+}
+
+/* MappedFile#source - the path, IO or descriptor it was created with */
+static VALUE
+mf_source(VALUE self)
+{
+    return get_mf(self)->source;
+}
+
+/* MappedFile#close - unmap, and close the descriptor if we opened it */
+static VALUE
+mf_close(VALUE self)
+{
+    struct mapped_file *mf = get_mf(self);
+    mf_unmap(mf);
+    mf_close_fd(mf);
+    return Qnil;
+}
+
+static VALUE
+mf_closed_p(VALUE self)
+{
+    return get_mf(self)->fd < 0 ? Qtrue : Qfalse;
+}
+
+/* ---------------------------------------------------------
+ * Init_tkmmap - Register Teek::MappedFile
+ *
+ * Called from Init_tcltklib in tcltkbridge.c
+ * --------------------------------------------------------- */
+
+void
+Init_tkmmap(VALUE mTeek)
+{
+    cMappedFile = rb_define_class_under(mTeek, "MappedFile", rb_cObject);
+    rb_define_alloc_func(cMappedFile, mf_alloc);
+
+    rb_define_method(cMappedFile, "initialize", mf_initialize, 1);
+    rb_define_method(cMappedFile, "put_photo", mf_put_photo, 3);
+    rb_define_method(cMappedFile, "refresh", mf_refresh_m, 0);
+    rb_define_method(cMappedFile, "size", mf_size, 0);
+    rb_define_method(cMappedFile, "source", mf_source, 0);
+    rb_define_method(cMappedFile, "close", mf_close, 0);
+    rb_define_method(cMappedFile, "closed?", mf_closed_p, 0);
+}
@@ -5,6 +5,135 @@
  */
 
 #include "tcltkbridge.h"
+#include "ruby/io/buffer.h"
+#include <string.h>
+
+/* ---------------------------------------------------------
+ * Map a photo :format option to a teek_pixconv format.
+ *
+ * Photo formats keep their existing meaning: :argb is pixels packed as
+ * 0xAARRGGBB integers, which on little-endian hosts is B,G,R,A bytes.
+ * --------------------------------------------------------- */
+
+int
+teek_photo_format_opt(VALUE val)
+{
+    ID id;
+
+    if (NIL_P(val)) return TEEK_PIXFMT_RGBA;
+    if (!SYMBOL_P(val)) {
+        rb_raise(rb_eTypeError, "format must be a Symbol");
+    }
+    id = SYM2ID(val);
+    if (id == rb_intern("rgba")) return TEEK_PIXFMT_RGBA;
+    if (id == rb_intern("argb")) return TEEK_PIXFMT_BGRA;
+    if (id == rb_intern("rgb")) return TEEK_PIXFMT_RGB;
+    if (id == rb_intern("gray")) return TEEK_PIXFMT_GRAY;
+    rb_raise(rb_eArgError, "unknown pixel format :%s (expected :rgba, :argb, :rgb or :gray)",
+             rb_id2name(id));
+    return -1; /* not reached */
+}
+
+/* ---------------------------------------------------------
+ * Borrow the bytes of a pixel source: a String or an IO::Buffer.
+ *
+ * Nothing is copied - Tk reads the String's or buffer's memory in
+ * place - so a frozen (Ractor-shareable) String or an IO::Buffer handed
+ * over from a worker reaches the photo without another trip through
+ * Ruby. IO::Buffers stay locked until pixel_source_release.
+ * --------------------------------------------------------- */
+
+static const unsigned char *
+pixel_source_borrow(VALUE *srcp, size_t *len)
+{
+    VALUE src = *srcp;
+    const void *base;
+
+    if (rb_obj_is_kind_of(src, rb_cIOBuffer)) {
+        rb_io_buffer_get_bytes_for_reading(src, &base, len);
+        rb_io_buffer_lock(src);
+        return (const unsigned char *)base;
+    }
+    /* Anything else goes through to_str, as StringValue always allowed;
+     * *srcp is replaced so the caller keeps the converted String alive */
+    if (!RB_TYPE_P(src, T_STRING)) {
+        src = rb_check_string_type(src);
+        if (NIL_P(src)) {
+            rb_raise(rb_eTypeError, "pixel_data must be a String or IO::Buffer (got %s)",
+                     rb_obj_classname(*srcp));
+        }
+        *srcp = src;
+    }
+    *len = (size_t)RSTRING_LEN(src);
+    return (const unsigned char *)RSTRING_PTR(src);
+}
+
+static void
+pixel_source_release(VALUE src)
+{
+    if (!RB_TYPE_P(src, T_STRING)) rb_io_buffer_unlock(src);
+}
+
+/* Whether setup_put_block needs a width * height * 4 byte scratch
+ * buffer to convert the pixels into */
+static int
+put_block_converts(int fmt, int premultiplied)
+{
+    return premultiplied || (fmt != TEEK_PIXFMT_RGBA && fmt != TEEK_PIXFMT_BGRA);
+}
+
+/* ---------------------------------------------------------
+ * Point a Tk_PhotoImageBlock at caller pixel data.
+ *
+ * RGBA and ARGB go straight to Tk via block.offset. RGB, gray and
+ * premultiplied input are converted to RGBA first, into tmp (see
+ * put_block_converts). The caller allocates tmp before borrowing the
+ * pixel source, so nothing that can raise runs while it is locked; the
+ * source is released before raising on a size mismatch.
+ * --------------------------------------------------------- */
+
+static void
+setup_put_block(Tk_PhotoImageBlock *block, VALUE pixel_data,
+                const unsigned char *pixels, size_t len,
+                int width, int height, int fmt, int premultiplied,
+                unsigned char *tmp)
+{
+    long expected_size = (long)width * height * teek_pixfmt_bytes(fmt);
+
+    if ((long)len != expected_size) {
+        pixel_source_release(pixel_data);
+        rb_raise(rb_eArgError, "pixel_data size mismatch: expected %ld bytes, got %ld",
+                 expected_size, (long)len);
+    }
+
+    block->pixelPtr = (unsigned char *)pixels;
+    block->width = width;
+    block->height = height;
+    block->pitch = width * 4;
+    block->pixelSize = 4;
+
+    if (put_block_converts(fmt, premultiplied)) {
+        teek_pixconv(block->pixelPtr, fmt, tmp, TEEK_PIXFMT_RGBA,
+                     (size_t)width * height,
+                     premultiplied ? TEEK_PIXCONV_UNPREMULTIPLY : 0);
+        block->pixelPtr = tmp;
+        fmt = TEEK_PIXFMT_RGBA;
+    }
+
+    if (fmt == TEEK_PIXFMT_BGRA) {
+        /* ARGB: 0xAARRGGBB stored little-endian as bytes: [B, G, R, A] */
+        block->offset[0] = 2;  /* Red at byte 2 */
+        block->offset[1] = 1;  /* Green at byte 1 */
+        block->offset[2] = 0;  /* Blue at byte 0 */
+        block->offset[3] = 3;  /* Alpha at byte 3 */
+    } else {
+        /* RGBA: [R, G, B, A] */
+        block->offset[0] = 0;
+        block->offset[1] = 1;
+        block->offset[2] = 2;
+        block->offset[3] = 3;
+    }
+}
 
 /* ---------------------------------------------------------
  * Interp#photo_put_block(photo_path, pixel_data, width, height, opts={})
@@ -14,18 +143,23 @@
  *
  * Arguments:
  *   photo_path - Tcl path of the photo image (e.g., "i00001")
- *   pixel_data - Binary string of pixels (4 bytes per pixel)
+ *   pixel_data - Binary String or IO::Buffer of pixels (read in place)
  *   width      - Image width in pixels
  *   height     - Image height in pixels
  *   opts       - Optional hash:
  *                :x, :y       - destination offsets (default 0,0)
- *                :format      - :rgba (default) or :argb
+ *                :format      - :rgba (default), :argb, :rgb or :gray
+ *                :premultiplied - true if color channels are already
+ *                                 multiplied by alpha (default false)
  *                :composite   - :set (default, overwrite) or :overlay (alpha blend)
  *
- * The pixel_data must be exactly width * height * 4 bytes.
+ * The pixel_data must be exactly width * height * bytes-per-pixel
+ * (4 for :rgba/:argb, 3 for :rgb, 1 for :gray).
  *
  * Format :argb expects pixels packed as 0xAARRGGBB integers (little-endian: B,G,R,A bytes).
- * This matches SDL2 and many graphics libraries.
+ * This matches SDL2 and many graphics libraries. :rgba and :argb are handed
+ * to Tk without copying; the other formats (and premultiplied data) go
+ * through the SIMD kernels in tkpixconv.c first.
  *
  * See: https://www.tcl-lang.org/man/tcl8.6/TkLib/FindPhoto.htm
  * --------------------------------------------------------- */
@@ -38,14 +172,18 @@ interp_photo_put_block(int argc, VALUE *argv, VALUE self)
     Tk_PhotoHandle photo;
     Tk_PhotoImageBlock block;
     int width, height, x_off, y_off;
-    int is_argb = 0;
+    int fmt = TEEK_PIXFMT_RGBA;
+    int premultiplied = 0;
     int comp_rule = TK_PHOTO_COMPOSITE_SET;
-    long expected_size;
+    const unsigned char *pixels;
+    size_t len;
+    unsigned char *tmp;
+    VALUE tmpbuf = 0;
+    int status;
 
     rb_scan_args(argc, argv, "41", &photo_path, &pixel_data, &width_val, &height_val, &opts);
 
     StringValue(photo_path);
-    StringValue(pixel_data);
     width = NUM2INT(width_val);
     height = NUM2INT(height_val);
 
@@ -54,13 +192,6 @@ interp_photo_put_block(int argc, VALUE *argv, VALUE self)
         rb_raise(rb_eArgError, "width and height must be positive");
     }
 
-    /* Validate data size */
-    expected_size = (long)width * height * 4;
-    if (RSTRING_LEN(pixel_data) != expected_size) {
-        rb_raise(rb_eArgError, "pixel_data size mismatch: expected %ld bytes, got %ld",
-                 expected_size, RSTRING_LEN(pixel_data));
-    }
-
     /* Parse options */
     x_off = 0;
     y_off = 0;
@@ -70,12 +201,9 @@ interp_photo_put_block(int argc, VALUE *argv, VALUE self)
         if (!NIL_P(val)) x_off = NUM2INT(val);
         val = rb_hash_aref(opts, ID2SYM(rb_intern("y")));
         if (!NIL_P(val)) y_off = NUM2INT(val);
-        val = rb_hash_aref(opts, ID2SYM(rb_intern("format")));
-        if (!NIL_P(val) && TYPE(val) == T_SYMBOL) {
-            if (rb_intern("argb") == SYM2ID(val)) {
-                is_argb = 1;
-            }
-        }
+        fmt = teek_photo_format_opt(rb_hash_aref(opts, ID2SYM(rb_intern("format"))));
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("premultiplied")));
+        if (RTEST(val)) premultiplied = 1;
         val = rb_hash_aref(opts, ID2SYM(rb_intern("composite")));
         if (!NIL_P(val) && TYPE(val) == T_SYMBOL) {
             if (rb_intern("overlay") == SYM2ID(val)) {
@@ -90,30 +218,18 @@ interp_photo_put_block(int argc, VALUE *argv, VALUE self)
         rb_raise(eTclError, "photo image not found: %s", StringValueCStr(photo_path));
     }
 
-    /* Set up the pixel block structure */
-    block.pixelPtr = (unsigned char *)RSTRING_PTR(pixel_data);
-    block.width = width;
-    block.height = height;
-    block.pitch = width * 4;
-    block.pixelSize = 4;
-
-    if (is_argb) {
-        /* ARGB: 0xAARRGGBB stored little-endian as bytes: [B, G, R, A] */
-        block.offset[0] = 2;  /* Red at byte 2 */
-        block.offset[1] = 1;  /* Green at byte 1 */
-        block.offset[2] = 0;  /* Blue at byte 0 */
-        block.offset[3] = 3;  /* Alpha at byte 3 */
-    } else {
-        /* RGBA: [R, G, B, A] */
-        block.offset[0] = 0;
-        block.offset[1] = 1;
-        block.offset[2] = 2;
-        block.offset[3] = 3;
-    }
+    /* Set up the pixel block structure (converting if needed) */
+    tmp = put_block_converts(fmt, premultiplied)
+        ? ALLOCV_N(unsigned char, tmpbuf, (size_t)width * height * 4) : NULL;
+    pixels = pixel_source_borrow(&pixel_data, &len);
+    setup_put_block(&block, pixel_data, pixels, len, width, height, fmt, premultiplied, tmp);
 
     /* Write pixels to the photo image */
-    if (Tk_PhotoPutBlock(tip->interp, photo, &block, x_off, y_off,
-                         width, height, comp_rule) != TCL_OK) {
+    status = Tk_PhotoPutBlock(tip->interp, photo, &block, x_off, y_off,
+                              width, height, comp_rule);
+    ALLOCV_END(tmpbuf);
+    pixel_source_release(pixel_data);
+    if (status != TCL_OK) {
         rb_raise(eTclError, "Tk_PhotoPutBlock failed: %s",
                  Tcl_GetStringResult(tip->interp));
     }
@@ -129,22 +245,27 @@ interp_photo_put_block(int argc, VALUE *argv, VALUE self)
  *
  * Arguments:
  *   photo_path - Tcl path of the photo image (e.g., "i00001")
- *   pixel_data - Binary string of pixels (4 bytes per pixel)
+ *   pixel_data - Binary String or IO::Buffer of pixels (read in place)
  *   width      - Source image width in pixels
  *   height     - Source image height in pixels
  *   opts       - Optional hash:
  *                :x, :y        - destination offsets (default 0,0)
  *                :zoom_x, :zoom_y       - zoom factors (default 1,1)
  *                :subsample_x, :subsample_y - subsample factors (default 1,1)
- *                :format       - :rgba (default) or :argb
+ *                :format       - :rgba (default), :argb, :rgb or :gray
+ *                :premultiplied - true if color channels are already
+ *                                 multiplied by alpha (default false)
  *                :composite    - :set (default, overwrite) or :overlay (alpha blend)
  *
- * The pixel_data must be exactly width * height * 4 bytes.
+ * The pixel_data must be exactly width * height * bytes-per-pixel
+ * (4 for :rgba/:argb, 3 for :rgb, 1 for :gray).
  * Zoom replicates pixels (zoom=3 makes each pixel 3x3).
  * Subsample skips pixels (subsample=2 takes every other pixel).
  *
  * Format :argb expects pixels packed as 0xAARRGGBB integers (little-endian: B,G,R,A bytes).
- * This matches SDL2 and many graphics libraries.
+ * This matches SDL2 and many graphics libraries. :rgba and :argb are handed
+ * to Tk without copying; the other formats (and premultiplied data) go
+ * through the SIMD kernels in tkpixconv.c first.
  *
  * See: https://www.tcl-lang.org/man/tcl8.6/TkLib/FindPhoto.htm
  * --------------------------------------------------------- */
@@ -159,14 +280,18 @@ interp_photo_put_zoomed_block(int argc, VALUE *argv, VALUE self)
     int width, height, x_off, y_off;
     int zoom_x, zoom_y, subsample_x, subsample_y;
     int dest_width, dest_height;
-    int is_argb = 0;
+    int fmt = TEEK_PIXFMT_RGBA;
+    int premultiplied = 0;
     int comp_rule = TK_PHOTO_COMPOSITE_SET;
-    long expected_size;
+    const unsigned char *pixels;
+    size_t len;
+    unsigned char *tmp;
+    VALUE tmpbuf = 0;
+    int status;
 
     rb_scan_args(argc, argv, "41", &photo_path, &pixel_data, &width_val, &height_val, &opts);
 
     StringValue(photo_path);
-    StringValue(pixel_data);
     width = NUM2INT(width_val);
     height = NUM2INT(height_val);
 
@@ -175,13 +300,6 @@ interp_photo_put_zoomed_block(int argc, VALUE *argv, VALUE self)
         rb_raise(rb_eArgError, "width and height must be positive");
     }
 
-    /* Validate data size */
-    expected_size = (long)width * height * 4;
-    if (RSTRING_LEN(pixel_data) != expected_size) {
-        rb_raise(rb_eArgError, "pixel_data size mismatch: expected %ld bytes, got %ld",
-                 expected_size, RSTRING_LEN(pixel_data));
-    }
-
     /* Parse options with defaults */
     x_off = 0;
     y_off = 0;
@@ -204,12 +322,9 @@ interp_photo_put_zoomed_block(int argc, VALUE *argv, VALUE self)
         if (!NIL_P(val)) subsample_x = NUM2INT(val);
         val = rb_hash_aref(opts, ID2SYM(rb_intern("subsample_y")));
         if (!NIL_P(val)) subsample_y = NUM2INT(val);
-        val = rb_hash_aref(opts, ID2SYM(rb_intern("format")));
-        if (!NIL_P(val) && TYPE(val) == T_SYMBOL) {
-            if (rb_intern("argb") == SYM2ID(val)) {
-                is_argb = 1;
-            }
-        }
+        fmt = teek_photo_format_opt(rb_hash_aref(opts, ID2SYM(rb_intern("format"))));
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("premultiplied")));
+        if (RTEST(val)) premultiplied = 1;
         val = rb_hash_aref(opts, ID2SYM(rb_intern("composite")));
         if (!NIL_P(val) && TYPE(val) == T_SYMBOL) {
             if (rb_intern("overlay") == SYM2ID(val)) {
@@ -232,36 +347,24 @@ interp_photo_put_zoomed_block(int argc, VALUE *argv, VALUE self)
         rb_raise(eTclError, "photo image not found: %s", StringValueCStr(photo_path));
     }
 
-    /* Set up the pixel block structure */
-    block.pixelPtr = (unsigned char *)RSTRING_PTR(pixel_data);
-    block.width = width;
-    block.height = height;
-    block.pitch = width * 4;
-    block.pixelSize = 4;
-
-    if (is_argb) {
-        /* ARGB: 0xAARRGGBB stored little-endian as bytes: [B, G, R, A] */
-        block.offset[0] = 2;  /* Red at byte 2 */
-        block.offset[1] = 1;  /* Green at byte 1 */
-        block.offset[2] = 0;  /* Blue at byte 0 */
-        block.offset[3] = 3;  /* Alpha at byte 3 */
-    } else {
-        /* RGBA: [R, G, B, A] */
-        block.offset[0] = 0;
-        block.offset[1] = 1;
-        block.offset[2] = 2;
-        block.offset[3] = 3;
-    }
+    /* Set up the pixel block structure (converting if needed) */
+    tmp = put_block_converts(fmt, premultiplied)
+        ? ALLOCV_N(unsigned char, tmpbuf, (size_t)width * height * 4) : NULL;
+    pixels = pixel_source_borrow(&pixel_data, &len);
+    setup_put_block(&block, pixel_data, pixels, len, width, height, fmt, premultiplied, tmp);
 
     /* Calculate destination dimensions */
     dest_width = (width / subsample_x) * zoom_x;
     dest_height = (height / subsample_y) * zoom_y;
 
     /* Write pixels with zoom/subsample */
-    if (Tk_PhotoPutZoomedBlock(tip->interp, photo, &block, x_off, y_off,
-                               dest_width, dest_height,
-                               zoom_x, zoom_y, subsample_x, subsample_y,
-                               comp_rule) != TCL_OK) {
+    status = Tk_PhotoPutZoomedBlock(tip->interp, photo, &block, x_off, y_off,
+                                    dest_width, dest_height,
+                                    zoom_x, zoom_y, subsample_x, subsample_y,
+                                    comp_rule);
+    ALLOCV_END(tmpbuf);
+    pixel_source_release(pixel_data);
+    if (status != TCL_OK) {
         rb_raise(eTclError, "Tk_PhotoPutZoomedBlock failed: %s",
                  Tcl_GetStringResult(tip->interp));
     }
@@ -269,6 +372,78 @@ interp_photo_put_zoomed_block(int argc, VALUE *argv, VALUE self)
     return Qnil;
 }
 
+/* ---------------------------------------------------------
+ * Copy a region of a photo block out as packed pixels in dst_fmt.
+ *
+ * Tk is free to store photo pixels in whatever channel order it likes
+ * and hands back the layout in block.offset[]. In practice it's RGBA,
+ * 4 bytes per pixel, so check for that and copy whole rows with memcpy
+ * (or the whole region in one go when rows are contiguous) instead of
+ * reordering byte by byte. Other output formats run each row through
+ * teek_pixconv.
+ * --------------------------------------------------------- */
+
+static void
+copy_block_region(const Tk_PhotoImageBlock *block, int x_off, int y_off,
+                  int width, int height, unsigned char *dst,
+                  int dst_fmt, int flags)
+{
+    const unsigned char *src;
+    size_t row_bytes = (size_t)width * 4;
+    size_t dst_row_bytes = (size_t)width * teek_pixfmt_bytes(dst_fmt);
+    unsigned char *row_tmp;
+    int x, y;
+
+    if (block->pixelSize == 4 &&
+        block->offset[0] == 0 && block->offset[1] == 1 &&
+        block->offset[2] == 2 && block->offset[3] == 3) {
+        src = block->pixelPtr + (size_t)y_off * block->pitch + (size_t)x_off * 4;
+        if (dst_fmt != TEEK_PIXFMT_RGBA || flags) {
+            if ((size_t)block->pitch == row_bytes) {
+                teek_pixconv(src, TEEK_PIXFMT_RGBA, dst, dst_fmt,
+                             (size_t)width * height, flags);
+                return;
+            }
+            for (y = 0; y < height; y++) {
+                teek_pixconv(src, TEEK_PIXFMT_RGBA, dst, dst_fmt, width, flags);
+                dst += dst_row_bytes;
+                src += block->pitch;
+            }
+            return;
+        }
+        if ((size_t)block->pitch == row_bytes) {
+            memcpy(dst, src, row_bytes * height);
+            return;
+        }
+        for (y = 0; y < height; y++) {
+            memcpy(dst, src, row_bytes);
+            dst += row_bytes;
+            src += block->pitch;
+        }
+        return;
+    }
+
+    /* Unusual layout: reorder a row to RGBA, then convert if asked */
+    row_tmp = (dst_fmt != TEEK_PIXFMT_RGBA || flags) ? ALLOC_N(unsigned char, row_bytes) : NULL;
+    for (y = 0; y < height; y++) {
+        unsigned char *out = row_tmp ? row_tmp : dst;
+        src = block->pixelPtr + (size_t)(y_off + y) * block->pitch
+              + (size_t)x_off * block->pixelSize;
+        for (x = 0; x < width; x++) {
+            *out++ = src[block->offset[0]];
+            *out++ = src[block->offset[1]];
+            *out++ = src[block->offset[2]];
+            *out++ = (block->pixelSize >= 4) ? src[block->offset[3]] : 255;
+            src += block->pixelSize;
+        }
+        if (row_tmp) {
+            teek_pixconv(row_tmp, TEEK_PIXFMT_RGBA, dst, dst_fmt, width, flags);
+        }
+        dst += dst_row_bytes;
+    }
+    if (row_tmp) xfree(row_tmp);
+}
+
 /* ---------------------------------------------------------
  * Interp#photo_get_image(photo_path, opts={})
  *
@@ -281,10 +456,14 @@ interp_photo_put_zoomed_block(int argc, VALUE *argv, VALUE self)
  *                :width, :height - region size (default: full image)
  *                :unpack       - if true, return flat array of integers
  *                                instead of binary string (default: false)
+ *                :format       - :rgba (default), :argb, :rgb or :gray
+ *                :premultiply  - if true, multiply color channels by alpha
+ *                                (default: false)
  *
  * Returns a Hash with:
- *   :data   - Binary string of RGBA pixels (4 bytes per pixel), OR
- *   :pixels - Flat array of integers [r,g,b,a,r,g,b,a,...] if unpack: true
+ *   :data   - Binary string of pixels in the requested format, OR
+ *   :pixels - Flat array of the same bytes as integers (e.g.
+ *             [r,g,b,a,r,g,b,a,...] for :rgba) if unpack: true
  *   :width  - Width of returned data
  *   :height - Height of returned data
  *
@@ -302,9 +481,9 @@ interp_photo_get_image(int argc, VALUE *argv, VALUE self)
     int img_width, img_height;
     int actual_width, actual_height;
     int do_unpack;
-    unsigned char *src;
-    int x, y;
-    int r_off, g_off, b_off, a_off;
+    int fmt = TEEK_PIXFMT_RGBA;
+    int flags = 0;
+    VALUE data_str;
 
     rb_scan_args(argc, argv, "11", &photo_path, &opts);
 
@@ -343,6 +522,9 @@ interp_photo_get_image(int argc, VALUE *argv, VALUE self)
         if (!NIL_P(val)) req_height = NUM2INT(val);
         val = rb_hash_aref(opts, ID2SYM(rb_intern("unpack")));
         if (RTEST(val)) do_unpack = 1;
+        fmt = teek_photo_format_opt(rb_hash_aref(opts, ID2SYM(rb_intern("format"))));
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("premultiply")));
+        if (RTEST(val)) flags = TEEK_PIXCONV_PREMULTIPLY;
     }
 
     /* Validate and clamp region */
@@ -361,56 +543,150 @@ interp_photo_get_image(int argc, VALUE *argv, VALUE self)
         rb_raise(rb_eArgError, "invalid region size");
     }
 
-    /* Get channel offsets from the block */
-    r_off = block.offset[0];
-    g_off = block.offset[1];
-    b_off = block.offset[2];
-    a_off = block.offset[3];
-
     /* Build result hash */
     result = rb_hash_new();
     rb_hash_aset(result, ID2SYM(rb_intern("width")), INT2NUM(actual_width));
     rb_hash_aset(result, ID2SYM(rb_intern("height")), INT2NUM(actual_height));
 
+    data_str = rb_str_new(NULL, (long)actual_width * actual_height * teek_pixfmt_bytes(fmt));
+    copy_block_region(&block, x_off, y_off, actual_width, actual_height,
+                      (unsigned char *)RSTRING_PTR(data_str), fmt, flags);
+
     if (do_unpack) {
-        /* Return flat array of integers: [r,g,b,a,r,g,b,a,...] */
-        long num_values = (long)actual_width * actual_height * 4;
+        /* Return flat array of integers, one per byte */
+        const unsigned char *bytes = (const unsigned char *)RSTRING_PTR(data_str);
+        long i, num_values = RSTRING_LEN(data_str);
         VALUE pixels = rb_ary_new_capa(num_values);
 
-        for (y = 0; y < actual_height; y++) {
-            src = block.pixelPtr + (y_off + y) * block.pitch + x_off * block.pixelSize;
-            for (x = 0; x < actual_width; x++) {
-                rb_ary_push(pixels, INT2FIX(src[r_off]));
-                rb_ary_push(pixels, INT2FIX(src[g_off]));
-                rb_ary_push(pixels, INT2FIX(src[b_off]));
-                rb_ary_push(pixels, INT2FIX((block.pixelSize >= 4) ? src[a_off] : 255));
-                src += block.pixelSize;
-            }
+        for (i = 0; i < num_values; i++) {
+            rb_ary_push(pixels, INT2FIX(bytes[i]));
         }
 
         rb_hash_aset(result, ID2SYM(rb_intern("pixels")), pixels);
     } else {
-        /* Return binary string */
-        VALUE data_str = rb_str_new(NULL, (long)actual_width * actual_height * 4);
-        unsigned char *dst = (unsigned char *)RSTRING_PTR(data_str);
-
-        for (y = 0; y < actual_height; y++) {
-            src = block.pixelPtr + (y_off + y) * block.pitch + x_off * block.pixelSize;
-            for (x = 0; x < actual_width; x++) {
-                *dst++ = src[r_off];
-                *dst++ = src[g_off];
-                *dst++ = src[b_off];
-                *dst++ = (block.pixelSize >= 4) ? src[a_off] : 255;
-                src += block.pixelSize;
-            }
-        }
-
         rb_hash_aset(result, ID2SYM(rb_intern("data")), data_str);
     }
 
     return result;
 }
 
+/* ---------------------------------------------------------
+ * Interp#photo_read_into(photo_path, buffer, opts={})
+ *
+ * Read pixel data from a photo image into a caller-provided buffer,
+ * so capture loops can reuse the same memory frame after frame instead
+ * of allocating a new String per call like photo_get_image does.
+ *
+ * Arguments:
+ *   photo_path - Tcl path of the photo image (e.g., "i00001")
+ *   buffer     - Mutable String or writable IO::Buffer
+ *   opts       - Optional hash:
+ *                :x, :y          - source offsets (default 0,0)
+ *                :width, :height - region size (default: full image)
+ *                :format         - :rgba (default), :argb, :rgb or :gray
+ *                :premultiply    - multiply color channels by alpha
+ *
+ * The region is clamped to the image exactly like photo_get_image.
+ * Pixels are written packed in the requested format starting at byte 0
+ * of the buffer.
+ *
+ * A String is resized to exactly width * height * bytes-per-pixel (a no-op
+ * when it's already that size, so a reused String keeps its memory).
+ * An IO::Buffer can't grow, so one that's too small raises ArgumentError.
+ *
+ * Returns [width, height] of the region actually written.
+ * --------------------------------------------------------- */
+
+static VALUE
+interp_photo_read_into(int argc, VALUE *argv, VALUE self)
+{
+    struct tcltk_interp *tip = get_interp(self);
+    VALUE photo_path, buffer, opts;
+    Tk_PhotoHandle photo;
+    Tk_PhotoImageBlock block;
+    int x_off, y_off, req_width, req_height;
+    int actual_width, actual_height;
+    int fmt = TEEK_PIXFMT_RGBA;
+    int flags = 0;
+    size_t needed;
+    unsigned char *dst;
+
+    rb_scan_args(argc, argv, "21", &photo_path, &buffer, &opts);
+
+    StringValue(photo_path);
+
+    photo = Tk_FindPhoto(tip->interp, StringValueCStr(photo_path));
+    if (!photo) {
+        rb_raise(eTclError, "photo image not found: %s", StringValueCStr(photo_path));
+    }
+
+    if (!Tk_PhotoGetImage(photo, &block)) {
+        rb_raise(eTclError, "failed to get photo image data");
+    }
+
+    x_off = 0;
+    y_off = 0;
+    req_width = block.width;
+    req_height = block.height;
+
+    if (!NIL_P(opts) && TYPE(opts) == T_HASH) {
+        VALUE val;
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("x")));
+        if (!NIL_P(val)) x_off = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("y")));
+        if (!NIL_P(val)) y_off = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("width")));
+        if (!NIL_P(val)) req_width = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("height")));
+        if (!NIL_P(val)) req_height = NUM2INT(val);
+        fmt = teek_photo_format_opt(rb_hash_aref(opts, ID2SYM(rb_intern("format"))));
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("premultiply")));
+        if (RTEST(val)) flags = TEEK_PIXCONV_PREMULTIPLY;
+    }
+
+    /* Validate and clamp region (same rules as photo_get_image) */
+    if (x_off < 0) x_off = 0;
+    if (y_off < 0) y_off = 0;
+    if (x_off >= block.width || y_off >= block.height) {
+        rb_raise(rb_eArgError, "offset outside image bounds");
+    }
+
+    actual_width = req_width;
+    actual_height = req_height;
+    if (x_off + actual_width > block.width) actual_width = block.width - x_off;
+    if (y_off + actual_height > block.height) actual_height = block.height - y_off;
+
+    if (actual_width <= 0 || actual_height <= 0) {
+        rb_raise(rb_eArgError, "invalid region size");
+    }
+
+    needed = (size_t)actual_width * actual_height * teek_pixfmt_bytes(fmt);
+
+    if (RB_TYPE_P(buffer, T_STRING)) {
+        rb_str_modify(buffer);
+        if ((size_t)RSTRING_LEN(buffer) != needed) {
+            rb_str_resize(buffer, (long)needed);
+        }
+        dst = (unsigned char *)RSTRING_PTR(buffer);
+    } else if (rb_obj_is_kind_of(buffer, rb_cIOBuffer)) {
+        void *base;
+        size_t size;
+        rb_io_buffer_get_bytes_for_writing(buffer, &base, &size);
+        if (size < needed) {
+            rb_raise(rb_eArgError, "buffer too small: need %zu bytes, got %zu",
+                     needed, size);
+        }
+        dst = (unsigned char *)base;
+    } else {
+        rb_raise(rb_eTypeError, "buffer must be a String or IO::Buffer (got %s)",
+                 rb_obj_classname(buffer));
+    }
+
+    copy_block_region(&block, x_off, y_off, actual_width, actual_height, dst, fmt, flags);
+
+    return rb_ary_new_from_args(2, INT2NUM(actual_width), INT2NUM(actual_height));
+}
+
 /* ---------------------------------------------------------
  * Interp#photo_get_size(photo_path)
  *
@@ -563,6 +839,107 @@ interp_photo_expand(VALUE self, VALUE photo_path, VALUE width_val, VALUE height_
     return Qnil;
 }
 
+/* ---------------------------------------------------------
+ * Interp#photo_copy_region(src_path, dst_path, opts={})
+ *
+ * Copy a rectangle of one photo into another. The source block from
+ * Tk_PhotoGetImage is handed straight to Tk_PhotoPutBlock, offset to the
+ * region's first pixel, so the pixels never pass through a Ruby string
+ * or the Tcl "$photo copy" option parser.
+ *
+ * Arguments:
+ *   src_path - Tcl path of the photo to read from
+ *   dst_path - Tcl path of the photo to write to
+ *   opts     - Optional hash:
+ *              :src_x, :src_y   - source region origin (default 0,0)
+ *              :width, :height  - region size (default: rest of the source)
+ *              :x, :y           - destination offsets (default 0,0)
+ *              :composite       - :set (default) or :overlay
+ *
+ * The region is clamped to the source image. Tk copies the block first
+ * when source and destination are the same photo, so overlapping
+ * copies within one image are safe.
+ *
+ * Returns [width, height] of the region copied.
+ *
+ * See: https://www.tcl-lang.org/man/tcl8.6/TkLib/FindPhoto.htm
+ * --------------------------------------------------------- */
+
+static VALUE
+interp_photo_copy_region(int argc, VALUE *argv, VALUE self)
+{
+    struct tcltk_interp *tip = get_interp(self);
+    VALUE src_path, dst_path, opts;
+    Tk_PhotoHandle src, dst;
+    Tk_PhotoImageBlock block;
+    int src_x = 0, src_y = 0, x_off = 0, y_off = 0;
+    int width = -1, height = -1;
+    int comp_rule = TK_PHOTO_COMPOSITE_SET;
+
+    rb_scan_args(argc, argv, "21", &src_path, &dst_path, &opts);
+
+    StringValue(src_path);
+    StringValue(dst_path);
+
+    if (!NIL_P(opts) && TYPE(opts) == T_HASH) {
+        VALUE val;
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("src_x")));
+        if (!NIL_P(val)) src_x = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("src_y")));
+        if (!NIL_P(val)) src_y = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("width")));
+        if (!NIL_P(val)) width = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("height")));
+        if (!NIL_P(val)) height = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("x")));
+        if (!NIL_P(val)) x_off = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("y")));
+        if (!NIL_P(val)) y_off = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("composite")));
+        if (!NIL_P(val) && TYPE(val) == T_SYMBOL) {
+            if (rb_intern("overlay") == SYM2ID(val)) {
+                comp_rule = TK_PHOTO_COMPOSITE_OVERLAY;
+            }
+        }
+    }
+
+    if (src_x < 0 || src_y < 0) {
+        rb_raise(rb_eArgError, "source offsets must be non-negative");
+    }
+
+    src = Tk_FindPhoto(tip->interp, StringValueCStr(src_path));
+    if (!src) {
+        rb_raise(eTclError, "photo image not found: %s", StringValueCStr(src_path));
+    }
+    dst = Tk_FindPhoto(tip->interp, StringValueCStr(dst_path));
+    if (!dst) {
+        rb_raise(eTclError, "photo image not found: %s", StringValueCStr(dst_path));
+    }
+
+    if (!Tk_PhotoGetImage(src, &block)) {
+        rb_raise(eTclError, "failed to get photo image data");
+    }
+
+    /* Clamp the region to the source image */
+    if (width < 0 || src_x + width > block.width) width = block.width - src_x;
+    if (height < 0 || src_y + height > block.height) height = block.height - src_y;
+    if (width <= 0 || height <= 0) {
+        return rb_ary_new_from_args(2, INT2FIX(0), INT2FIX(0));
+    }
+
+    block.pixelPtr += src_y * block.pitch + src_x * block.pixelSize;
+    block.width = width;
+    block.height = height;
+
+    if (Tk_PhotoPutBlock(tip->interp, dst, &block, x_off, y_off,
+                         width, height, comp_rule) != TCL_OK) {
+        rb_raise(eTclError, "Tk_PhotoPutBlock failed: %s",
+                 Tcl_GetStringResult(tip->interp));
+    }
+
+    return rb_ary_new_from_args(2, INT2FIX(width), INT2FIX(height));
+}
+
 /* ---------------------------------------------------------
  * Interp#photo_get_pixel(photo_path, x, y)
  *
@@ -633,9 +1010,11 @@ Init_tkphoto(VALUE cInterp)
     rb_define_method(cInterp, "photo_put_block", interp_photo_put_block, -1);
     rb_define_method(cInterp, "photo_put_zoomed_block", interp_photo_put_zoomed_block, -1);
     rb_define_method(cInterp, "photo_get_image", interp_photo_get_image, -1);
+    rb_define_method(cInterp, "photo_read_into", interp_photo_read_into, -1);
     rb_define_method(cInterp, "photo_get_size", interp_photo_get_size, 1);
     rb_define_method(cInterp, "photo_set_size", interp_photo_set_size, 3);
     rb_define_method(cInterp, "photo_expand", interp_photo_expand, 3);
     rb_define_method(cInterp, "photo_get_pixel", interp_photo_get_pixel, 3);
+    rb_define_method(cInterp, "photo_copy_region", interp_photo_copy_region, -1);
     rb_define_method(cInterp, "photo_blank", interp_photo_blank, 1);
 }
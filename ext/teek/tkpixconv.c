@@ -0,0 +1,710 @@
+/* tkpixconv.c - Pixel format conversion kernels
+ *
+ * Converts packed pixel rows between RGBA/BGRA/ARGB/ABGR (4 bytes),
+ * RGB (3 bytes) and grayscale (1 byte), optionally premultiplying or
+ * unpremultiplying alpha on the way through. Formats are named by byte
+ * order in memory - see enum teek_pixfmt in tcltkbridge.h.
+ *
+ * The hot loops have SSE2 / SSSE3 / AVX2 (x86) and NEON (aarch64)
+ * variants; the best one the running CPU supports is picked once at
+ * load time (teek_pixconv_init), so a binary built on a generic target
+ * still uses AVX2 where it's available.
+ *
+ * Shared with teek-sdl2 (Pixels.convert) through the function pointer
+ * returned by Teek._pixel_convert_fn, the same way teek-sdl2 hands its
+ * event check function to Teek._register_event_source.
+ */
+
+#include "tcltkbridge.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIXCONV_X86 1
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define PIXCONV_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* Per-function ISA targeting, so the rest of the extension keeps its
+ * baseline flags and dispatch decides at runtime. MSVC doesn't need it
+ * (intrinsics are always available there). */
+#if defined(PIXCONV_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PIXCONV_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PIXCONV_TARGET(isa)
+#endif
+
+/* Pixels per pass through the RGBA staging buffer. 2KB on the stack,
+ * small enough to stay in L1 between the stages. */
+#define PIXCONV_CHUNK 512
+
+/* Byte position of R, G, B, A within each 4-byte format */
+static const int fmt_pos[4][4] = {
+    /* R  G  B  A */
+    {  0, 1, 2, 3 },  /* TEEK_PIXFMT_RGBA */
+    {  2, 1, 0, 3 },  /* TEEK_PIXFMT_BGRA */
+    {  1, 2, 3, 0 },  /* TEEK_PIXFMT_ARGB */
+    {  3, 2, 1, 0 },  /* TEEK_PIXFMT_ABGR */
+};
+
+typedef void (*permute_fn)(const uint8_t *src, uint8_t *dst, size_t n, const uint8_t idx[4]);
+typedef void (*rgb_to_rgba_fn)(const uint8_t *src, uint8_t *dst, size_t n);
+typedef void (*rgba_to_rgb_fn)(const uint8_t *src, uint8_t *dst, size_t n);
+typedef void (*gray_to_rgba_fn)(const uint8_t *src, uint8_t *dst, size_t n);
+typedef void (*rgba_to_gray_fn)(const uint8_t *src, uint8_t *dst, size_t n);
+typedef void (*premultiply_fn)(uint8_t *px, size_t n);
+
+/* ---------------------------------------------------------
+ * Scalar kernels (also used for the tails of the SIMD loops)
+ * --------------------------------------------------------- */
+
+static void
+permute_scalar(const uint8_t *src, uint8_t *dst, size_t n, const uint8_t idx[4])
+{
+    size_t i;
+    for (i = 0; i < n; i++) {
+        uint8_t p0 = src[0], p1 = src[1], p2 = src[2], p3 = src[3];
+        uint8_t px[4];
+        px[0] = p0; px[1] = p1; px[2] = p2; px[3] = p3;
+        dst[0] = px[idx[0]];
+        dst[1] = px[idx[1]];
+        dst[2] = px[idx[2]];
+        dst[3] = px[idx[3]];
+        src += 4;
+        dst += 4;
+    }
+}
+
+static void
+rgb_to_rgba_scalar(const uint8_t *src, uint8_t *dst, size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i++) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 255;
+        src += 3;
+        dst += 4;
+    }
+}
+
+static void
+rgba_to_rgb_scalar(const uint8_t *src, uint8_t *dst, size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i++) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        src += 4;
+        dst += 3;
+    }
+}
+
+static void
+gray_to_rgba_scalar(const uint8_t *src, uint8_t *dst, size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i++) {
+        dst[0] = dst[1] = dst[2] = src[i];
+        dst[3] = 255;
+        dst += 4;
+    }
+}
+
+/* BT.601 luma in 8.8 fixed point: (77 R + 150 G + 29 B + 128) >> 8.
+ * Weights sum to 256, so white stays 255 and the sum fits in 16 bits. */
+static void
+rgba_to_gray_scalar(const uint8_t *src, uint8_t *dst, size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i++) {
+        dst[i] = (uint8_t)((77 * src[0] + 150 * src[1] + 29 * src[2] + 128) >> 8);
+        src += 4;
+    }
+}
+
+/* c * a / 255, rounded, without a division */
+static inline uint8_t
+mul_div255(unsigned c, unsigned a)
+{
+    unsigned t = c * a + 128;
+    return (uint8_t)((t + (t >> 8)) >> 8);
+}
+
+static void
+premultiply_scalar(uint8_t *px, size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i++) {
+        unsigned a = px[3];
+        px[0] = mul_div255(px[0], a);
+        px[1] = mul_div255(px[1], a);
+        px[2] = mul_div255(px[2], a);
+        px += 4;
+    }
+}
+
+/* No SIMD variant: needs a per-pixel divide, and it only runs on the
+ * put path for callers that hand us premultiplied data. */
+static void
+unpremultiply_rgba(uint8_t *px, size_t n)
+{
+    size_t i;
+    for (i = 0; i < n; i++) {
+        unsigned a = px[3];
+        if (a == 255) {
+            /* opaque - nothing to undo */
+        } else if (a == 0) {
+            px[0] = px[1] = px[2] = 0;
+        } else {
+            unsigned half = a / 2, c;
+            c = (px[0] * 255u + half) / a; px[0] = (uint8_t)(c > 255 ? 255 : c);
+            c = (px[1] * 255u + half) / a; px[1] = (uint8_t)(c > 255 ? 255 : c);
+            c = (px[2] * 255u + half) / a; px[2] = (uint8_t)(c > 255 ? 255 : c);
+        }
+        px += 4;
+    }
+}
+
+/* ---------------------------------------------------------
+ * x86 kernels
+ * --------------------------------------------------------- */
+
+#ifdef PIXCONV_X86
+
+/* SSE2 has no byte shuffle, so each output byte is shifted into place
+ * within its 32-bit pixel lane and OR'd together. */
+PIXCONV_TARGET("sse2")
+static void
+permute_sse2(const uint8_t *src, uint8_t *dst, size_t n, const uint8_t idx[4])
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    __m128i rshift[4], lshift[4];
+    size_t i = 0;
+    int j;
+
+    for (j = 0; j < 4; j++) {
+        rshift[j] = _mm_cvtsi32_si128(8 * idx[j]);
+        lshift[j] = _mm_cvtsi32_si128(8 * j);
+    }
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i * 4));
+        __m128i out = _mm_setzero_si128();
+        for (j = 0; j < 4; j++) {
+            __m128i b = _mm_and_si128(_mm_srl_epi32(v, rshift[j]), mask);
+            out = _mm_or_si128(out, _mm_sll_epi32(b, lshift[j]));
+        }
+        _mm_storeu_si128((__m128i *)(dst + i * 4), out);
+    }
+    permute_scalar(src + i * 4, dst + i * 4, n - i, idx);
+}
+
+PIXCONV_TARGET("ssse3")
+static void
+permute_ssse3(const uint8_t *src, uint8_t *dst, size_t n, const uint8_t idx[4])
+{
+    __m128i shuf = _mm_setr_epi8(
+        idx[0],      idx[1],      idx[2],      idx[3],
+        4 + idx[0],  4 + idx[1],  4 + idx[2],  4 + idx[3],
+        8 + idx[0],  8 + idx[1],  8 + idx[2],  8 + idx[3],
+        12 + idx[0], 12 + idx[1], 12 + idx[2], 12 + idx[3]);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i * 4));
+        _mm_storeu_si128((__m128i *)(dst + i * 4), _mm_shuffle_epi8(v, shuf));
+    }
+    permute_scalar(src + i * 4, dst + i * 4, n - i, idx);
+}
+
+/* vpshufb shuffles within each 128-bit lane, which is exactly what we
+ * want - a pixel never straddles a lane. */
+PIXCONV_TARGET("avx2")
+static void
+permute_avx2(const uint8_t *src, uint8_t *dst, size_t n, const uint8_t idx[4])
+{
+    __m256i shuf = _mm256_setr_epi8(
+        idx[0],      idx[1],      idx[2],      idx[3],
+        4 + idx[0],  4 + idx[1],  4 + idx[2],  4 + idx[3],
+        8 + idx[0],  8 + idx[1],  8 + idx[2],  8 + idx[3],
+        12 + idx[0], 12 + idx[1], 12 + idx[2], 12 + idx[3],
+        idx[0],      idx[1],      idx[2],      idx[3],
+        4 + idx[0],  4 + idx[1],  4 + idx[2],  4 + idx[3],
+        8 + idx[0],  8 + idx[1],  8 + idx[2],  8 + idx[3],
+        12 + idx[0], 12 + idx[1], 12 + idx[2], 12 + idx[3]);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + i * 4));
+        _mm256_storeu_si256((__m256i *)(dst + i * 4), _mm256_shuffle_epi8(v, shuf));
+    }
+    permute_scalar(src + i * 4, dst + i * 4, n - i, idx);
+}
+
+/* 4 pixels per step from a 16-byte load of 12 RGB bytes. The load
+ * over-reads 4 bytes, so stop while at least 6 pixels (18 bytes) remain. */
+PIXCONV_TARGET("ssse3")
+static void
+rgb_to_rgba_ssse3(const uint8_t *src, uint8_t *dst, size_t n)
+{
+    const __m128i shuf = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1,
+                                       6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    size_t i = 0;
+
+    for (; i + 6 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i * 3));
+        v = _mm_or_si128(_mm_shuffle_epi8(v, shuf), alpha);
+        _mm_storeu_si128((__m128i *)(dst + i * 4), v);
+    }
+    rgb_to_rgba_scalar(src + i * 3, dst + i * 4, n - i);
+}
+
+PIXCONV_TARGET("ssse3")
+static void
+rgba_to_rgb_ssse3(const uint8_t *src, uint8_t *dst, size_t n)
+{
+    const __m128i shuf = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9,
+                                       10, 12, 13, 14, -1, -1, -1, -1);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i * 4));
+        uint32_t tail;
+        v = _mm_shuffle_epi8(v, shuf);
+        /* 12 bytes out: 8 + 4, so nothing past the row is touched */
+        _mm_storel_epi64((__m128i *)(dst + i * 3), v);
+        tail = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+        memcpy(dst + i * 3 + 8, &tail, 4);
+    }
+    rgba_to_rgb_scalar(src + i * 4, dst + i * 3, n - i);
+}
+
+PIXCONV_TARGET("sse2")
+static void
+gray_to_rgba_sse2(const uint8_t *src, uint8_t *dst, size_t n)
+{
+    const __m128i ff = _mm_set1_epi8((char)0xFF);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i g = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i gg_lo = _mm_unpacklo_epi8(g, g);   /* g g pairs */
+        __m128i gg_hi = _mm_unpackhi_epi8(g, g);
+        __m128i ga_lo = _mm_unpacklo_epi8(g, ff);  /* g FF pairs */
+        __m128i ga_hi = _mm_unpackhi_epi8(g, ff);
+        uint8_t *d = dst + i * 4;
+        _mm_storeu_si128((__m128i *)(d +  0), _mm_unpacklo_epi16(gg_lo, ga_lo));
+        _mm_storeu_si128((__m128i *)(d + 16), _mm_unpackhi_epi16(gg_lo, ga_lo));
+        _mm_storeu_si128((__m128i *)(d + 32), _mm_unpacklo_epi16(gg_hi, ga_hi));
+        _mm_storeu_si128((__m128i *)(d + 48), _mm_unpackhi_epi16(gg_hi, ga_hi));
+    }
+    gray_to_rgba_scalar(src + i, dst + i * 4, n - i);
+}
+
+/* Same fixed-point luma as the scalar path. The weighted sum fits in an
+ * unsigned 16-bit lane (max 65408), so mullo + logical shift is exact. */
+PIXCONV_TARGET("sse2")
+static void
+rgba_to_gray_sse2(const uint8_t *src, uint8_t *dst, size_t n)
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i wr = _mm_set1_epi16(77);
+    const __m128i wg = _mm_set1_epi16(150);
+    const __m128i wb = _mm_set1_epi16(29);
+    const __m128i round = _mm_set1_epi16(128);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + i * 4));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + i * 4 + 16));
+        __m128i r16 = _mm_packs_epi32(_mm_and_si128(a, mask),
+                                      _mm_and_si128(b, mask));
+        __m128i g16 = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 8), mask),
+                                      _mm_and_si128(_mm_srli_epi32(b, 8), mask));
+        __m128i b16 = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 16), mask),
+                                      _mm_and_si128(_mm_srli_epi32(b, 16), mask));
+        __m128i y = _mm_add_epi16(_mm_mullo_epi16(r16, wr), _mm_mullo_epi16(g16, wg));
+        y = _mm_add_epi16(y, _mm_mullo_epi16(b16, wb));
+        y = _mm_srli_epi16(_mm_add_epi16(y, round), 8);
+        _mm_storel_epi64((__m128i *)(dst + i), _mm_packus_epi16(y, y));
+    }
+    rgba_to_gray_scalar(src + i * 4, dst + i, n - i);
+}
+
+/* Two pixels per 16-bit half. The alpha lane's multiplier is forced to
+ * 255 so alpha itself comes out unchanged. */
+PIXCONV_TARGET("sse2")
+static void
+premultiply_sse2(uint8_t *px, size_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgb_mask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+    const __m128i alpha_255 = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+    const __m128i round = _mm_set1_epi16(128);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(px + i * 4));
+        __m128i halves[2];
+        int h;
+
+        halves[0] = _mm_unpacklo_epi8(v, zero);
+        halves[1] = _mm_unpackhi_epi8(v, zero);
+        for (h = 0; h < 2; h++) {
+            __m128i c = halves[h];
+            __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3)),
+                                            _MM_SHUFFLE(3, 3, 3, 3));
+            __m128i t;
+            a = _mm_or_si128(_mm_and_si128(a, rgb_mask), alpha_255);
+            t = _mm_add_epi16(_mm_mullo_epi16(c, a), round);
+            halves[h] = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+        }
+        _mm_storeu_si128((__m128i *)(px + i * 4), _mm_packus_epi16(halves[0], halves[1]));
+    }
+    premultiply_scalar(px + i * 4, n - i);
+}
+
+#endif /* PIXCONV_X86 */
+
+/* ---------------------------------------------------------
+ * NEON kernels (aarch64 - NEON is mandatory there)
+ * --------------------------------------------------------- */
+
+#ifdef PIXCONV_NEON
+
+static void
+permute_neon(const uint8_t *src, uint8_t *dst, size_t n, const uint8_t idx[4])
+{
+    uint8_t tbl_bytes[16];
+    uint8x16_t tbl;
+    size_t i = 0;
+    int p, j;
+
+    for (p = 0; p < 4; p++) {
+        for (j = 0; j < 4; j++) tbl_bytes[p * 4 + j] = (uint8_t)(p * 4 + idx[j]);
+    }
+    tbl = vld1q_u8(tbl_bytes);
+
+    for (; i + 4 <= n; i += 4) {
+        vst1q_u8(dst + i * 4, vqtbl1q_u8(vld1q_u8(src + i * 4), tbl));
+    }
+    permute_scalar(src + i * 4, dst + i * 4, n - i, idx);
+}
+
+/* vld3/vst4 de/interleave 16 pixels at a time */
+static void
+rgb_to_rgba_neon(const uint8_t *src, uint8_t *dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16x3_t rgb = vld3q_u8(src + i * 3);
+        uint8x16x4_t rgba;
+        rgba.val[0] = rgb.val[0];
+        rgba.val[1] = rgb.val[1];
+        rgba.val[2] = rgb.val[2];
+        rgba.val[3] = vdupq_n_u8(255);
+        vst4q_u8(dst + i * 4, rgba);
+    }
+    rgb_to_rgba_scalar(src + i * 3, dst + i * 4, n - i);
+}
+
+static void
+rgba_to_rgb_neon(const uint8_t *src, uint8_t *dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16x4_t rgba = vld4q_u8(src + i * 4);
+        uint8x16x3_t rgb;
+        rgb.val[0] = rgba.val[0];
+        rgb.val[1] = rgba.val[1];
+        rgb.val[2] = rgba.val[2];
+        vst3q_u8(dst + i * 3, rgb);
+    }
+    rgba_to_rgb_scalar(src + i * 4, dst + i * 3, n - i);
+}
+
+static void
+gray_to_rgba_neon(const uint8_t *src, uint8_t *dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t g = vld1q_u8(src + i);
+        uint8x16x4_t rgba;
+        rgba.val[0] = g;
+        rgba.val[1] = g;
+        rgba.val[2] = g;
+        rgba.val[3] = vdupq_n_u8(255);
+        vst4q_u8(dst + i * 4, rgba);
+    }
+    gray_to_rgba_scalar(src + i, dst + i * 4, n - i);
+}
+
+static void
+rgba_to_gray_neon(const uint8_t *src, uint8_t *dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint8x8x4_t rgba = vld4_u8(src + i * 4);
+        uint16x8_t y = vmull_u8(rgba.val[0], vdup_n_u8(77));
+        y = vmlal_u8(y, rgba.val[1], vdup_n_u8(150));
+        y = vmlal_u8(y, rgba.val[2], vdup_n_u8(29));
+        vst1_u8(dst + i, vrshrn_n_u16(y, 8));
+    }
+    rgba_to_gray_scalar(src + i * 4, dst + i, n - i);
+}
+
+static void
+premultiply_neon(uint8_t *px, size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint8x8x4_t v = vld4_u8(px + i * 4);
+        int c;
+        for (c = 0; c < 3; c++) {
+            uint16x8_t t = vmull_u8(v.val[c], v.val[3]);
+            /* (t + 128 + ((t + 128) >> 8)) >> 8, same as mul_div255 */
+            v.val[c] = vraddhn_u16(t, vrshrq_n_u16(t, 8));
+        }
+        vst4_u8(px + i * 4, v);
+    }
+    premultiply_scalar(px + i * 4, n - i);
+}
+
+#endif /* PIXCONV_NEON */
+
+/* ---------------------------------------------------------
+ * Dispatch
+ * --------------------------------------------------------- */
+
+/* x86 feature check, also used by tkresample.c's dispatch.
+ * feature is "sse2", "ssse3" or "avx2"; always 0 off x86. */
+int
+teek_cpu_has(const char *feature)
+{
+#ifdef PIXCONV_X86
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    if (strcmp(feature, "avx2") == 0) return __builtin_cpu_supports("avx2");
+    if (strcmp(feature, "ssse3") == 0) return __builtin_cpu_supports("ssse3");
+    if (strcmp(feature, "sse2") == 0) return __builtin_cpu_supports("sse2");
+    return 0;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    if (strcmp(feature, "sse2") == 0) return (info[3] >> 26) & 1;
+    if (strcmp(feature, "ssse3") == 0) return (info[2] >> 9) & 1;
+    if (strcmp(feature, "avx2") == 0) {
+        /* AVX2 needs OS-enabled YMM state (OSXSAVE + XCR0) as well */
+        if (!((info[2] >> 27) & 1) || (_xgetbv(0) & 6) != 6) return 0;
+        __cpuidex(info, 7, 0);
+        return (info[1] >> 5) & 1;
+    }
+    return 0;
+#else
+    return 0;
+#endif
+#else
+    (void)feature;
+    return 0;
+#endif /* PIXCONV_X86 */
+}
+
+static permute_fn k_permute = permute_scalar;
+static rgb_to_rgba_fn k_rgb_to_rgba = rgb_to_rgba_scalar;
+static rgba_to_rgb_fn k_rgba_to_rgb = rgba_to_rgb_scalar;
+static gray_to_rgba_fn k_gray_to_rgba = gray_to_rgba_scalar;
+static rgba_to_gray_fn k_rgba_to_gray = rgba_to_gray_scalar;
+static premultiply_fn k_premultiply = premultiply_scalar;
+static const char *k_impl = "scalar";
+
+void
+teek_pixconv_init(void)
+{
+#ifdef PIXCONV_X86
+    if (teek_cpu_has("sse2")) {
+        k_permute = permute_sse2;
+        k_gray_to_rgba = gray_to_rgba_sse2;
+        k_rgba_to_gray = rgba_to_gray_sse2;
+        k_premultiply = premultiply_sse2;
+        k_impl = "sse2";
+    }
+    if (teek_cpu_has("ssse3")) {
+        k_permute = permute_ssse3;
+        k_rgb_to_rgba = rgb_to_rgba_ssse3;
+        k_rgba_to_rgb = rgba_to_rgb_ssse3;
+        k_impl = "ssse3";
+    }
+    if (teek_cpu_has("avx2")) {
+        k_permute = permute_avx2;
+        k_impl = "avx2";
+    }
+#endif
+#ifdef PIXCONV_NEON
+    k_permute = permute_neon;
+    k_rgb_to_rgba = rgb_to_rgba_neon;
+    k_rgba_to_rgb = rgba_to_rgb_neon;
+    k_gray_to_rgba = gray_to_rgba_neon;
+    k_rgba_to_gray = rgba_to_gray_neon;
+    k_premultiply = premultiply_neon;
+    k_impl = "neon";
+#endif
+}
+
+const char *
+teek_pixconv_impl(void)
+{
+    return k_impl;
+}
+
+int
+teek_pixfmt_bytes(int fmt)
+{
+    switch (fmt) {
+    case TEEK_PIXFMT_RGBA:
+    case TEEK_PIXFMT_BGRA:
+    case TEEK_PIXFMT_ARGB:
+    case TEEK_PIXFMT_ABGR:
+        return 4;
+    case TEEK_PIXFMT_RGB:
+        return 3;
+    case TEEK_PIXFMT_GRAY:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* idx[dst byte] = src byte, for a 4-byte -> 4-byte reorder */
+static void
+permute_index(int src_fmt, int dst_fmt, uint8_t idx[4])
+{
+    int c;
+    for (c = 0; c < 4; c++) {
+        idx[fmt_pos[dst_fmt][c]] = (uint8_t)fmt_pos[src_fmt][c];
+    }
+}
+
+/*
+ * teek_pixconv - convert npixels packed pixels from src_fmt to dst_fmt.
+ *
+ * flags: TEEK_PIXCONV_PREMULTIPLY or TEEK_PIXCONV_UNPREMULTIPLY (not both).
+ * src and dst may be the same buffer when both formats are 4 bytes.
+ *
+ * Returns 0 on success, -1 for an unknown format or invalid flags.
+ */
+int
+teek_pixconv(const unsigned char *src, int src_fmt,
+             unsigned char *dst, int dst_fmt,
+             size_t npixels, int flags)
+{
+    int src_bytes = teek_pixfmt_bytes(src_fmt);
+    int dst_bytes = teek_pixfmt_bytes(dst_fmt);
+    uint8_t to_rgba[4], from_rgba[4];
+    uint8_t stage[PIXCONV_CHUNK * 4];
+    size_t done;
+
+    if (!src_bytes || !dst_bytes) return -1;
+    if ((flags & TEEK_PIXCONV_PREMULTIPLY) && (flags & TEEK_PIXCONV_UNPREMULTIPLY)) return -1;
+
+    /* Straight reorder (or copy) needs no staging */
+    if (!(flags & (TEEK_PIXCONV_PREMULTIPLY | TEEK_PIXCONV_UNPREMULTIPLY))) {
+        if (src_fmt == dst_fmt) {
+            if (src != dst) memmove(dst, src, npixels * src_bytes);
+            return 0;
+        }
+        if (src_bytes == 4 && dst_bytes == 4) {
+            permute_index(src_fmt, dst_fmt, to_rgba);
+            k_permute(src, dst, npixels, to_rgba);
+            return 0;
+        }
+        if (src_fmt == TEEK_PIXFMT_RGBA && dst_fmt == TEEK_PIXFMT_RGB) {
+            k_rgba_to_rgb(src, dst, npixels);
+            return 0;
+        }
+        if (src_fmt == TEEK_PIXFMT_RGB && dst_fmt == TEEK_PIXFMT_RGBA) {
+            k_rgb_to_rgba(src, dst, npixels);
+            return 0;
+        }
+        if (src_fmt == TEEK_PIXFMT_RGBA && dst_fmt == TEEK_PIXFMT_GRAY) {
+            k_rgba_to_gray(src, dst, npixels);
+            return 0;
+        }
+        if (src_fmt == TEEK_PIXFMT_GRAY && dst_fmt == TEEK_PIXFMT_RGBA) {
+            k_gray_to_rgba(src, dst, npixels);
+            return 0;
+        }
+    }
+
+    /* General case: src -> RGBA staging chunk -> alpha op -> dst */
+    if (src_bytes == 4) permute_index(src_fmt, TEEK_PIXFMT_RGBA, to_rgba);
+    if (dst_bytes == 4) permute_index(TEEK_PIXFMT_RGBA, dst_fmt, from_rgba);
+
+    for (done = 0; done < npixels; done += PIXCONV_CHUNK) {
+        size_t n = npixels - done;
+        const uint8_t *s = src + done * src_bytes;
+        uint8_t *d = dst + done * dst_bytes;
+        if (n > PIXCONV_CHUNK) n = PIXCONV_CHUNK;
+
+        switch (src_bytes) {
+        case 4: k_permute(s, stage, n, to_rgba); break;
+        case 3: k_rgb_to_rgba(s, stage, n); break;
+        default: k_gray_to_rgba(s, stage, n); break;
+        }
+
+        if (flags & TEEK_PIXCONV_PREMULTIPLY) k_premultiply(stage, n);
+        if (flags & TEEK_PIXCONV_UNPREMULTIPLY) unpremultiply_rgba(stage, n);
+
+        switch (dst_bytes) {
+        case 4: k_permute(stage, d, n, from_rgba); break;
+        case 3: k_rgba_to_rgb(stage, d, n); break;
+        default: k_rgba_to_gray(stage, d, n); break;
+        }
+    }
+    return 0;
+}
+
+/* ---------------------------------------------------------
+ * Teek._pixel_convert_fn -> Integer
+ *
+ * Address of teek_pixconv (signature teek_pixconv_fn), for other C
+ * extensions to call directly - see teek-sdl2's Pixels.convert.
+ *
+ * Teek.pixel_convert_impl -> String
+ *
+ * Which kernel set was selected for this CPU: "avx2", "ssse3", "sse2",
+ * "neon" or "scalar". For benchmarks and bug reports.
+ * --------------------------------------------------------- */
+
+static VALUE
+teek_pixel_convert_fn(VALUE self)
+{
+    return ULL2NUM((uintptr_t)teek_pixconv);
+}
+
+static VALUE
+teek_pixel_convert_impl(VALUE self)
+{
+    return rb_str_new_cstr(k_impl);
+}
+
+void
+Init_tkpixconv(VALUE mTeek)
+{
+    teek_pixconv_init();
+
+    rb_define_module_function(mTeek, "_pixel_convert_fn", teek_pixel_convert_fn, 0);
+    rb_define_module_function(mTeek, "pixel_convert_impl", teek_pixel_convert_impl, 0);
+}
@@ -0,0 +1,783 @@
+/* tkresample.c - Photo image resampling
+ *
+ * Scales a region of one photo into another at any ratio, with
+ * nearest, bilinear or area-average (box) filtering. Tk's own scaling
+ * (Tk_PhotoPutZoomedBlock, `$photo copy -zoom/-subsample`) only does
+ * integer factors.
+ *
+ * Bilinear and area share one separable fixed-point engine: each
+ * destination pixel is a weighted sum of a fixed number of source
+ * taps per axis. A horizontal pass turns source rows into 16-bit
+ * intermediate rows, and a vertical pass blends those into output
+ * bytes. Both inner loops are pmaddwd-shaped - two taps times two
+ * weights per 32-bit lane - with SSE2/AVX2/NEON versions picked at
+ * load time (same scheme as tkpixconv.c).
+ *
+ * Work is split into bands of destination rows across Tcl threads,
+ * computed with the GVL released, and the result goes to the
+ * destination photo with one Tk_PhotoPutBlock.
+ */
+
+#include "tcltkbridge.h"
+#include <ruby/thread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RESAMPLE_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define RESAMPLE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(RESAMPLE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define RESAMPLE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define RESAMPLE_TARGET(isa)
+#endif
+
+/* Weights are 2.14 fixed point and sum to 1 << WEIGHT_BITS per pixel.
+ * Intermediate rows hold 8.7 fixed-point channel values (max 255 << 7),
+ * which keeps them - and the weights - inside signed 16 bits for pmaddwd,
+ * and every vertical sum inside signed 32 bits. */
+#define WEIGHT_BITS 14
+#define WEIGHT_ONE  (1 << WEIGHT_BITS)
+#define INTER_BITS  7
+
+/* Below this many destination pixels, threads cost more than they save */
+#define RESAMPLE_MIN_PIXELS_PER_THREAD (128 * 128)
+#define RESAMPLE_MAX_THREADS 16
+
+/* Caps the :area reduction ratio at roughly 500:1 per axis */
+#define RESAMPLE_MAX_TAPS 512
+
+enum resample_filter {
+    FILTER_NEAREST,
+    FILTER_BILINEAR,
+    FILTER_AREA
+};
+
+/* Per-axis tap table: destination pixel i reads source pixels
+ * index[i * taps + k] with weight[i * taps + k]. Every pixel has the
+ * same tap count; unused taps have weight 0 and a valid index. */
+struct axis_taps {
+    int taps;
+    int *index;
+    int16_t *weight;
+};
+
+struct resample_job {
+    /* Source: packed RGBA rows */
+    const unsigned char *src;
+    int src_pitch;
+    int src_w, src_h;
+
+    /* Destination buffer: packed RGBA, dst_w * 4 bytes per row */
+    unsigned char *dst;
+    int dst_w, dst_h;
+
+    int filter;
+    struct axis_taps xt, yt;
+    int nthreads;
+    int failed;
+};
+
+struct resample_band {
+    struct resample_job *job;
+    int y_start, y_end;
+    int failed;
+};
+
+/* ---------------------------------------------------------
+ * Tap tables
+ * --------------------------------------------------------- */
+
+static void
+axis_taps_free(struct axis_taps *t)
+{
+    free(t->index);
+    free(t->weight);
+    t->index = NULL;
+    t->weight = NULL;
+}
+
+/* Scale weights (doubles summing to ~1) to fixed point summing to
+ * exactly WEIGHT_ONE, putting the rounding slack on the largest. */
+static void
+fix_weights(const double *w, int n, int16_t *out)
+{
+    int k, sum = 0, big = 0;
+    for (k = 0; k < n; k++) {
+        out[k] = (int16_t)(w[k] * WEIGHT_ONE + 0.5);
+        sum += out[k];
+        if (out[k] > out[big]) big = k;
+    }
+    out[big] = (int16_t)(out[big] + (WEIGHT_ONE - sum));
+}
+
+/* Returns 1 on success, 0 when out of memory, -1 when the ratio needs
+ * more than RESAMPLE_MAX_TAPS taps. */
+static int
+axis_taps_build(struct axis_taps *t, int filter, int src_len, int dst_len)
+{
+    double scale = (double)src_len / dst_len;
+    double w[RESAMPLE_MAX_TAPS];
+    int i, k;
+
+    if (filter == FILTER_NEAREST) {
+        t->taps = 1;
+    } else if (filter == FILTER_BILINEAR) {
+        t->taps = 2;
+    } else {
+        /* A box of width `scale` touches at most ceil(scale) + 1 pixels */
+        t->taps = (int)(scale + 0.999999) + 1;
+        if (t->taps < 2) t->taps = 2;
+        if (t->taps > RESAMPLE_MAX_TAPS - 1) return -1;
+    }
+    /* Pairs of taps feed pmaddwd, so round up to an even count */
+    if (t->taps > 1 && (t->taps & 1)) t->taps++;
+
+    t->index = malloc(sizeof(int) * (size_t)dst_len * t->taps);
+    t->weight = malloc(sizeof(int16_t) * (size_t)dst_len * t->taps);
+    if (!t->index || !t->weight) {
+        axis_taps_free(t);
+        return 0;
+    }
+
+    for (i = 0; i < dst_len; i++) {
+        int *idx = t->index + (size_t)i * t->taps;
+        int16_t *wt = t->weight + (size_t)i * t->taps;
+        int first;
+
+        memset(w, 0, sizeof(double) * t->taps);
+
+        if (filter == FILTER_NEAREST) {
+            int s = (int)((i + 0.5) * scale);
+            idx[0] = s < src_len ? s : src_len - 1;
+            wt[0] = WEIGHT_ONE;
+            continue;
+        } else if (filter == FILTER_BILINEAR) {
+            /* Pixel centers line up: dst center i+0.5 maps to src (i+0.5)*scale */
+            double sx = (i + 0.5) * scale - 0.5;
+            double f;
+            if (sx < 0) sx = 0;
+            first = (int)sx;
+            f = sx - first;
+            if (first >= src_len - 1) {
+                first = src_len - 1;
+                f = 0;
+            }
+            w[0] = 1.0 - f;
+            w[1] = f;
+        } else {
+            double start = i * scale, end = (i + 1) * scale;
+            int n = 0;
+            first = (int)start;
+            for (k = 0; k < t->taps && first + k < src_len; k++) {
+                double lo = first + k > start ? first + k : start;
+                double hi = first + k + 1 < end ? first + k + 1 : end;
+                if (hi <= lo) break;
+                w[k] = (hi - lo) / scale;
+                n = k + 1;
+            }
+            if (n == 0) w[0] = 1.0;
+        }
+
+        fix_weights(w, t->taps, wt);
+        for (k = 0; k < t->taps; k++) {
+            int s = first + k;
+            idx[k] = s < src_len ? s : src_len - 1;
+        }
+    }
+    return 1;
+}
+
+/* ---------------------------------------------------------
+ * Kernels
+ *
+ * hpass: one source row -> dst_w * 4 intermediate values
+ *   inter[x*4 + c] = (sum_k w[k] * src[idx[k]*4 + c] + round) >> (14 - 7)
+ * vpass: taps intermediate rows -> dst_w * 4 output bytes, for i in [i0, n)
+ *   out[i] = clamp((sum_k w[k] * rows[k][i] + round) >> (14 + 7))
+ * --------------------------------------------------------- */
+
+#define HPASS_SHIFT (WEIGHT_BITS - INTER_BITS)
+#define VPASS_SHIFT (WEIGHT_BITS + INTER_BITS)
+
+typedef void (*hpass_fn)(const unsigned char *src, int16_t *out, int dst_w,
+                         const struct axis_taps *xt);
+typedef void (*vpass_fn)(int16_t *const *rows, const int16_t *w, int taps,
+                         unsigned char *out, int i0, int n);
+
+static void
+hpass_scalar(const unsigned char *src, int16_t *out, int dst_w, const struct axis_taps *xt)
+{
+    int x, k, taps = xt->taps;
+    for (x = 0; x < dst_w; x++) {
+        const int *idx = xt->index + (size_t)x * taps;
+        const int16_t *wt = xt->weight + (size_t)x * taps;
+        int32_t r = 0, g = 0, b = 0, a = 0;
+        for (k = 0; k < taps; k++) {
+            const unsigned char *p = src + (size_t)idx[k] * 4;
+            r += wt[k] * p[0];
+            g += wt[k] * p[1];
+            b += wt[k] * p[2];
+            a += wt[k] * p[3];
+        }
+        out[0] = (int16_t)((r + (1 << (HPASS_SHIFT - 1))) >> HPASS_SHIFT);
+        out[1] = (int16_t)((g + (1 << (HPASS_SHIFT - 1))) >> HPASS_SHIFT);
+        out[2] = (int16_t)((b + (1 << (HPASS_SHIFT - 1))) >> HPASS_SHIFT);
+        out[3] = (int16_t)((a + (1 << (HPASS_SHIFT - 1))) >> HPASS_SHIFT);
+        out += 4;
+    }
+}
+
+static void
+vpass_scalar(int16_t *const *rows, const int16_t *w, int taps, unsigned char *out, int i0, int n)
+{
+    int i, k;
+    for (i = i0; i < n; i++) {
+        int32_t acc = 1 << (VPASS_SHIFT - 1);
+        for (k = 0; k < taps; k++) acc += w[k] * rows[k][i];
+        acc >>= VPASS_SHIFT;
+        out[i] = (unsigned char)(acc < 0 ? 0 : acc > 255 ? 255 : acc);
+    }
+}
+
+#ifdef RESAMPLE_X86
+
+/* Two taps per pmaddwd: interleave the taps' channels as
+ * [r0 r1 g0 g1 b0 b1 a0 a1] and multiply by [w0 w1] x 4. */
+RESAMPLE_TARGET("sse2")
+static void
+hpass_sse2(const unsigned char *src, int16_t *out, int dst_w, const struct axis_taps *xt)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (HPASS_SHIFT - 1));
+    int x, k, taps = xt->taps;
+
+    for (x = 0; x < dst_w; x++) {
+        const int *idx = xt->index + (size_t)x * taps;
+        const int16_t *wt = xt->weight + (size_t)x * taps;
+        __m128i acc = round;
+        for (k = 0; k < taps; k += 2) {
+            int v0, v1;
+            __m128i px, w;
+            memcpy(&v0, src + (size_t)idx[k] * 4, 4);
+            memcpy(&v1, src + (size_t)idx[k + 1] * 4, 4);
+            px = _mm_unpacklo_epi8(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v0),
+                                                     _mm_cvtsi32_si128(v1)), zero);
+            w = _mm_set1_epi32((int)(((uint32_t)(uint16_t)wt[k + 1] << 16) |
+                                     (uint16_t)wt[k]));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(px, w));
+        }
+        acc = _mm_srai_epi32(acc, HPASS_SHIFT);
+        _mm_storel_epi64((__m128i *)out, _mm_packs_epi32(acc, acc));
+        out += 4;
+    }
+}
+
+RESAMPLE_TARGET("sse2")
+static void
+vpass_sse2(int16_t *const *rows, const int16_t *w, int taps, unsigned char *out, int i0, int n)
+{
+    const __m128i round = _mm_set1_epi32(1 << (VPASS_SHIFT - 1));
+    int i = i0, k;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i lo = round, hi = round;
+        for (k = 0; k < taps; k += 2) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(rows[k] + i));
+            __m128i b = _mm_loadu_si128((const __m128i *)(rows[k + 1] + i));
+            __m128i wv = _mm_set1_epi32((int)(((uint32_t)(uint16_t)w[k + 1] << 16) |
+                                              (uint16_t)w[k]));
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), wv));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), wv));
+        }
+        lo = _mm_srai_epi32(lo, VPASS_SHIFT);
+        hi = _mm_srai_epi32(hi, VPASS_SHIFT);
+        lo = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64((__m128i *)(out + i), _mm_packus_epi16(lo, lo));
+    }
+    vpass_scalar(rows, w, taps, out, i, n);
+}
+
+/* Same as vpass_sse2, 16 values per step. The in-lane unpack/pack
+ * pairs restore element order; only the final byte pack needs a
+ * cross-lane permute. */
+RESAMPLE_TARGET("avx2")
+static void
+vpass_avx2(int16_t *const *rows, const int16_t *w, int taps, unsigned char *out, int i0, int n)
+{
+    const __m256i round = _mm256_set1_epi32(1 << (VPASS_SHIFT - 1));
+    int i = i0, k;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256i lo = round, hi = round, packed;
+        for (k = 0; k < taps; k += 2) {
+            __m256i a = _mm256_loadu_si256((const __m256i *)(rows[k] + i));
+            __m256i b = _mm256_loadu_si256((const __m256i *)(rows[k + 1] + i));
+            __m256i wv = _mm256_set1_epi32((int)(((uint32_t)(uint16_t)w[k + 1] << 16) |
+                                                 (uint16_t)w[k]));
+            lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), wv));
+            hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), wv));
+        }
+        lo = _mm256_srai_epi32(lo, VPASS_SHIFT);
+        hi = _mm256_srai_epi32(hi, VPASS_SHIFT);
+        packed = _mm256_packus_epi16(_mm256_packs_epi32(lo, hi), _mm256_setzero_si256());
+        packed = _mm256_permute4x64_epi64(packed, 0x08);
+        _mm_storeu_si128((__m128i *)(out + i), _mm256_castsi256_si128(packed));
+    }
+    vpass_sse2(rows, w, taps, out, i, n);
+}
+
+#endif /* RESAMPLE_X86 */
+
+#ifdef RESAMPLE_NEON
+
+static void
+hpass_neon(const unsigned char *src, int16_t *out, int dst_w, const struct axis_taps *xt)
+{
+    int x, k, taps = xt->taps;
+
+    for (x = 0; x < dst_w; x++) {
+        const int *idx = xt->index + (size_t)x * taps;
+        const int16_t *wt = xt->weight + (size_t)x * taps;
+        int32x4_t acc = vdupq_n_s32(0);
+        for (k = 0; k < taps; k++) {
+            uint32_t v;
+            int16x4_t px;
+            memcpy(&v, src + (size_t)idx[k] * 4, 4);
+            px = vget_low_s16(vreinterpretq_s16_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(v)))));
+            acc = vmlal_n_s16(acc, px, wt[k]);
+        }
+        vst1_s16(out, vrshrn_n_s32(acc, HPASS_SHIFT));
+        out += 4;
+    }
+}
+
+static void
+vpass_neon(int16_t *const *rows, const int16_t *w, int taps, unsigned char *out, int i0, int n)
+{
+    const int32x4_t round = vdupq_n_s32(1 << (VPASS_SHIFT - 1));
+    int i = i0, k;
+
+    for (; i + 8 <= n; i += 8) {
+        int32x4_t lo = round, hi = round;
+        for (k = 0; k < taps; k++) {
+            int16x8_t v = vld1q_s16(rows[k] + i);
+            lo = vmlal_n_s16(lo, vget_low_s16(v), w[k]);
+            hi = vmlal_n_s16(hi, vget_high_s16(v), w[k]);
+        }
+        lo = vshrq_n_s32(lo, VPASS_SHIFT);
+        hi = vshrq_n_s32(hi, VPASS_SHIFT);
+        vst1_u8(out + i, vqmovun_s16(vcombine_s16(vmovn_s32(lo), vmovn_s32(hi))));
+    }
+    vpass_scalar(rows, w, taps, out, i, n);
+}
+
+#endif /* RESAMPLE_NEON */
+
+static hpass_fn k_hpass = hpass_scalar;
+static vpass_fn k_vpass = vpass_scalar;
+
+static void
+resample_init_kernels(void)
+{
+#ifdef RESAMPLE_X86
+    if (teek_cpu_has("sse2")) {
+        k_hpass = hpass_sse2;
+        k_vpass = vpass_sse2;
+    }
+    if (teek_cpu_has("avx2")) {
+        k_vpass = vpass_avx2;
+    }
+#endif
+#ifdef RESAMPLE_NEON
+    k_hpass = hpass_neon;
+    k_vpass = vpass_neon;
+#endif
+}
+
+/* ---------------------------------------------------------
+ * Band worker
+ * --------------------------------------------------------- */
+
+static void
+resample_nearest_band(struct resample_job *job, int y0, int y1)
+{
+    int x, y;
+    for (y = y0; y < y1; y++) {
+        const unsigned char *srow = job->src + (size_t)job->yt.index[y] * job->src_pitch;
+        uint32_t *drow = (uint32_t *)(job->dst + (size_t)y * job->dst_w * 4);
+        for (x = 0; x < job->dst_w; x++) {
+            memcpy(&drow[x], srow + (size_t)job->xt.index[x] * 4, 4);
+        }
+    }
+}
+
+/* Intermediate rows are cached by source row, since consecutive
+ * destination rows share taps (always when upscaling). Rows are
+ * visited in increasing order, so the slot holding the lowest source
+ * row is always the one to evict. */
+static int
+resample_filtered_band(struct resample_job *job, int y0, int y1)
+{
+    int taps = job->yt.taps;
+    int nslots = taps + 1;
+    size_t row_vals = (size_t)job->dst_w * 4;
+    int16_t *cache = malloc(sizeof(int16_t) * row_vals * nslots);
+    int *cache_src = malloc(sizeof(int) * nslots);
+    int16_t **rows = malloc(sizeof(int16_t *) * taps);
+    int y, k, s;
+
+    if (!cache || !cache_src || !rows) {
+        free(cache);
+        free(cache_src);
+        free(rows);
+        return 0;
+    }
+    for (s = 0; s < nslots; s++) cache_src[s] = -1;
+
+    for (y = y0; y < y1; y++) {
+        const int *idx = job->yt.index + (size_t)y * taps;
+        const int16_t *wt = job->yt.weight + (size_t)y * taps;
+
+        for (k = 0; k < taps; k++) {
+            int slot = -1, victim = 0;
+            for (s = 0; s < nslots; s++) {
+                if (cache_src[s] == idx[k]) {
+                    slot = s;
+                    break;
+                }
+                if (cache_src[s] < cache_src[victim]) victim = s;
+            }
+            if (slot < 0) {
+                /* Don't evict a row this destination row already claimed */
+                int j, in_use;
+                do {
+                    in_use = 0;
+                    for (j = 0; j < k; j++) {
+                        if (rows[j] == cache + row_vals * victim) in_use = 1;
+                    }
+                    if (in_use) victim = (victim + 1) % nslots;
+                } while (in_use);
+                slot = victim;
+                cache_src[slot] = idx[k];
+                k_hpass(job->src + (size_t)idx[k] * job->src_pitch,
+                        cache + row_vals * slot, job->dst_w, &job->xt);
+            }
+            rows[k] = cache + row_vals * slot;
+        }
+
+        k_vpass(rows, wt, taps, job->dst + (size_t)y * row_vals, 0, (int)row_vals);
+    }
+
+    free(cache);
+    free(cache_src);
+    free(rows);
+    return 1;
+}
+
+static void
+resample_band(struct resample_band *band)
+{
+    struct resample_job *job = band->job;
+    if (job->filter == FILTER_NEAREST) {
+        resample_nearest_band(job, band->y_start, band->y_end);
+    } else if (!resample_filtered_band(job, band->y_start, band->y_end)) {
+        band->failed = 1;
+    }
+}
+
+static Tcl_ThreadCreateType
+resample_thread(ClientData cd)
+{
+    resample_band((struct resample_band *)cd);
+    TCL_THREAD_CREATE_RETURN;
+}
+
+static int
+resample_cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (int)si.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#else
+    return 1;
+#endif
+}
+
+/* Runs without the GVL. Band 0 runs on the calling thread; the rest on
+ * Tcl threads (falling back to the calling thread if one can't start). */
+static void *
+resample_without_gvl(void *arg)
+{
+    struct resample_job *job = arg;
+    struct resample_band bands[RESAMPLE_MAX_THREADS];
+    Tcl_ThreadId ids[RESAMPLE_MAX_THREADS];
+    int started[RESAMPLE_MAX_THREADS];
+    int i, n = job->nthreads;
+
+    for (i = 0; i < n; i++) {
+        bands[i].job = job;
+        bands[i].y_start = (int)((int64_t)job->dst_h * i / n);
+        bands[i].y_end = (int)((int64_t)job->dst_h * (i + 1) / n);
+        bands[i].failed = 0;
+        started[i] = 0;
+    }
+    for (i = 1; i < n; i++) {
+        started[i] = Tcl_CreateThread(&ids[i], resample_thread, &bands[i],
+                                      TCL_THREAD_STACK_DEFAULT, TCL_THREAD_JOINABLE) == TCL_OK;
+    }
+    resample_band(&bands[0]);
+    for (i = 1; i < n; i++) {
+        if (started[i]) {
+            int result;
+            Tcl_JoinThread(ids[i], &result);
+        } else {
+            resample_band(&bands[i]);
+        }
+        if (bands[i].failed) job->failed = 1;
+    }
+    if (bands[0].failed) job->failed = 1;
+    return NULL;
+}
+
+/* ---------------------------------------------------------
+ * Interp#photo_resample(src_path, dst_path, opts={})
+ *
+ * Scale a region of one photo into another at an arbitrary ratio.
+ *
+ * Arguments:
+ *   src_path - Tcl path of the source photo
+ *   dst_path - Tcl path of the destination photo (may be the same)
+ *   opts     - Optional hash:
+ *              :width, :height   - destination size (default: the
+ *                                  destination photo's current size)
+ *              :x, :y            - destination offsets (default 0,0)
+ *              :src_x, :src_y    - source region offset (default 0,0)
+ *              :src_width, :src_height - source region size (default:
+ *                                  the rest of the source image)
+ *              :filter    - :nearest, :bilinear (default) or :area
+ *              :threads   - worker thread cap (default: CPU count);
+ *                           small images always use one thread
+ *              :composite - :set (default) or :overlay
+ *
+ * :area averages every source pixel under each destination pixel, the
+ * right choice for thumbnails and other large reductions. :bilinear
+ * suits upscaling and mild reductions; :nearest keeps hard pixel edges.
+ *
+ * The source region is clamped to the source image.
+ *
+ * See: https://www.tcl-lang.org/man/tcl8.6/TkLib/FindPhoto.htm
+ * --------------------------------------------------------- */
+
+static VALUE
+interp_photo_resample(int argc, VALUE *argv, VALUE self)
+{
+    struct tcltk_interp *tip = get_interp(self);
+    VALUE src_path, dst_path, opts;
+    Tk_PhotoHandle src_photo, dst_photo;
+    Tk_PhotoImageBlock sblock, dblock;
+    struct resample_job job;
+    int x_off = 0, y_off = 0, src_x = 0, src_y = 0;
+    int src_w = -1, src_h = -1, dst_w = -1, dst_h = -1;
+    int max_threads = 0;
+    int comp_rule = TK_PHOTO_COMPOSITE_SET;
+    unsigned char *src_copy = NULL;
+    int status;
+
+    rb_scan_args(argc, argv, "21", &src_path, &dst_path, &opts);
+    StringValue(src_path);
+    StringValue(dst_path);
+
+    memset(&job, 0, sizeof(job));
+    job.filter = FILTER_BILINEAR;
+
+    if (!NIL_P(opts) && TYPE(opts) == T_HASH) {
+        VALUE val;
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("width")));
+        if (!NIL_P(val)) dst_w = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("height")));
+        if (!NIL_P(val)) dst_h = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("x")));
+        if (!NIL_P(val)) x_off = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("y")));
+        if (!NIL_P(val)) y_off = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("src_x")));
+        if (!NIL_P(val)) src_x = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("src_y")));
+        if (!NIL_P(val)) src_y = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("src_width")));
+        if (!NIL_P(val)) src_w = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("src_height")));
+        if (!NIL_P(val)) src_h = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("threads")));
+        if (!NIL_P(val)) max_threads = NUM2INT(val);
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("filter")));
+        if (!NIL_P(val)) {
+            ID id;
+            Check_Type(val, T_SYMBOL);
+            id = SYM2ID(val);
+            if (id == rb_intern("nearest")) job.filter = FILTER_NEAREST;
+            else if (id == rb_intern("bilinear")) job.filter = FILTER_BILINEAR;
+            else if (id == rb_intern("area")) job.filter = FILTER_AREA;
+            else rb_raise(rb_eArgError, "unknown filter :%s (expected :nearest, :bilinear or :area)",
+                          rb_id2name(id));
+        }
+        val = rb_hash_aref(opts, ID2SYM(rb_intern("composite")));
+        if (!NIL_P(val) && TYPE(val) == T_SYMBOL) {
+            if (rb_intern("overlay") == SYM2ID(val)) {
+                comp_rule = TK_PHOTO_COMPOSITE_OVERLAY;
+            }
+        }
+    }
+
+    src_photo = Tk_FindPhoto(tip->interp, StringValueCStr(src_path));
+    if (!src_photo) {
+        rb_raise(eTclError, "photo image not found: %s", StringValueCStr(src_path));
+    }
+    dst_photo = Tk_FindPhoto(tip->interp, StringValueCStr(dst_path));
+    if (!dst_photo) {
+        rb_raise(eTclError, "photo image not found: %s", StringValueCStr(dst_path));
+    }
+
+    if (!Tk_PhotoGetImage(src_photo, &sblock)) {
+        rb_raise(eTclError, "failed to get photo image data");
+    }
+
+    /* Source region, clamped like photo_get_image */
+    if (src_x < 0) src_x = 0;
+    if (src_y < 0) src_y = 0;
+    if (src_x >= sblock.width || src_y >= sblock.height) {
+        rb_raise(rb_eArgError, "source region outside image bounds");
+    }
+    if (src_w < 0 || src_x + src_w > sblock.width) src_w = sblock.width - src_x;
+    if (src_h < 0 || src_y + src_h > sblock.height) src_h = sblock.height - src_y;
+    if (src_w <= 0 || src_h <= 0) {
+        rb_raise(rb_eArgError, "invalid source region size");
+    }
+
+    if (dst_w < 0 || dst_h < 0) {
+        int cur_w, cur_h;
+        Tk_PhotoGetSize(dst_photo, &cur_w, &cur_h);
+        if (dst_w < 0) dst_w = cur_w;
+        if (dst_h < 0) dst_h = cur_h;
+    }
+    if (dst_w <= 0 || dst_h <= 0) {
+        rb_raise(rb_eArgError, "destination width and height must be positive");
+    }
+
+    /* Source as packed RGBA rows - Tk's block in place when it already is */
+    if (sblock.pixelSize == 4 && sblock.offset[0] == 0 && sblock.offset[1] == 1 &&
+        sblock.offset[2] == 2 && sblock.offset[3] == 3) {
+        job.src = sblock.pixelPtr + (size_t)src_y * sblock.pitch + (size_t)src_x * 4;
+        job.src_pitch = sblock.pitch;
+    } else {
+        int x, y;
+        unsigned char *d;
+        src_copy = ALLOC_N(unsigned char, (size_t)src_w * src_h * 4);
+        d = src_copy;
+        for (y = 0; y < src_h; y++) {
+            const unsigned char *s = sblock.pixelPtr + (size_t)(src_y + y) * sblock.pitch
+                                     + (size_t)src_x * sblock.pixelSize;
+            for (x = 0; x < src_w; x++) {
+                *d++ = s[sblock.offset[0]];
+                *d++ = s[sblock.offset[1]];
+                *d++ = s[sblock.offset[2]];
+                *d++ = sblock.pixelSize >= 4 ? s[sblock.offset[3]] : 255;
+                s += sblock.pixelSize;
+            }
+        }
+        job.src = src_copy;
+        job.src_pitch = src_w * 4;
+    }
+    job.src_w = src_w;
+    job.src_h = src_h;
+    job.dst_w = dst_w;
+    job.dst_h = dst_h;
+
+    status = axis_taps_build(&job.xt, job.filter, src_w, dst_w);
+    if (status == 1) status = axis_taps_build(&job.yt, job.filter, src_h, dst_h);
+    if (status != 1) {
+        axis_taps_free(&job.xt);
+        axis_taps_free(&job.yt);
+        if (src_copy) xfree(src_copy);
+        if (status < 0) {
+            rb_raise(rb_eArgError, "reduction ratio too large for :area (max %d:1 per axis)",
+                     RESAMPLE_MAX_TAPS - 2);
+        }
+        rb_raise(rb_eNoMemError, "failed to allocate resample tables");
+    }
+    job.dst = malloc((size_t)dst_w * dst_h * 4);
+    if (!job.dst) {
+        axis_taps_free(&job.xt);
+        axis_taps_free(&job.yt);
+        if (src_copy) xfree(src_copy);
+        rb_raise(rb_eNoMemError, "failed to allocate resample buffer");
+    }
+
+    if (max_threads <= 0) max_threads = resample_cpu_count();
+    job.nthreads = (int)(((int64_t)dst_w * dst_h) / RESAMPLE_MIN_PIXELS_PER_THREAD);
+    if (job.nthreads > max_threads) job.nthreads = max_threads;
+    if (job.nthreads > dst_h) job.nthreads = dst_h;
+    if (job.nthreads > RESAMPLE_MAX_THREADS) job.nthreads = RESAMPLE_MAX_THREADS;
+    if (job.nthreads < 1) job.nthreads = 1;
+
+    /* Nothing else touches the photos meanwhile: other Ruby threads only
+     * reach Tk through the main thread's event queue, and that's us. */
+    rb_thread_call_without_gvl(resample_without_gvl, &job, NULL, NULL);
+
+    axis_taps_free(&job.xt);
+    axis_taps_free(&job.yt);
+    if (src_copy) xfree(src_copy);
+
+    if (job.failed) {
+        free(job.dst);
+        rb_raise(rb_eNoMemError, "failed to allocate resample buffer");
+    }
+
+    dblock.pixelPtr = job.dst;
+    dblock.width = dst_w;
+    dblock.height = dst_h;
+    dblock.pitch = dst_w * 4;
+    dblock.pixelSize = 4;
+    dblock.offset[0] = 0;
+    dblock.offset[1] = 1;
+    dblock.offset[2] = 2;
+    dblock.offset[3] = 3;
+
+    status = Tk_PhotoPutBlock(tip->interp, dst_photo, &dblock, x_off, y_off,
+                              dst_w, dst_h, comp_rule);
+    free(job.dst);
+    if (status != TCL_OK) {
+        rb_raise(eTclError, "Tk_PhotoPutBlock failed: %s",
+                 Tcl_GetStringResult(tip->interp));
+    }
+
+    return Qnil;
+}
+
+void
+Init_tkresample(VALUE cInterp)
+{
+    resample_init_kernels();
+
+    rb_define_method(cInterp, "photo_resample", interp_photo_resample, -1);
+}
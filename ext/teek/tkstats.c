@@ -0,0 +1,326 @@
+/*
+ * tkstats.c - Bridge instrumentation counters (Teek.stats)
+ *
+ * Counts and latency histograms for the paths where UI time goes:
+ *   - commands run through tcl_invoke/tcl_eval, per command name
+ *     (including those queued from background threads)
+ *   - Ruby callbacks dispatched from Tcl (ruby_callback_proc), and how
+ *     many of them had to reacquire the GVL from a blocking mainloop wait
+ *   - the cross-thread queue: depth, and how long events waited between
+ *     queue_command_internal and running on the main thread
+ *
+ * Always compiled in, off by default. Every hook site checks
+ * teek_stats_enabled before reading the clock, so a disabled build pays
+ * one predictable branch. All recording happens with the GVL held, which
+ * is what serializes updates - no atomics or locks needed.
+ *
+ * Histograms use power-of-two microsecond buckets: bucket 0 counts
+ * durations under 1us, bucket k counts [2^(k-1), 2^k) us, and the last
+ * bucket everything from ~8s up.
+ */
+
+#include "tcltkbridge.h"
+#include <math.h>
+#include <string.h>
+
+#define STATS_BUCKETS 25
+
+/* Distinct command names tracked before the rest are lumped together.
+ * Widget commands are named by path, so a UI that creates widgets on
+ * the fly would otherwise grow the table without bound. */
+#define STATS_MAX_COMMANDS 1024
+#define STATS_OTHER_COMMAND "(other)"
+
+struct stats_timing {
+    unsigned long long count;
+    unsigned long long total_us;
+    unsigned long long max_us;
+    unsigned long long buckets[STATS_BUCKETS];
+};
+
+int teek_stats_enabled = 0;
+
+static Tcl_HashTable command_table;
+static int command_table_ready = 0;
+static int command_table_size = 0;
+
+static struct stats_timing callback_timing;
+static unsigned long long callback_gvl_reacquired = 0;
+static unsigned long long callback_errors = 0;
+
+static struct stats_timing queue_wait_timing;
+static unsigned long long queue_pushed = 0;
+static long queue_max_depth = 0;
+
+static ID id_count, id_total_us, id_mean_us, id_max_us, id_p50_us, id_p99_us, id_histogram;
+
+/* ---------------------------------------------------------
+ * Recording (hot path, GVL held)
+ * --------------------------------------------------------- */
+
+long long
+teek_stats_now_us(void)
+{
+    Tcl_Time now;
+    Tcl_GetTime(&now);
+    return (long long)now.sec * 1000000LL + now.usec;
+}
+
+static void
+timing_add(struct stats_timing *t, long long us)
+{
+    unsigned long long v = us > 0 ? (unsigned long long)us : 0;
+    int bucket = 0;
+
+    while (bucket < STATS_BUCKETS - 1 && v >= (1ULL << bucket)) {
+        bucket++;
+    }
+    t->count++;
+    t->total_us += v;
+    if (v > t->max_us) t->max_us = v;
+    t->buckets[bucket]++;
+}
+
+void
+teek_stats_command(const char *name, long long start_us)
+{
+    Tcl_HashEntry *entry;
+    struct stats_timing *t;
+    int is_new;
+
+    if (!start_us) return;
+
+    if (!command_table_ready) {
+        Tcl_InitHashTable(&command_table, TCL_STRING_KEYS);
+        command_table_ready = 1;
+    }
+
+    entry = Tcl_FindHashEntry(&command_table, name);
+    if (!entry) {
+        if (command_table_size >= STATS_MAX_COMMANDS) {
+            name = STATS_OTHER_COMMAND;
+        }
+        entry = Tcl_CreateHashEntry(&command_table, name, &is_new);
+        if (is_new) {
+            t = (struct stats_timing *)ckalloc(sizeof(*t));
+            memset(t, 0, sizeof(*t));
+            Tcl_SetHashValue(entry, t);
+            command_table_size++;
+        }
+    }
+    t = (struct stats_timing *)Tcl_GetHashValue(entry);
+    timing_add(t, teek_stats_now_us() - start_us);
+}
+
+/* tcl_eval stats are keyed by the script's first word */
+void
+teek_stats_script(const char *script, long long start_us)
+{
+    char name[64];
+    size_t n = 0;
+
+    if (!start_us) return;
+
+    while (*script == ' ' || *script == '\t' || *script == '\n') script++;
+    while (script[n] && n < sizeof(name) - 1 &&
+           script[n] != ' ' && script[n] != '\t' && script[n] != '\n' && script[n] != ';') {
+        name[n] = script[n];
+        n++;
+    }
+    name[n] = '\0';
+    teek_stats_command(n ? name : "(empty)", start_us);
+}
+
+void
+teek_stats_callback(long long start_us, int reacquired_gvl, int failed)
+{
+    if (!start_us) return;
+    timing_add(&callback_timing, teek_stats_now_us() - start_us);
+    if (reacquired_gvl) callback_gvl_reacquired++;
+    if (failed) callback_errors++;
+}
+
+void
+teek_stats_queue_push(long depth)
+{
+    queue_pushed++;
+    if (depth > queue_max_depth) queue_max_depth = depth;
+}
+
+void
+teek_stats_queue_wait(long long queued_us)
+{
+    if (!queued_us) return;
+    timing_add(&queue_wait_timing, teek_stats_now_us() - queued_us);
+}
+
+/* ---------------------------------------------------------
+ * Ruby API
+ * --------------------------------------------------------- */
+
+/* Smallest bucket upper bound covering fraction q of the samples */
+static VALUE
+timing_percentile(const struct stats_timing *t, double q)
+{
+    unsigned long long seen = 0, want;
+    int i;
+
+    if (t->count == 0) return Qnil;
+    want = (unsigned long long)ceil(q * (double)t->count);
+    for (i = 0; i < STATS_BUCKETS - 1; i++) {
+        seen += t->buckets[i];
+        if (seen >= want) return ULL2NUM(1ULL << i);
+    }
+    return ULL2NUM(t->max_us);
+}
+
+static VALUE
+timing_to_hash(const struct stats_timing *t)
+{
+    VALUE h = rb_hash_new();
+    VALUE hist = rb_hash_new();
+    int i;
+
+    for (i = 0; i < STATS_BUCKETS; i++) {
+        if (!t->buckets[i]) continue;
+        rb_hash_aset(hist,
+                     i == STATS_BUCKETS - 1 ? DBL2NUM(HUGE_VAL) : ULL2NUM(1ULL << i),
+                     ULL2NUM(t->buckets[i]));
+    }
+
+    rb_hash_aset(h, ID2SYM(id_count), ULL2NUM(t->count));
+    rb_hash_aset(h, ID2SYM(id_total_us), ULL2NUM(t->total_us));
+    rb_hash_aset(h, ID2SYM(id_mean_us),
+                 t->count ? DBL2NUM((double)t->total_us / (double)t->count) : DBL2NUM(0.0));
+    rb_hash_aset(h, ID2SYM(id_max_us), ULL2NUM(t->max_us));
+    rb_hash_aset(h, ID2SYM(id_p50_us), timing_percentile(t, 0.50));
+    rb_hash_aset(h, ID2SYM(id_p99_us), timing_percentile(t, 0.99));
+    rb_hash_aset(h, ID2SYM(id_histogram), hist);
+    return h;
+}
+
+/*
+ * Teek.stats -> Hash
+ *
+ * Snapshot of the bridge counters collected while stats were enabled:
+ *
+ *   {
+ *     enabled:   true,
+ *     commands:  { "set" => timing, ".f.b" => timing, ... },
+ *     callbacks: timing + { gvl_reacquired:, errors: },
+ *     thread_queue: { pushed:, max_depth:, wait: timing }
+ *   }
+ *
+ * Each timing is { count:, total_us:, mean_us:, max_us:, p50_us:,
+ * p99_us:, histogram: { upper_bound_us => count } }. Percentiles are
+ * bucket upper bounds (within 2x). Command times are inclusive: a
+ * command that runs a Ruby callback which runs more commands counts
+ * all of it.
+ */
+static VALUE
+teek_stats_snapshot(VALUE self)
+{
+    VALUE result = rb_hash_new();
+    VALUE commands = rb_hash_new();
+    VALUE callbacks, queue;
+
+    if (command_table_ready) {
+        Tcl_HashSearch search;
+        Tcl_HashEntry *entry;
+        for (entry = Tcl_FirstHashEntry(&command_table, &search);
+             entry != NULL; entry = Tcl_NextHashEntry(&search)) {
+            const char *name = (const char *)Tcl_GetHashKey(&command_table, entry);
+            rb_hash_aset(commands, rb_utf8_str_new_cstr(name),
+                         timing_to_hash((struct stats_timing *)Tcl_GetHashValue(entry)));
+        }
+    }
+
+    callbacks = timing_to_hash(&callback_timing);
+    rb_hash_aset(callbacks, ID2SYM(rb_intern("gvl_reacquired")), ULL2NUM(callback_gvl_reacquired));
+    rb_hash_aset(callbacks, ID2SYM(rb_intern("errors")), ULL2NUM(callback_errors));
+
+    queue = rb_hash_new();
+    rb_hash_aset(queue, ID2SYM(rb_intern("pushed")), ULL2NUM(queue_pushed));
+    rb_hash_aset(queue, ID2SYM(rb_intern("max_depth")), LONG2NUM(queue_max_depth));
+    rb_hash_aset(queue, ID2SYM(rb_intern("wait")), timing_to_hash(&queue_wait_timing));
+
+    rb_hash_aset(result, ID2SYM(rb_intern("enabled")), teek_stats_enabled ? Qtrue : Qfalse);
+    rb_hash_aset(result, ID2SYM(rb_intern("commands")), commands);
+    rb_hash_aset(result, ID2SYM(rb_intern("callbacks")), callbacks);
+    rb_hash_aset(result, ID2SYM(rb_intern("thread_queue")), queue);
+    return result;
+}
+
+/*
+ * Teek.reset_stats -> nil
+ *
+ * Zero every counter. Doesn't change whether stats are enabled.
+ */
+static VALUE
+teek_stats_reset(VALUE self)
+{
+    if (command_table_ready) {
+        Tcl_HashSearch search;
+        Tcl_HashEntry *entry;
+        for (entry = Tcl_FirstHashEntry(&command_table, &search);
+             entry != NULL; entry = Tcl_NextHashEntry(&search)) {
+            ckfree((char *)Tcl_GetHashValue(entry));
+        }
+        Tcl_DeleteHashTable(&command_table);
+        command_table_ready = 0;
+        command_table_size = 0;
+    }
+
+    memset(&callback_timing, 0, sizeof(callback_timing));
+    callback_gvl_reacquired = 0;
+    callback_errors = 0;
+    memset(&queue_wait_timing, 0, sizeof(queue_wait_timing));
+    queue_pushed = 0;
+    queue_max_depth = 0;
+    return Qnil;
+}
+
+/*
+ * Teek.stats_enabled? -> Boolean
+ */
+static VALUE
+teek_stats_enabled_p(VALUE self)
+{
+    return teek_stats_enabled ? Qtrue : Qfalse;
+}
+
+/*
+ * Teek.stats_enabled = Boolean
+ *
+ * Turn collection on or off at runtime. Counters keep their values
+ * across toggles; see Teek.reset_stats.
+ */
+static VALUE
+teek_stats_set_enabled(VALUE self, VALUE val)
+{
+    teek_stats_enabled = RTEST(val);
+    return val;
+}
+
+void
+Init_tkstats(VALUE mTeek)
+{
+    id_count = rb_intern("count");
+    id_total_us = rb_intern("total_us");
+    id_mean_us = rb_intern("mean_us");
+    id_max_us = rb_intern("max_us");
+    id_p50_us = rb_intern("p50_us");
+    id_p99_us = rb_intern("p99_us");
+    id_histogram = rb_intern("histogram");
+
+    /* TEEK_STATS=1 turns collection on from process start */
+    {
+        const char *env = getenv("TEEK_STATS");
+        teek_stats_enabled = env && *env && strcmp(env, "0") != 0;
+    }
+
+    rb_define_module_function(mTeek, "stats", teek_stats_snapshot, 0);
+    rb_define_module_function(mTeek, "reset_stats", teek_stats_reset, 0);
+    rb_define_module_function(mTeek, "stats_enabled?", teek_stats_enabled_p, 0);
+    rb_define_module_function(mTeek, "stats_enabled=", teek_stats_set_enabled, 1);
+}
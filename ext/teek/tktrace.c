@@ -0,0 +1,365 @@
+/*
+ * tktrace.c - Event-loop latency tracer (Teek::Tracer)
+ *
+ * Records timed spans for the things that can stall the UI thread:
+ *   - each interp_mainloop Tcl_DoOneEvent iteration, split into the
+ *     idle wait in the notifier and the event handling after it
+ *   - each ruby_callback_proc invocation (callback id, and the widget
+ *     path if one was passed as an argument)
+ *   - each event queued from a background thread (queue_command_internal)
+ *   - spans reported by other extensions through Teek._trace_fn_ptrs,
+ *     e.g. teek-sdl2's Renderer#present
+ *
+ * Spans go into a fixed-size ring buffer that overwrites the oldest
+ * entries. Writers claim a slot with an atomic increment and publish it
+ * with a per-slot sequence number, so recording takes no lock and works
+ * without the GVL (the mainloop records while it's released); a reader
+ * skips any slot that's mid-write. Writers also keep an in-flight count,
+ * which _trace_start and _trace_clear wait out after disabling tracing
+ * before they reallocate or wipe the ring. Teek::Tracer
+ * (lib/teek/tracer.rb) turns a snapshot into Chrome/Perfetto trace JSON.
+ *
+ * The notifier wait is observed with a Tcl event source whose setup
+ * proc runs right before Tcl blocks and whose check proc runs right
+ * after, so no change to how the mainloop waits is needed.
+ *
+ * Off by default; when off, every hook is one branch.
+ */
+
+#include "tcltkbridge.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TRACE_CLAIM(p)       __atomic_fetch_add((p), 1, __ATOMIC_ACQ_REL)
+#define TRACE_LOAD(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define TRACE_STORE(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+/* Writer count vs. enabled flag: each side stores one and then loads
+ * the other, which needs sequential consistency */
+#define TRACE_ENTER(p)       __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define TRACE_LEAVE(p)       __atomic_sub_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define TRACE_SC_LOAD(p)     __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define TRACE_SC_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+#else
+#define TRACE_CLAIM(p)       ((*(p))++)
+#define TRACE_LOAD(p)        (*(p))
+#define TRACE_STORE(p, v)    (*(p) = (v))
+#define TRACE_ENTER(p)       (++(*(p)))
+#define TRACE_LEAVE(p)       (--(*(p)))
+#define TRACE_SC_LOAD(p)     (*(volatile int *)(p))
+#define TRACE_SC_STORE(p, v) (*(volatile int *)(p) = (v))
+#endif
+
+/* Spin-wait hint for trace_quiesce */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define TRACE_PAUSE()        __builtin_ia32_pause()
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+#define TRACE_PAUSE()        __asm__ __volatile__("yield")
+#else
+#define TRACE_PAUSE()        ((void)0)
+#endif
+
+#define TRACE_DEFAULT_CAPACITY 16384
+#define TRACE_NAME_LEN 32
+#define TRACE_DETAIL_LEN 64
+
+struct trace_slot {
+    unsigned long long seq;      /* claimed position + 1 once published, 0 while writing */
+    long long start_us;
+    long long dur_us;
+    long long value;             /* callback id, queue wait (us), ... */
+    int kind;                    /* enum teek_trace_kind */
+    char name[TRACE_NAME_LEN];
+    char detail[TRACE_DETAIL_LEN];
+};
+
+int teek_trace_enabled = 0;
+
+static struct trace_slot *ring = NULL;
+static unsigned long long ring_mask = 0;
+static unsigned long long ring_pos = 0;
+static long long min_duration_us = 0;
+static int trace_writers = 0;    /* trace_write calls in flight */
+
+/* Current mainloop iteration (main thread only) */
+static int iter_open = 0;
+static int iter_can_wait = 0;
+static long long iter_start_us = 0;
+static long long iter_wait_start_us = 0;
+static long long iter_wait_end_us = 0;
+static int wait_source_installed = 0;
+
+static long long
+trace_now_us(void)
+{
+    Tcl_Time now;
+    Tcl_GetTime(&now);
+    return (long long)now.sec * 1000000LL + now.usec;
+}
+
+static void
+copy_field(char *dst, size_t size, const char *src)
+{
+    size_t n = 0;
+    if (src) {
+        while (n < size - 1 && src[n]) {
+            dst[n] = src[n];
+            n++;
+        }
+    }
+    dst[n] = '\0';
+}
+
+static void
+trace_write(int kind, const char *name, const char *detail, long long value,
+            long long start_us, long long end_us)
+{
+    unsigned long long pos;
+    struct trace_slot *slot;
+    long long dur = end_us - start_us;
+
+    if (dur < 0) dur = 0;
+    if (dur < min_duration_us) return;
+
+    TRACE_ENTER(&trace_writers);
+    if (!TRACE_SC_LOAD(&teek_trace_enabled) || !ring) {
+        TRACE_LEAVE(&trace_writers);
+        return;
+    }
+    pos = TRACE_CLAIM(&ring_pos);
+    slot = &ring[pos & ring_mask];
+    TRACE_STORE(&slot->seq, 0ULL);
+    slot->start_us = start_us;
+    slot->dur_us = dur;
+    slot->value = value;
+    slot->kind = kind;
+    copy_field(slot->name, sizeof(slot->name), name);
+    copy_field(slot->detail, sizeof(slot->detail), detail);
+    TRACE_STORE(&slot->seq, pos + 1);
+    TRACE_LEAVE(&trace_writers);
+}
+
+/* Turn recording off and wait for writers that got in before that (on
+ * the mainloop thread, with the GVL released) to finish their slot.
+ * Returns whether tracing was on. */
+static int
+trace_quiesce(void)
+{
+    int was_enabled = TRACE_SC_LOAD(&teek_trace_enabled);
+
+    TRACE_SC_STORE(&teek_trace_enabled, 0);
+    while (TRACE_SC_LOAD(&trace_writers)) {
+        /* A write is a few stores; nothing in it blocks */
+        TRACE_PAUSE();
+    }
+    return was_enabled;
+}
+
+/* ---------------------------------------------------------
+ * Hooks (called from tcltkbridge.c and, via Teek._trace_fn_ptrs,
+ * from other extensions)
+ * --------------------------------------------------------- */
+
+/* Start of a span: its timestamp, or 0 when tracing is off. Anything
+ * traced inside an iteration means the notifier wait is over, so a
+ * nested Tcl_DoOneEvent (app.update in a callback) isn't taken for it. */
+long long
+teek_trace_begin(void)
+{
+    if (!teek_trace_enabled) return 0;
+    iter_can_wait = 0;
+    return trace_now_us();
+}
+
+void
+teek_trace_span(int kind, const char *name, const char *detail,
+                long long value, long long start_us)
+{
+    if (!start_us || !teek_trace_enabled) return;
+    trace_write(kind, name, detail, value, start_us, trace_now_us());
+}
+
+static void
+wait_setup_proc(ClientData clientData, int flags)
+{
+    if (iter_open && iter_can_wait && !iter_wait_start_us) {
+        iter_wait_start_us = trace_now_us();
+    }
+}
+
+static void
+wait_check_proc(ClientData clientData, int flags)
+{
+    if (iter_open && iter_can_wait && iter_wait_start_us && !iter_wait_end_us) {
+        iter_wait_end_us = trace_now_us();
+        iter_can_wait = 0;
+        trace_write(TEEK_TRACE_WAIT, "wait", NULL, 0,
+                    iter_wait_start_us, iter_wait_end_us);
+    }
+}
+
+/* Runs without the GVL, around Tcl_DoOneEvent in the mainloop */
+void
+teek_trace_iteration_begin(void)
+{
+    if (!teek_trace_enabled) return;
+    if (!wait_source_installed) {
+        Tcl_CreateEventSource(wait_setup_proc, wait_check_proc, NULL);
+        wait_source_installed = 1;
+    }
+    iter_open = 1;
+    iter_can_wait = 1;
+    iter_start_us = trace_now_us();
+    iter_wait_start_us = 0;
+    iter_wait_end_us = 0;
+}
+
+void
+teek_trace_iteration_end(void)
+{
+    if (!iter_open) return;
+    iter_open = 0;
+    iter_can_wait = 0;
+    if (!teek_trace_enabled) return;
+    /* The span covers event handling only; the wait has its own */
+    trace_write(TEEK_TRACE_ITERATION, "DoOneEvent", NULL, 0,
+                iter_wait_end_us ? iter_wait_end_us : iter_start_us,
+                trace_now_us());
+}
+
+/* ---------------------------------------------------------
+ * Ruby API (wrapped by lib/teek/tracer.rb)
+ * --------------------------------------------------------- */
+
+/*
+ * Teek._trace_start(capacity, min_us) -> nil
+ *
+ * Start recording into a ring of +capacity+ spans (rounded up to a
+ * power of two), dropping spans shorter than +min_us+. A different
+ * capacity reallocates (and clears) the ring.
+ */
+static VALUE
+trace_start(VALUE self, VALUE vcapacity, VALUE vmin)
+{
+    long cap = NIL_P(vcapacity) ? TRACE_DEFAULT_CAPACITY : NUM2LONG(vcapacity);
+    long long min_us = NIL_P(vmin) ? 0 : NUM2LL(vmin);
+    unsigned long long size = 1;
+
+    if (cap < 1 || cap > (1L << 24)) {
+        rb_raise(rb_eArgError, "capacity must be between 1 and %ld", 1L << 24);
+    }
+    while (size < (unsigned long long)cap) size <<= 1;
+
+    trace_quiesce();
+    if (!ring || size != ring_mask + 1) {
+        if (ring) xfree(ring);
+        ring = ALLOC_N(struct trace_slot, size);
+        memset(ring, 0, sizeof(struct trace_slot) * size);
+        ring_mask = size - 1;
+        ring_pos = 0;
+    }
+    min_duration_us = min_us < 0 ? 0 : min_us;
+    TRACE_SC_STORE(&teek_trace_enabled, 1);
+    return Qnil;
+}
+
+/*
+ * Teek._trace_stop -> nil
+ *
+ * Stop recording. The ring keeps its spans for _trace_snapshot.
+ */
+static VALUE
+trace_stop(VALUE self)
+{
+    TRACE_SC_STORE(&teek_trace_enabled, 0);
+    return Qnil;
+}
+
+/*
+ * Teek._trace_enabled? -> Boolean
+ */
+static VALUE
+trace_enabled_p(VALUE self)
+{
+    return teek_trace_enabled ? Qtrue : Qfalse;
+}
+
+/*
+ * Teek._trace_clear -> nil
+ */
+static VALUE
+trace_clear(VALUE self)
+{
+    if (ring) {
+        int was_enabled = trace_quiesce();
+        memset(ring, 0, sizeof(struct trace_slot) * (ring_mask + 1));
+        ring_pos = 0;
+        TRACE_SC_STORE(&teek_trace_enabled, was_enabled);
+    }
+    return Qnil;
+}
+
+/*
+ * Teek._trace_snapshot -> [overwritten, spans]
+ *
+ * Spans oldest first, each [kind, name, detail, value, start_us, dur_us].
+ * +overwritten+ counts spans lost to the ring wrapping around.
+ */
+static VALUE
+trace_snapshot(VALUE self)
+{
+    VALUE spans = rb_ary_new();
+    unsigned long long end, start, pos, cap;
+
+    if (!ring) return rb_ary_new3(2, INT2FIX(0), spans);
+
+    cap = ring_mask + 1;
+    end = TRACE_LOAD(&ring_pos);
+    start = end > cap ? end - cap : 0;
+
+    for (pos = start; pos < end; pos++) {
+        struct trace_slot *slot = &ring[pos & ring_mask];
+        struct trace_slot copy;
+
+        if (TRACE_LOAD(&slot->seq) != pos + 1) continue;
+        memcpy(&copy, slot, sizeof(copy));
+        if (TRACE_LOAD(&slot->seq) != pos + 1) continue;  /* rewritten meanwhile */
+        copy.name[TRACE_NAME_LEN - 1] = '\0';
+        copy.detail[TRACE_DETAIL_LEN - 1] = '\0';
+
+        rb_ary_push(spans, rb_ary_new3(6,
+            INT2FIX(copy.kind),
+            rb_utf8_str_new_cstr(copy.name),
+            copy.detail[0] ? rb_utf8_str_new_cstr(copy.detail) : Qnil,
+            LL2NUM(copy.value),
+            LL2NUM(copy.start_us),
+            LL2NUM(copy.dur_us)));
+    }
+
+    return rb_ary_new3(2, ULL2NUM(start), spans);
+}
+
+/*
+ * Teek._trace_fn_ptrs -> [begin, span]
+ *
+ * Addresses of teek_trace_begin (teek_trace_begin_fn) and
+ * teek_trace_span (teek_trace_span_fn), for other C extensions to
+ * report their own spans - see teek-sdl2's Renderer#present.
+ */
+static VALUE
+trace_fn_ptrs(VALUE self)
+{
+    return rb_ary_new3(2, ULL2NUM((uintptr_t)teek_trace_begin),
+                          ULL2NUM((uintptr_t)teek_trace_span));
+}
+
+void
+Init_tktrace(VALUE mTeek)
+{
+    rb_define_module_function(mTeek, "_trace_start", trace_start, 2);
+    rb_define_module_function(mTeek, "_trace_stop", trace_stop, 0);
+    rb_define_module_function(mTeek, "_trace_enabled?", trace_enabled_p, 0);
+    rb_define_module_function(mTeek, "_trace_clear", trace_clear, 0);
+    rb_define_module_function(mTeek, "_trace_snapshot", trace_snapshot, 0);
+    rb_define_module_function(mTeek, "_trace_fn_ptrs", trace_fn_ptrs, 0);
+}
@@ -5,6 +5,7 @@
  */
 
 #include "tcltkbridge.h"
+#include <ruby/encoding.h>
 #include <stdint.h>
 
 #ifdef __APPLE__
@@ -142,6 +143,154 @@ interp_window_geometry(VALUE self, VALUE window_path)
         INT2NUM(Tk_Width(tkwin)), INT2NUM(Tk_Height(tkwin)));
 }
 
+/* ---------------------------------------------------------
+ * Interp#subtree_geometry(root_path)
+ *
+ * Walk a window and all its descendants in one call, for layout
+ * snapshots, hit-testing overlays and debugger tree sync that would
+ * otherwise query each window separately.
+ *
+ * Tk's public C API has no child iterator, so children are listed with
+ * "winfo children" evaluated from C (pre-built Tcl_Objs, no parsing);
+ * everything else comes from the Tk_Window itself.
+ *
+ * Arguments:
+ *   root_path - Tk window path to start from (e.g., ".", ".main")
+ *
+ * Returns Hash with:
+ *   :paths    - Array of window paths, depth-first pre-order (root first,
+ *               children in stacking order)
+ *   :classes  - Array of Tk class names (interned Strings), same order
+ *   :geometry - Binary String of native-endian int32, six per window:
+ *               parent index (-1 for the root), root x, root y, width,
+ *               height, flags (SUBTREE_MAPPED | SUBTREE_TOPLEVEL)
+ *
+ * Windows that are destroyed during the walk (e.g. by an idle handler)
+ * are skipped.
+ *
+ * See: https://www.tcl-lang.org/man/tcl9.0/TkLib/WindowId.html
+ * --------------------------------------------------------- */
+
+#define SUBTREE_MAPPED   1
+#define SUBTREE_TOPLEVEL 2
+
+static VALUE
+interp_subtree_geometry(VALUE self, VALUE root_path)
+{
+    struct tcltk_interp *tip = get_interp(self);
+    Tk_Window mainWin, tkwin;
+    Tcl_Obj *objv[3];
+    Tcl_Obj *stack;
+    VALUE paths, classes, geometry, result;
+    Tk_Uid last_class = NULL;
+    VALUE last_class_str = Qnil;
+    int status = TCL_OK;
+    Tcl_Size depth;
+
+    StringValue(root_path);
+
+    mainWin = Tk_MainWindow(tip->interp);
+    if (!mainWin) {
+        rb_raise(eTclError, "Tk not initialized (no main window)");
+    }
+    if (!Tk_NameToWindow(tip->interp, StringValueCStr(root_path), mainWin)) {
+        rb_raise(eTclError, "window not found: %s", StringValueCStr(root_path));
+    }
+
+    paths = rb_ary_new();
+    classes = rb_ary_new();
+    geometry = rb_str_buf_new(0);
+
+    objv[0] = Tcl_NewStringObj("winfo", -1);
+    objv[1] = Tcl_NewStringObj("children", -1);
+    Tcl_IncrRefCount(objv[0]);
+    Tcl_IncrRefCount(objv[1]);
+
+    /* Stack of (path, parent index) pairs; children are pushed in
+     * reverse so they pop in stacking order. */
+    stack = Tcl_NewListObj(0, NULL);
+    Tcl_IncrRefCount(stack);
+    Tcl_ListObjAppendElement(NULL, stack, Tcl_NewStringObj(RSTRING_PTR(root_path),
+                                                          (Tcl_Size)RSTRING_LEN(root_path)));
+    Tcl_ListObjAppendElement(NULL, stack, Tcl_NewWideIntObj(-1));
+
+    while (Tcl_ListObjLength(NULL, stack, &depth) == TCL_OK && depth > 0) {
+        Tcl_Obj *path_obj, *parent_obj, *children;
+        Tcl_Obj **child_objs;
+        Tcl_Size nchildren, i;
+        Tcl_WideInt parent;
+        int index, x, y;
+        int32_t rec[6];
+        const char *path;
+        Tk_Uid cls;
+
+        Tcl_ListObjIndex(NULL, stack, depth - 2, &path_obj);
+        Tcl_ListObjIndex(NULL, stack, depth - 1, &parent_obj);
+        Tcl_IncrRefCount(path_obj);
+        Tcl_GetWideIntFromObj(NULL, parent_obj, &parent);
+        Tcl_ListObjReplace(NULL, stack, depth - 2, 2, 0, NULL);
+
+        path = Tcl_GetString(path_obj);
+        tkwin = Tk_NameToWindow(tip->interp, path, mainWin);
+        if (!tkwin) {
+            Tcl_ResetResult(tip->interp);
+            Tcl_DecrRefCount(path_obj);
+            continue;
+        }
+
+        index = (int)RARRAY_LEN(paths);
+        rb_ary_push(paths, rb_utf8_str_new_cstr(path));
+
+        cls = Tk_Class(tkwin);
+        if (cls != last_class || NIL_P(last_class_str)) {
+            last_class = cls;
+            last_class_str = rb_enc_interned_str_cstr(cls ? cls : "", rb_utf8_encoding());
+        }
+        rb_ary_push(classes, last_class_str);
+
+        Tk_GetRootCoords(tkwin, &x, &y);
+        rec[0] = (int32_t)parent;
+        rec[1] = x;
+        rec[2] = y;
+        rec[3] = Tk_Width(tkwin);
+        rec[4] = Tk_Height(tkwin);
+        rec[5] = (Tk_IsMapped(tkwin) ? SUBTREE_MAPPED : 0) |
+                 (Tk_IsTopLevel(tkwin) ? SUBTREE_TOPLEVEL : 0);
+        rb_str_buf_cat(geometry, (const char *)rec, sizeof(rec));
+
+        objv[2] = path_obj;
+        status = Tcl_EvalObjv(tip->interp, 3, objv, 0);
+        Tcl_DecrRefCount(path_obj);
+        if (status != TCL_OK) break;
+
+        children = Tcl_GetObjResult(tip->interp);
+        Tcl_IncrRefCount(children);
+        if (Tcl_ListObjGetElements(tip->interp, children, &nchildren, &child_objs) == TCL_OK) {
+            for (i = nchildren - 1; i >= 0; i--) {
+                Tcl_ListObjAppendElement(NULL, stack, child_objs[i]);
+                Tcl_ListObjAppendElement(NULL, stack, Tcl_NewWideIntObj(index));
+            }
+        }
+        Tcl_DecrRefCount(children);
+    }
+
+    Tcl_DecrRefCount(stack);
+    Tcl_DecrRefCount(objv[0]);
+    Tcl_DecrRefCount(objv[1]);
+
+    if (status != TCL_OK) {
+        rb_raise(eTclError, "winfo children failed: %s",
+                 Tcl_GetStringResult(tip->interp));
+    }
+    Tcl_ResetResult(tip->interp);
+
+    result = rb_hash_new();
+    rb_hash_aset(result, ID2SYM(rb_intern("paths")), paths);
+    rb_hash_aset(result, ID2SYM(rb_intern("classes")), classes);
+    rb_hash_aset(result, ID2SYM(rb_intern("geometry")), geometry);
+    return result;
+}
+
 /* ---------------------------------------------------------
  * Interp#coords_to_window(root_x, root_y)
  *
@@ -265,6 +414,7 @@ Init_tkwin(VALUE cInterp)
     rb_define_method(cInterp, "user_inactive_time", interp_user_inactive_time, 0);
     rb_define_method(cInterp, "get_root_coords", interp_get_root_coords, 1);
     rb_define_method(cInterp, "window_geometry", interp_window_geometry, 1);
+    rb_define_method(cInterp, "subtree_geometry", interp_subtree_geometry, 1);
     rb_define_method(cInterp, "coords_to_window", interp_coords_to_window, 2);
     rb_define_method(cInterp, "native_window_handle", interp_native_window_handle, 1);
 }
@@ -11,12 +11,16 @@ require_relative 'teek/menu_interceptor'
 require_relative 'teek/tag_bind_interceptor'
 require_relative 'teek/canvas_bind_interceptor'
 require_relative 'teek/photo'
+require_relative 'teek/photo_atlas'
+require_relative 'teek/virtual_list'
+require_relative 'teek/canvas_scene'
 require_relative 'teek/dialogs'
 require_relative 'teek/winfo'
 require_relative 'teek/wm'
 require_relative 'teek/window'
 require_relative 'teek/clipboard'
 require_relative 'teek/repeating_timer'
+require_relative 'teek/tracer'
 
 # Ruby interface to Tcl/Tk. Provides a thin wrapper around a Tcl interpreter
 # with Ruby callbacks, event bindings, and background work support.
@@ -60,6 +64,15 @@ module Teek
     #   list, typically "NONE" unless the failing command set one explicitly)
     attr_reader :tcl_error_code
 
+    # @return [Array<Integer>, nil] for a failed canvas batch
+    #   (Interp#canvas_apply, Interp#canvas_create_many): ids of the
+    #   items it created before the failure, which are still on the canvas
+    attr_reader :created_ids
+
+    # @return [Integer, nil] for a failed canvas batch: index of the op
+    #   (or packed item) that failed; the ones before it were applied
+    attr_reader :failed_index
+
     # @api private
     def initialize(message, tcl_backtrace = nil, tcl_error_code = nil)
       super(message)
@@ -592,18 +605,33 @@ module Teek
       raise Teek::TclError, "can't read \"#{name}\": no such variable"
     end
 
-    # Destroy a widget and all its children.
+    # Destroy a widget and all its children. Destroying the root window
+    # also shuts down the app's {BackgroundPool} threads.
     # @param widget [String] Tk widget path (e.g. ".frame1")
     # @return [void]
     # @see https://www.tcl-lang.org/man/tcl8.6/TkCmd/destroy.htm destroy
     def destroy(widget = '.')
       raise ArgumentError, 'widget path cannot be nil' if widget.nil?
       tcl_eval("destroy #{widget}")
+      BackgroundPool.shutdown(self) if widget.to_s == '.'
+    end
+
+    # Get a persistent handle for a font description. The measuring
+    # methods below accept it in place of the description and skip the
+    # per-call font lookup (+Tk_GetFont+/+Tk_FreeFont+). The same
+    # description returns the same handle until {FontHandle#release}.
+    # @param font [String] font description (e.g. "Helvetica 12", "TkDefaultFont")
+    # @return [Teek::FontHandle]
+    # @raise [Teek::TclError] if the font is not found
+    # @see https://www.tcl-lang.org/man/tcl8.6/TkLib/GetFont.htm Tk_GetFont
+    def font_handle(font)
+      @interp.font_handle(font)
     end
 
     # Measure the pixel width of a text string in a given font.
     # Uses Tk's C font API directly — faster than the Tcl +font measure+ command.
-    # @param font [String] font description (e.g. "Helvetica 12", "TkDefaultFont")
+    # @param font [String, FontHandle] font description (e.g. "Helvetica 12",
+    #   "TkDefaultFont") or a handle from {#font_handle}
     # @param text [String] text to measure
     # @return [Integer] pixel width
     # @raise [Teek::TclError] if the font is not found
@@ -612,9 +640,20 @@ module Teek
       @interp.text_width(font, text)
     end
 
+    # Measure many strings in one call, looking the font up once.
+    # @param font [String, FontHandle] font description or handle
+    # @param strings [Array<String>] texts to measure
+    # @return [Array<Integer>] pixel widths, in order
+    # @raise [Teek::TclError] if the font is not found
+    # @see https://www.tcl-lang.org/man/tcl8.6/TkLib/MeasureChar.htm Tk_TextWidth
+    def text_widths(font, strings)
+      @interp.text_widths(font, strings)
+    end
+
     # Get font metrics (ascent, descent, linespace) for a given font.
     # Uses Tk's C font API directly.
-    # @param font [String] font description (e.g. "Helvetica 12", "TkDefaultFont")
+    # @param font [String, FontHandle] font description (e.g. "Helvetica 12",
+    #   "TkDefaultFont") or a handle from {#font_handle}
     # @return [Hash{Symbol => Integer}] +:ascent+, +:descent+, +:linespace+
     # @raise [Teek::TclError] if the font is not found
     # @see https://www.tcl-lang.org/man/tcl8.6/TkLib/FontId.htm Tk_GetFontMetrics
@@ -624,7 +663,8 @@ module Teek
 
     # Measure how many bytes of text fit within a pixel width limit.
     # Useful for text truncation, ellipsis, and line wrapping.
-    # @param font [String] font description (e.g. "Helvetica 12")
+    # @param font [String, FontHandle] font description (e.g. "Helvetica 12")
+    #   or a handle from {#font_handle}
     # @param text [String] text to measure
     # @param max_pixels [Integer] maximum pixel width (-1 for unlimited)
     # @param opts [Hash] options
@@ -638,6 +678,29 @@ module Teek
       @interp.measure_chars(font, text, max_pixels, opts)
     end
 
+    # Truncate many strings to a pixel width, appending an ellipsis to
+    # the ones that had to be cut - e.g. every visible cell of a column.
+    #
+    # Each font keeps a cache of ASCII/Latin glyph widths, so once warm,
+    # strings made of those characters are fitted without asking Tk to
+    # measure anything; others fall back to +Tk_MeasureChars+.
+    #
+    # @example Fit a column
+    #   app.fit_text("TkDefaultFont", names, 120).each_with_index do |text, row|
+    #     canvas.command(:itemconfigure, cell_ids[row], text: text)
+    #   end
+    #
+    # @param font [String, FontHandle] font description or handle
+    # @param strings [Array<String>] texts to fit
+    # @param max_pixels [Integer] available width
+    # @param ellipsis [String] appended to cut strings (+""+ to just clip)
+    # @return [Array<String>] the same String when it fits, otherwise a
+    #   new, shorter one ending in +ellipsis+ (+""+ if even that won't fit)
+    # @raise [Teek::TclError] if the font is not found
+    def fit_text(font, strings, max_pixels, ellipsis: "...")
+      @interp.fit_text(font, strings, max_pixels, { ellipsis: ellipsis })
+    end
+
     # Show a busy cursor on a window while executing a block.
     # The cursor is restored even if the block raises.
     # @param window [String] Tk window path
@@ -114,7 +114,7 @@ module Teek
           @paused = false
         end
 
-        def yield(value)
+        def yield(value, move: false)
           @callbacks[:progress]&.call(value)
         end
 
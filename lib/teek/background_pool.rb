@@ -0,0 +1,250 @@
+# frozen_string_literal: true
+
+require 'etc'
+
+module Teek
+  # Pooled background work: a fixed set of worker threads per app, fed
+  # from a priority queue.
+  #
+  # +:thread+ mode starts one Thread per task, so kicking off hundreds of
+  # jobs at once (thumbnails for a directory, one request per row) means
+  # hundreds of threads. +:pool+ tasks instead wait in a queue until one
+  # of the app's pool threads is free - {size} threads, the CPU count by
+  # default, created as jobs arrive. Higher +priority:+ jobs are picked
+  # first; equal priorities run in submission order.
+  #
+  # Tasks behave like +:thread+ mode tasks (same {TaskContext}, same
+  # push-based result delivery), with two differences: {BackgroundWork#stop}
+  # on a task that hasn't started yet cancels it outright (its +on_done+
+  # still fires), and {BackgroundWork#close} never kills a pool thread -
+  # a running task is asked to stop and its output is discarded. A paused
+  # task holds on to its pool thread.
+  #
+  # @example
+  #   files.each_with_index do |path, i|
+  #     Teek::BackgroundWork.new(app, path, mode: :pool, priority: visible?(i) ? 1 : 0) do |t, p|
+  #       t.yield(make_thumbnail(p))
+  #     end.on_progress { |thumb| show(thumb) }
+  #   end
+  module BackgroundPool
+    class << self
+      # Threads per app pool. Takes effect for pools created afterwards.
+      #
+      # @return [Integer] (default: +Etc.nprocessors+)
+      def size
+        @size ||= Etc.nprocessors
+      end
+
+      # @param count [Integer]
+      def size=(count)
+        raise ArgumentError, "pool size must be positive" unless count.to_i > 0
+        @size = count.to_i
+      end
+
+      # The pool shared by every +:pool+ task of +app+. The pool is shut
+      # down when +app+ destroys its root window or is garbage collected.
+      #
+      # @param app [Teek::App]
+      # @return [Pool]
+      def for(app)
+        @lock.synchronize do
+          @pools[app] ||= Pool.new(size).tap do |pool|
+            ObjectSpace.define_finalizer(app, finalizer_for(pool))
+          end
+        end
+      end
+
+      # Stop +app+'s pool: queued tasks are dropped and the threads exit
+      # once their current task returns. A later task starts a new pool.
+      #
+      # @param app [Teek::App]
+      # @return [void]
+      def shutdown(app)
+        pool = @lock.synchronize { @pools.delete(app) }
+        pool&.shutdown
+      end
+
+      private
+
+      # Built here so the proc doesn't capture the app it finalizes
+      def finalizer_for(pool)
+        proc { pool.shutdown }
+      end
+    end
+
+    @lock = Mutex.new
+    @pools = ObjectSpace::WeakKeyMap.new # app => Pool; idle pool threads don't hold the app
+
+    # Fixed-size thread pool with a priority job queue.
+    class Pool
+      # @return [Integer] maximum number of threads
+      attr_reader :size
+
+      # @param size [Integer]
+      def initialize(size)
+        @size = size
+        @mutex = Mutex.new
+        @cond = ConditionVariable.new
+        @jobs = [] # [-priority, seq, job], sorted
+        @seq = 0
+        @threads = []
+        @idle = 0
+        @shutdown = false
+      end
+
+      # Queue a job (anything responding to +run_in_pool+).
+      #
+      # @param job [#run_in_pool]
+      # @param priority [Integer] higher runs first
+      # @return [void]
+      def push(job, priority = 0)
+        @mutex.synchronize do
+          raise ThreadError, "pool has been shut down" if @shutdown
+          @seq += 1
+          key = -priority
+          index = @jobs.bsearch_index { |entry| entry[0] > key } || @jobs.size
+          @jobs.insert(index, [key, @seq, job])
+          spawn_thread if @jobs.size > @idle && @threads.size < @size
+          @cond.signal
+        end
+      end
+
+      # Remove a job that hasn't started yet.
+      #
+      # @return [Boolean] whether the job was still queued
+      def delete(job)
+        @mutex.synchronize do
+          index = @jobs.index { |entry| entry[2].equal?(job) }
+          index ? (@jobs.delete_at(index); true) : false
+        end
+      end
+
+      # @return [Integer] jobs waiting for a thread
+      def pending
+        @mutex.synchronize { @jobs.size }
+      end
+
+      # @return [Integer] threads started so far
+      def thread_count
+        @mutex.synchronize { @threads.size }
+      end
+
+      # @return [Boolean]
+      def shutdown?
+        @shutdown
+      end
+
+      # Drop queued jobs and let the threads exit.
+      #
+      # @return [void]
+      def shutdown
+        @mutex.synchronize do
+          @shutdown = true
+          @jobs.clear
+          @cond.broadcast
+        end
+      end
+
+      private
+
+      # Called with @mutex held
+      def spawn_thread
+        @threads << Thread.new do
+          work_loop
+        ensure
+          retire_thread
+        end
+      end
+
+      def work_loop
+        loop do
+          job = @mutex.synchronize do
+            @idle += 1
+            @cond.wait(@mutex) while @jobs.empty? && !@shutdown
+            @idle -= 1
+            @shutdown ? nil : @jobs.shift[2]
+          end
+          break unless job
+          run_job(job)
+        end
+      end
+
+      # A job that raises out of run_in_pool reports it through the job
+      # (if it can) and leaves the thread to take the next one.
+      def run_job(job)
+        job.run_in_pool
+      rescue => e
+        job.respond_to?(:pool_error) ? job.pool_error(e) : warn("Teek::BackgroundPool: #{e.class}: #{e.message}")
+      end
+
+      # A thread that exits, normally or not, no longer counts towards
+      # the pool; jobs it leaves queued get a replacement.
+      def retire_thread
+        @mutex.synchronize do
+          @threads.delete(Thread.current)
+          spawn_thread if !@shutdown && @jobs.size > @idle && @threads.size < @size
+        end
+      end
+    end
+
+    # A +:pool+ mode task. Same interface as the +:thread+ mode task.
+    class BackgroundWork < BackgroundThread::BackgroundWork
+      # @return [Integer]
+      attr_reader :priority
+
+      def initialize(app, data, worker: nil, priority: 0, **channel, &block)
+        super(app, data, worker: worker, **channel, &block)
+        @priority = priority
+        @pool = BackgroundPool.for(app)
+      end
+
+      def start
+        return self if @started
+        @started = true
+        @pool.push(self, @priority)
+        self
+      end
+
+      # Cancel a queued task, or ask a running one to stop.
+      def stop
+        if @started && @pool.delete(self)
+          @output_queue << [:done]
+          notify_main
+        else
+          send_message(:stop)
+        end
+        @token.cancel
+        self
+      end
+
+      # Drop the task without waiting for it. A running task is asked to
+      # stop; its pool thread is left alive.
+      def close
+        @pool.delete(self)
+        @done = true
+        send_message(:stop)
+        @token.cancel
+        self
+      end
+
+      # @api private
+      def run_in_pool
+        return if @done
+        @worker_thread = Thread.current
+        run_worker
+      end
+
+      # @api private
+      # run_in_pool raised past run_worker's own rescue (e.g. while
+      # handing its result over); fail the task rather than leave it
+      # unfinished.
+      def pool_error(error)
+        @output_queue << [:error, "#{error.class}: #{error.message}"]
+        @output_queue << [:done]
+        notify_main
+      rescue StandardError
+        # Output channel unusable too - nothing left to report through
+      end
+    end
+  end
+end
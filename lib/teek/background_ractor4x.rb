@@ -372,10 +372,21 @@ module Teek
 
         # Send a result to the main thread. Blocks while paused.
         # The value arrives in the {BackgroundWork#on_progress} callback.
-        # @param value [Object] any Ractor-shareable value
-        def yield(value)
+        #
+        # Values are deep-copied into the main Ractor unless they are
+        # shareable. Large payloads (pixel buffers, parsed tables) should
+        # skip the copy, either by freezing them first - a String made
+        # shareable with +Ractor.make_shareable+ is passed by reference -
+        # or with +move: true+, which hands the object over and leaves the
+        # worker's reference unusable. Both arrive ready for
+        # {Photo#put_block} and +Texture#update+, which read Strings and
+        # IO::Buffers in place.
+        #
+        # @param value [Object]
+        # @param move [Boolean] move +value+ instead of copying it
+        def yield(value, move: false)
           check_pause_loop
-          @output_port.send([:result, value])
+          @output_port.send([:result, value], move: move)
         end
 
         # Non-blocking check for a message from the main thread.
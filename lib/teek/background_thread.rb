@@ -1,5 +1,8 @@
 # frozen_string_literal: true
 
+require_relative 'cancellation_token'
+require_relative 'output_channel'
+
 module Teek
   # Thread-based background work for Teek applications.
   # Always available, works on all Ruby versions.
@@ -9,6 +12,15 @@ module Teek
   # the UI thread. For CPU-bound work, the GVL serializes execution and thread
   # overhead makes this slower than synchronous mode. Use :ractor for CPU-bound
   # parallelism (Ruby 4.x+).
+  #
+  # Results are pushed, not polled: the worker wakes the main thread through
+  # Tcl's thread event queue ({Interp#queue_for_main}) when it has output,
+  # with at most one wakeup pending per task. An idle or paused task costs
+  # the UI nothing.
+  #
+  # {BackgroundWork#stop} is cooperative ({TaskContext#check_message})
+  # except inside {TaskContext#cancellable} blocks, where it interrupts the
+  # worker; see {CancellationToken}.
   module BackgroundThread
 
     # High-level API for background work with messaging support.
@@ -26,11 +38,13 @@ module Teek
     #   task.send_message(:resume)
     #   task.stop
     #
-    # Poll interval when paused (slower to save CPU)
-    PAUSED_POLL_MS = 10000
-
     class BackgroundWork
-      def initialize(app, data, worker: nil, &block)
+      # @param capacity [Integer, nil] bound the results waiting for the
+      #   UI (default unbounded); see {OutputChannel}
+      # @param overflow [Symbol] +:block+, +:drop_oldest+ or +:coalesce+
+      #   when +capacity+ is reached
+      # @param merge [Proc, nil] combines results for +overflow: :coalesce+
+      def initialize(app, data, worker: nil, capacity: nil, overflow: :block, merge: nil, &block)
         # Thread mode supports both block and worker class for API consistency
         @app = app
         @data = data
@@ -41,9 +55,17 @@ module Teek
         @paused = false
 
         # Communication channels
-        @output_queue = Thread::Queue.new    # Worker -> Main
+        @output_queue = OutputChannel.new(capacity: capacity, policy: overflow, merge: merge) # Worker -> Main
         @message_queue = Thread::Queue.new   # Main -> Worker
         @worker_thread = nil
+        @token = CancellationToken.new
+
+        # Main-thread wakeups: set by the worker when it queues a drain,
+        # cleared by the drain before it reads the output queue
+        @wakeup_pending = false
+        @drain_proc = proc { drain_output }
+        @dropped_count = 0
+        @choke_warned = false
       end
 
       def on_progress(&block)
@@ -80,22 +102,29 @@ module Teek
       def resume
         @paused = false
         send_message(:resume)
-        # Restart polling (was stopped when paused)
-        @app.after(0, &@poll_proc) if @poll_proc && !@done
+        # Deliver whatever the worker produced while paused
+        notify_main unless @done
         self
       end
 
+      # Ask the worker to stop, interrupting it if it is inside a
+      # {TaskContext#cancellable} block.
       def stop
         send_message(:stop)
+        @token.cancel
         self
       end
 
       def close
         @done = true
+        @token.cancel
         @worker_thread&.kill
         self
       end
 
+      # @return [CancellationToken] cancelled by {#stop} and {#close}
+      attr_reader :token
+
       def done?
         @done
       end
@@ -104,95 +133,105 @@ module Teek
         @paused
       end
 
+      # @return [Hash] output queue metrics; see {OutputChannel#stats}
+      def output_stats
+        @output_queue.stats
+      end
+
       def start
         return self if @started
         @started = true
 
-        @worker_thread = Thread.new do
-          Thread.current[:tk_in_background_work] = true
-          task = TaskContext.new(@output_queue, @message_queue)
-          begin
-            @work_block.call(task, @data)
-            @output_queue << [:done]
-          rescue StopIteration
-            @output_queue << [:done]
-          rescue => e
-            @output_queue << [:error, "#{e.class}: #{e.message}\n#{e.backtrace.first(3).join("\n")}"]
-            @output_queue << [:done]
-          end
-        end
-
-        start_polling
+        @worker_thread = Thread.new { run_worker }
         self
       end
 
       private
 
+      # The worker body: runs the work block on the current (background)
+      # thread and posts :done when it returns.
+      def run_worker
+        Thread.current[:tk_in_background_work] = true
+        task = TaskContext.new(@output_queue, @message_queue, -> { notify_main }, @token)
+        begin
+          @token.bind { @work_block.call(task, @data) }
+          @output_queue << [:done]
+        rescue StopIteration, CancellationToken::Cancelled
+          @output_queue << [:done]
+        rescue => e
+          @output_queue << [:error, "#{e.class}: #{e.message}\n#{e.backtrace.first(3).join("\n")}"]
+          @output_queue << [:done]
+        end
+        notify_main
+      end
+
       def maybe_start
         start unless @started
       end
 
-      def start_polling
-        @dropped_count = 0
-        @choke_warned = false
+      # Worker side: ask the main thread to drain the output queue.
+      # Skipped while a drain is already queued - that drain clears the
+      # flag before reading, so it also picks up this push.
+      def notify_main
+        return if @wakeup_pending
+        @wakeup_pending = true
+        @app.interp.queue_for_main(@drain_proc)
+      rescue Teek::TclError
+        # Interpreter gone, nothing left to deliver to
+      end
 
-        @poll_proc = proc do
-          next if @done
-
-          drop_intermediate = Teek::BackgroundWork.drop_intermediate
-          # Drain queue. If drop_intermediate, only use LATEST progress value.
-          # This prevents UI choking when worker yields faster than UI polls.
-          last_progress = nil
-          results_this_poll = 0
-          until @output_queue.empty?
-            msg = @output_queue.pop(true)
-            type, value = msg
-            case type
-            when :done
-              @done = true
-              # Call progress with final value before done callback
-              @callbacks[:progress]&.call(last_progress) if last_progress
-              last_progress = nil  # Prevent duplicate call after loop
-              warn_if_choked
-              @callbacks[:done]&.call
-              break
-            when :result
-              results_this_poll += 1
-              if drop_intermediate
-                last_progress = value  # Keep only latest
-              else
-                @callbacks[:progress]&.call(value)  # Call for every value
-              end
-            when :message
-              @callbacks[:message]&.call(value)
-            when :error
-              warn "[Thread] Background work error: #{value}"
+      def drain_output
+        @wakeup_pending = false
+        return if @done || @paused
+
+        # A bounded channel has already applied its overflow policy
+        drop_intermediate = Teek::BackgroundWork.drop_intermediate && !@output_queue.capacity
+        # Drain queue. If drop_intermediate, only use LATEST progress value.
+        # This prevents UI choking when worker yields faster than UI drains.
+        last_progress = nil
+        results_this_drain = 0
+        until @output_queue.empty?
+          msg = @output_queue.pop(true)
+          type, value = msg
+          case type
+          when :done
+            @done = true
+            # Call progress with final value before done callback
+            @callbacks[:progress]&.call(last_progress) if last_progress
+            last_progress = nil  # Prevent duplicate call after loop
+            warn_if_choked
+            @callbacks[:done]&.call
+            break
+          when :result
+            results_this_drain += 1
+            if drop_intermediate
+              last_progress = value  # Keep only latest
+            else
+              @callbacks[:progress]&.call(value)  # Call for every value
             end
+          when :message
+            @callbacks[:message]&.call(value)
+          when :error
+            warn "[Thread] Background work error: #{value}"
           end
+        end
 
-          # Track dropped messages (all but the last one we processed)
-          if drop_intermediate && results_this_poll > 1
-            dropped = results_this_poll - 1
-            @dropped_count += dropped
-            warn_choke_start(dropped) unless @choke_warned
-          end
-
-          # Call progress callback once with latest value (only if dropping)
-          @callbacks[:progress]&.call(last_progress) if drop_intermediate && last_progress && !@done
-
-          unless @done || @paused
-            @app.after(Teek::BackgroundWork.poll_ms, &@poll_proc)
-          end
+        # Track dropped messages (all but the last one we processed)
+        if drop_intermediate && results_this_drain > 1
+          dropped = results_this_drain - 1
+          @dropped_count += dropped
+          warn_choke_start(dropped) unless @choke_warned
         end
 
-        @app.after(0, &@poll_proc)
+        # Call progress callback once with latest value (only if dropping)
+        @callbacks[:progress]&.call(last_progress) if drop_intermediate && last_progress && !@done
       end
 
       def warn_choke_start(dropped)
         @choke_warned = true
-        warn "[Teek::BackgroundWork] UI choking: worker yielding faster than UI can poll. " \
+        warn "[Teek::BackgroundWork] UI choking: worker yielding faster than UI can drain. " \
              "#{dropped} progress values dropped this cycle. " \
-             "Consider yielding less frequently or increasing Tk.background_work_poll_ms."
+             "Consider yielding less frequently."
       end
 
       def warn_if_choked
@@ -203,16 +242,48 @@ module Teek
 
       # Context passed to the work block
       class TaskContext
-        def initialize(output_queue, message_queue)
+        # @return [CancellationToken] cancelled when the task is stopped
+        attr_reader :token
+
+        def initialize(output_queue, message_queue, notify, token = CancellationToken.new)
           @output_queue = output_queue
           @message_queue = message_queue
+          @notify = notify
+          @token = token
           @paused = false
         end
 
-        # Yield a result to the main thread.
+        # Run a blocking call (socket read, +IO.read+, +sleep+, ...) so that
+        # {BackgroundWork#stop} interrupts it instead of waiting for it to
+        # return. See {CancellationToken#cancellable}.
+        def cancellable(&block)
+          @token.cancellable(&block)
+        end
+
+        # Run the block with a deadline; raises +Timeout::Error+ if it
+        # takes longer than +seconds+. See {CancellationToken#with_timeout}.
+        def with_timeout(seconds, &block)
+          @token.with_timeout(seconds, &block)
+        end
+
+        # @return [Boolean] whether the task has been stopped
+        def cancelled?
+          @token.cancelled?
+        end
+
+        # Yield a result to the main thread, waking it if no delivery is
+        # already pending. With a bounded +:block+ channel this waits while
+        # the channel is full. Nothing is copied; +move:+ is accepted for
+        # parity with +:ractor+ mode.
         # Calls Thread.pass to give main thread a chance to process events.
-        def yield(value)
-          @output_queue << [:result, value]
+        def yield(value, move: false)
+          if @output_queue.blocking?
+            # A full :block channel waits here; stop must be able to end it
+            @token.cancellable { @output_queue.push_result(value) }
+          else
+            @output_queue.push_result(value)
+          end
+          @notify.call
           Thread.pass
         end
 
@@ -237,6 +308,7 @@ module Teek
         # Send a message back to main thread (not a result)
         def send_message(msg)
           @output_queue << [:message, msg]
+          @notify.call
         end
 
         # Check pause state, blocking if paused
@@ -87,6 +87,18 @@ module Teek
       counts
     end
 
+    # Diagnostic reverse lookup: which container and key each tracked
+    # callback id belongs to (e.g. +5 => [:bind, ".b", "<Button-1>"]).
+    # Used by {Teek::Tracer} to label callback spans.
+    # @return [Hash{Integer => Array}]
+    def owners
+      result = {}
+      @entries.each do |(tag, path), ids|
+        ids.each { |key, id| result[id] = [tag, path, key] }
+      end
+      result
+    end
+
     private
 
     # Convention, not a type check: every container is [feature_tag, path].
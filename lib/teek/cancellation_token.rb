@@ -0,0 +1,167 @@
+# frozen_string_literal: true
+
+require 'timeout'
+
+module Teek
+  # Cancellation for background workers that spend their time blocked in
+  # I/O rather than in a loop that polls +check_message+.
+  #
+  # Every +:thread+ and +:pool+ task has one (+task.token+), which
+  # {BackgroundWork#stop} and {BackgroundWork#close} cancel. Cancelling
+  # does two things:
+  #
+  # - runs the {#on_cancel} callbacks right away, on the cancelling thread -
+  #   the place to close a socket or file the worker is blocked on;
+  # - if the worker is inside a {#cancellable} block, raises {Cancelled}
+  #   in it, which interrupts a blocking read, sleep or queue pop.
+  #
+  # Outside +cancellable+ blocks the worker is never interrupted (the
+  # exception is held back with +Thread.handle_interrupt+), so code that
+  # updates shared state or holds a lock stays safe; the next
+  # +cancellable+ block, or {#check!}, raises instead. {Cancelled} is not
+  # a StandardError, so a +rescue => e+ around the I/O won't swallow it;
+  # +ensure+ blocks run as usual.
+  #
+  # @example
+  #   Teek::BackgroundWork.new(app, query) do |t, q|
+  #     sock = TCPSocket.new(host, port)
+  #     t.token.on_cancel { sock.close }
+  #     t.with_timeout(10) { t.yield(search(sock, q)) }
+  #   end
+  class CancellationToken
+    # Raised in a worker when its token is cancelled.
+    class Cancelled < Exception; end
+
+    def initialize
+      @mutex = Mutex.new
+      @cancelled = false
+      @callbacks = []
+      @thread = nil
+      @depth = 0
+      @deadline = nil
+    end
+
+    # @return [Boolean]
+    def cancelled?
+      @cancelled
+    end
+
+    # Cancel: run the {#on_cancel} callbacks and interrupt the worker if
+    # it is in a {#cancellable} block. Safe to call from any thread, more
+    # than once.
+    #
+    # @return [self]
+    def cancel
+      callbacks = @mutex.synchronize do
+        return self if @cancelled
+        @cancelled = true
+        @thread.raise(Cancelled, "cancelled") if @thread && @depth > 0
+        pending = @callbacks
+        @callbacks = []
+        pending
+      end
+      callbacks.each(&:call)
+      self
+    end
+
+    # Register a callback to run when the token is cancelled (immediately
+    # if it already is).
+    #
+    # @yield on the thread that cancels
+    # @return [self]
+    def on_cancel(&block)
+      already = @mutex.synchronize do
+        @callbacks << block unless @cancelled
+        @cancelled
+      end
+      block.call if already
+      self
+    end
+
+    # @raise [Cancelled] if the token has been cancelled
+    # @return [void]
+    def check!
+      raise Cancelled, "cancelled" if @cancelled
+    end
+
+    # Run the block where cancellation may interrupt it.
+    #
+    # @yield
+    # @raise [Cancelled] if the token is cancelled before or during the block
+    # @return [Object] the block's value
+    def cancellable
+      unless Thread.current.equal?(@thread)
+        check!
+        return yield
+      end
+
+      @mutex.synchronize { @depth += 1 }
+      begin
+        Thread.handle_interrupt(Cancelled => :immediate) do
+          check!
+          yield
+        end
+      ensure
+        @mutex.synchronize { @depth -= 1 }
+      end
+    end
+
+    # Run the block with a deadline +seconds+ from now (or the enclosing
+    # +with_timeout+'s deadline, if that is sooner). The block is
+    # {#cancellable}.
+    #
+    # Only a call that tightens the deadline starts a timer. Otherwise the
+    # enclosing one already covers the block, and a second timer due at
+    # the same moment would race it: the outer Timeout's internal
+    # exception could escape after the inner one had already fired.
+    #
+    # @param seconds [Numeric]
+    # @yield
+    # @raise [Timeout::Error] when the deadline passes
+    # @return [Object] the block's value
+    def with_timeout(seconds)
+      previous = @deadline
+      deadline = monotonic_now + seconds
+      if previous && previous <= deadline
+        raise Timeout::Error, "deadline passed" if remaining <= 0
+        return cancellable { yield }
+      end
+
+      @deadline = deadline
+      left = remaining
+      raise Timeout::Error, "deadline passed" if left <= 0
+      Timeout.timeout(left) { cancellable { yield } }
+    ensure
+      @deadline = previous
+    end
+
+    # @return [Float, nil] seconds left until the innermost
+    #   {#with_timeout} deadline, nil outside one - handy as a read
+    #   timeout for I/O calls that take one
+    def remaining
+      @deadline && @deadline - monotonic_now
+    end
+
+    # Run the worker body with this token attached to the current thread.
+    # Cancellation is held back outside {#cancellable} blocks; one that
+    # arrives at the very end is raised from here.
+    #
+    # @api private
+    def bind
+      Thread.handle_interrupt(Cancelled => :never) do
+        @mutex.synchronize { @thread = Thread.current }
+        begin
+          yield
+        ensure
+          @mutex.synchronize { @thread = nil }
+        end
+      end
+    end
+
+    private
+
+    def monotonic_now
+      Process.clock_gettime(Process::CLOCK_MONOTONIC)
+    end
+  end
+end
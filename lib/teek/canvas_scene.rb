@@ -0,0 +1,323 @@
+# frozen_string_literal: true
+
+module Teek
+  # Retained-mode drawing on a canvas: keep the scene in Ruby, change
+  # whatever moved, and push one frame's worth of changes to Tk at once.
+  #
+  # Driving an animation through {App#command} costs a full Tcl command
+  # per item per tick, whether the item changed or not. A scene instead
+  # remembers what it last sent for every {Item}. Setters only record
+  # the new state; {#commit} compares each touched item against what Tk
+  # already has, drops no-op changes (an item moved back where it was, a
+  # fill set to the color it already had) and sends the rest - creates,
+  # +coords+, +itemconfigure+ and deletes - in a single
+  # {Interp#canvas_apply} call, with coordinates passed as numbers
+  # rather than formatted strings.
+  #
+  # Items stack in creation order. Anything the scene doesn't model
+  # (bindings, raise/lower, scrolling) is still done with {App#command}
+  # on the canvas, using {Item#id} once the item has been committed.
+  #
+  # @example Bouncing balls
+  #   scene = Teek::CanvasScene.new(app, canvas)
+  #   balls = 500.times.map { |i| scene.add(:oval, [i, 0, i + 8, 8], fill: 'red') }
+  #   app.every(16) do
+  #     balls.each { |b| b.move(0, 1) }
+  #     balls.sample[:fill] = 'blue'
+  #     scene.commit
+  #   end
+  class CanvasScene
+    # One canvas item as the scene sees it.
+    class Item
+      attr_reader :scene, :type, :id, :coords
+
+      # @api private
+      def initialize(scene, type, coords, options)
+        @scene = scene
+        @type = type
+        @coords = coords
+        @options = options
+        @id = nil
+        @applied_coords = nil
+        @applied = {}
+        @sending = nil # [coords, options] diffed but not yet confirmed
+        @dirty = true # queued for creation by CanvasScene#add
+        @deleted = false
+      end
+
+      # @return [Boolean] whether the item exists on the canvas yet
+      def created?
+        !@id.nil?
+      end
+
+      # @return [Boolean]
+      def deleted?
+        @deleted
+      end
+
+      # Set the item's coordinates (a flat +[x0, y0, x1, y1, ...]+ list).
+      #
+      # @param coords [Array<Numeric>]
+      def coords=(coords)
+        @coords = coords.dup.freeze
+        touch
+      end
+
+      # Translate every coordinate.
+      #
+      # @param dx [Numeric]
+      # @param dy [Numeric]
+      # @return [self]
+      def move(dx, dy)
+        moved = @coords.dup
+        (0...moved.size).step(2) do |i|
+          moved[i] += dx
+          moved[i + 1] += dy
+        end
+        @coords = moved.freeze
+        touch
+        self
+      end
+
+      # @param option [Symbol] item option without the dash, e.g. +:fill+
+      # @return [Object] the value as last set in Ruby (nil if never set)
+      def [](option)
+        @options[option]
+      end
+
+      # @param option [Symbol]
+      # @param value [Object] String, Symbol, Numeric or Array
+      def []=(option, value)
+        @options[option] = value
+        touch
+      end
+
+      # Set several options at once.
+      #
+      # @return [self]
+      def configure(**options)
+        @options.merge!(options)
+        touch
+        self
+      end
+
+      # @return [Hash{Symbol => Object}] a copy of the item's options
+      def options
+        @options.dup
+      end
+
+      # Remove the item from the scene (and the canvas, on the next commit).
+      #
+      # @return [void]
+      def delete
+        @scene.delete(self)
+      end
+
+      def inspect
+        "#<Teek::CanvasScene::Item #{@type} id=#{@id.inspect} #{@coords.inspect}>"
+      end
+
+      # @api private
+      def mark_deleted
+        @deleted = true
+        @dirty = false
+      end
+
+      # @api private
+      def clean!
+        @dirty = false
+      end
+
+      # Append this item's pending changes to +ops+. They count as
+      # applied only once {#applied!} confirms the batch went through.
+      #
+      # @api private
+      # @return [Boolean] whether this is a create op
+      def diff_into(ops)
+        unless @id
+          ops << ['create', @type, @coords, *option_args(@options)]
+          @sending = [@coords, @options.dup]
+          return true
+        end
+
+        coords = nil
+        unless @coords.equal?(@applied_coords) || @coords == @applied_coords
+          ops << ['coords', @id, @coords]
+          coords = @coords
+        end
+
+        changed = nil
+        @options.each do |option, value|
+          next if @applied.key?(option) && @applied[option] == value
+          (changed ||= {})[option] = value
+        end
+        ops << ['itemconfigure', @id, *option_args(changed)] if changed
+        @sending = [coords, changed] if coords || changed
+        false
+      end
+
+      # The ops from the last {#diff_into} were applied.
+      #
+      # @api private
+      def applied!
+        return unless @sending
+        coords, options = @sending
+        @sending = nil
+        @applied_coords = coords if coords
+        @applied.merge!(options) if options
+      end
+
+      # The ops from the last {#diff_into} may not have been applied;
+      # queue the item for the next commit.
+      #
+      # @api private
+      def requeue
+        @sending = nil
+        touch
+      end
+
+      # @api private
+      def assign_id(id)
+        @id = id
+      end
+
+      private
+
+      def touch
+        return if @dirty || @deleted
+        @dirty = true
+        @scene.mark_dirty(self)
+      end
+
+      def option_args(options)
+        options.flat_map { |option, value| [OPTION_NAMES[option], value] }
+      end
+    end
+
+    # @api private
+    OPTION_NAMES = Hash.new { |h, option| h[option] = "-#{option}".freeze }
+
+    attr_reader :app, :canvas
+
+    # Stats for the last {#commit}: +:items+ touched, +:ops+ sent
+    # (including creates and deletes), +:skipped+ items whose changes
+    # all turned out to be no-ops.
+    #
+    # @return [Hash{Symbol => Integer}]
+    attr_reader :last_commit
+
+    # @param app [Teek::App]
+    # @param canvas [String, Widget] an existing canvas widget
+    def initialize(app, canvas)
+      @app = app
+      @canvas = canvas.to_s
+      @items = {}.compare_by_identity
+      @dirty = []
+      @deletes = []
+      @last_commit = { items: 0, ops: 0, skipped: 0 }
+    end
+
+    # Add an item. It's created on the canvas by the next {#commit}.
+    #
+    # @param type [Symbol, String] canvas item type (:rectangle, :oval,
+    #   :line, :polygon, :text, :image, ...)
+    # @param coords [Array<Numeric>] flat coordinate list
+    # @param options [Hash] item options without the dash
+    # @return [Item]
+    def add(type, coords, **options)
+      item = Item.new(self, type.to_s, coords.dup.freeze, options)
+      @items[item] = true
+      mark_dirty(item)
+      item
+    end
+
+    # Remove an item. Items never committed just disappear; others are
+    # deleted from the canvas by the next {#commit}.
+    #
+    # @param item [Item]
+    # @return [void]
+    def delete(item)
+      return if item.deleted?
+      item.mark_deleted
+      @items.delete(item)
+      @deletes << item.id if item.created?
+    end
+
+    # Remove every item.
+    #
+    # @return [void]
+    def clear
+      @items.keys.each { |item| delete(item) }
+    end
+
+    # @return [Array<Item>] live items in creation order
+    def items
+      @items.keys
+    end
+
+    # @return [Integer] number of live items
+    def size
+      @items.size
+    end
+
+    # @return [Boolean] whether there are changes not yet sent to Tk
+    def dirty?
+      !@dirty.empty? || !@deletes.empty?
+    end
+
+    # Send every pending change to the canvas in one native call.
+    #
+    # If Tk rejects an op, the error is raised. The ops before it stay
+    # applied (new items get their ids); the failed op and everything
+    # after it stay pending for the next commit.
+    #
+    # @return [Integer] number of Tcl commands sent
+    def commit
+      ops = []
+      created = []
+      sent = []
+      touched = 0
+      skipped = 0
+
+      deletes, @deletes = @deletes, []
+      deletes.each { |id| ops << ['delete', id] }
+
+      dirty, @dirty = @dirty, []
+      dirty.each do |item|
+        item.clean!
+        next if item.deleted?
+        touched += 1
+        before = ops.size
+        created << item if item.diff_into(ops)
+        if ops.size == before
+          skipped += 1
+        else
+          sent << [item, ops.size]
+        end
+      end
+
+      begin
+        ids = ops.empty? ? [] : @app.interp.canvas_apply(@canvas, ops)
+      rescue StandardError => e
+        done = e.is_a?(Teek::TclError) && e.failed_index || 0
+        @deletes.unshift(*deletes.drop(done))
+        e.created_ids.each_with_index { |id, i| created[i].assign_id(id) } if done > 0
+        sent.each do |item, ops_end|
+          next if item.deleted?
+          ops_end <= done ? item.applied! : item.requeue
+        end
+        raise
+      end
+      created.each_with_index { |item, i| item.assign_id(ids[i]) }
+      dirty.each(&:applied!)
+
+      @last_commit = { items: touched, ops: ops.size, skipped: skipped }
+      ops.size
+    end
+
+    # @api private
+    def mark_dirty(item)
+      @dirty << item
+    end
+  end
+end
@@ -0,0 +1,157 @@
+# frozen_string_literal: true
+
+module Teek
+  # Worker-to-UI queue for +:thread+ and +:pool+ BackgroundWork, optionally
+  # bounded.
+  #
+  # Unbounded (the default) it behaves like a +Thread::Queue+. With a
+  # +capacity:+, at most that many results wait for the UI; when a worker
+  # yields into a full channel the +policy+ decides what gives:
+  #
+  # - +:block+ - the worker waits until the UI has drained some results,
+  #   so a fast producer runs at the UI's pace in bounded memory
+  # - +:drop_oldest+ - the oldest waiting result is discarded
+  # - +:coalesce+ - the new result is merged into the newest waiting one
+  #   (replacing it, or combined by the +merge+ block, e.g. summing counts)
+  #
+  # Only results count towards the capacity. Control entries (+:done+,
+  # errors) and {BackgroundThread::BackgroundWork::TaskContext#send_message}
+  # messages are always accepted.
+  #
+  # @example
+  #   Teek::BackgroundWork.new(app, rows, capacity: 256, overflow: :block) do |t, rows|
+  #     rows.each { |row| t.yield(import(row)) }
+  #   end
+  class OutputChannel
+    POLICIES = %i[block drop_oldest coalesce].freeze
+
+    # @return [Integer, nil] maximum waiting results (nil = unbounded)
+    attr_reader :capacity
+
+    # @return [Symbol] overflow policy
+    attr_reader :policy
+
+    # @param capacity [Integer, nil]
+    # @param policy [Symbol] +:block+, +:drop_oldest+ or +:coalesce+
+    # @param merge [Proc, nil] for +:coalesce+: +(older, newer) -> merged+
+    #   (default: keep the newer value)
+    # @raise [ArgumentError] on a bad capacity or policy
+    def initialize(capacity: nil, policy: :block, merge: nil)
+      if capacity && capacity.to_i < 1
+        raise ArgumentError, "capacity must be positive (or nil for unbounded)"
+      end
+      unless POLICIES.include?(policy)
+        raise ArgumentError, "unknown overflow policy #{policy.inspect} (expected #{POLICIES.join(', ')})"
+      end
+
+      @capacity = capacity&.to_i
+      @policy = policy
+      @merge = merge
+      @mutex = Mutex.new
+      @not_full = ConditionVariable.new
+      @entries = []
+      @results = 0
+      @high_water = 0
+      @dropped = 0
+      @coalesced = 0
+      @blocked = 0
+      @blocked_time = 0.0
+    end
+
+    # @return [Boolean] whether {#push_result} can block the worker
+    def blocking?
+      !@capacity.nil? && @policy == :block
+    end
+
+    # Queue a result, applying the overflow policy when full.
+    #
+    # @param value [Object]
+    # @return [void]
+    def push_result(value)
+      @mutex.synchronize do
+        if @capacity && @results >= @capacity
+          case @policy
+          when :block
+            wait_for_room
+          when :drop_oldest
+            @entries.delete_at(@entries.index { |entry| entry[0] == :result })
+            @results -= 1
+            @dropped += 1
+          when :coalesce
+            index = @entries.rindex { |entry| entry[0] == :result }
+            older = @entries[index][1]
+            @entries[index] = [:result, @merge ? @merge.call(older, value) : value]
+            @coalesced += 1
+            return
+          end
+        end
+        @entries << [:result, value]
+        @results += 1
+        @high_water = @results if @results > @high_water
+      end
+    end
+
+    # Queue a control entry or message; never blocks or drops.
+    #
+    # @param entry [Array]
+    # @return [self]
+    def <<(entry)
+      @mutex.synchronize { @entries << entry }
+      self
+    end
+    alias push <<
+
+    # Take the oldest entry.
+    #
+    # @param non_block [Boolean] must be true; the UI side never waits
+    # @return [Array]
+    # @raise [ThreadError] if empty
+    def pop(non_block = true)
+      raise ArgumentError, "OutputChannel#pop is non-blocking only" unless non_block
+      @mutex.synchronize do
+        raise ThreadError, "queue empty" if @entries.empty?
+        entry = @entries.shift
+        if entry[0] == :result
+          @results -= 1
+          @not_full.signal
+        end
+        entry
+      end
+    end
+
+    # @return [Boolean]
+    def empty?
+      @entries.empty?
+    end
+
+    # @return [Integer] results waiting for the UI
+    def depth
+      @results
+    end
+
+    # Queue metrics: current +:depth+, +:capacity+, +:policy+,
+    # +:high_water+ (deepest the queue has been), +:dropped+ and
+    # +:coalesced+ results, how many times the worker +:blocked+ and for
+    # how long in total (+:blocked_time+, seconds).
+    #
+    # @return [Hash{Symbol => Object}]
+    def stats
+      @mutex.synchronize do
+        { depth: @results, capacity: @capacity, policy: @policy,
+          high_water: @high_water, dropped: @dropped, coalesced: @coalesced,
+          blocked: @blocked, blocked_time: @blocked_time }
+      end
+    end
+
+    private
+
+    # Called with @mutex held
+    def wait_for_room
+      @blocked += 1
+      started = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      @not_full.wait(@mutex) while @results >= @capacity
+    ensure
+      @blocked_time += Process.clock_gettime(Process::CLOCK_MONOTONIC) - started if started
+    end
+  end
+end
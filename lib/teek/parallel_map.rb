@@ -0,0 +1,329 @@
+# frozen_string_literal: true
+
+module Teek
+  # Data-parallel background work: run one block over many chunks on all
+  # cores and get the results back on the main thread in chunk order.
+  #
+  # Created with {BackgroundWork.parallel_map}. Each worker owns a deque of
+  # chunk indices, dealt round-robin up front; it works through its own
+  # deque from the front and, once that is empty, steals the back half of
+  # the fullest remaining deque. Uneven chunks (a filter that is cheap on
+  # flat regions and expensive on edges, report rows of different sizes)
+  # therefore keep every worker busy until the whole job is done.
+  #
+  # Results are reordered on the main thread: {#on_progress} sees chunk 0,
+  # then chunk 1, and so on, each as soon as it and everything before it
+  # has finished. Every result is delivered; +BackgroundWork.drop_intermediate+
+  # does not apply.
+  #
+  # In +:ractor+ mode (the default on Ruby 4.x) there is one Ractor per
+  # worker, and the block follows the same isolation rules as
+  # +BackgroundWork+ +:ractor+ mode: it may only use its arguments. Chunks
+  # are copied into the workers unless they are shareable
+  # (+Ractor.make_shareable+ avoids the copy for large frozen inputs);
+  # results are moved back rather than copied, unless +move: false+. In
+  # +:thread+ mode (the default on Ruby 3.x) workers are plain threads,
+  # so CPU-bound blocks only run in parallel where they release the GVL.
+  #
+  # Moving a result saves copying it, but takes it away from the worker:
+  # a block that keeps a reference to what it returns (in Ractor-local
+  # state, say, to reuse a buffer) hits +Ractor::MovedError+ the next
+  # time it touches it. Pass +move: false+ to have results copied.
+  #
+  # @example Filter an image in row bands
+  #   bands = rows.each_slice(32).map { |band| Ractor.make_shareable(band) }
+  #   Teek::BackgroundWork.parallel_map(app, bands) { |band| blur(band) }
+  #     .on_progress { |pixels, i| photo.put_block(pixels, 0, i * 32, w, 32) }
+  #     .on_done { |all| status.text = "#{all.size} bands" }
+  class ParallelMap
+    # @return [Integer] number of workers
+    attr_reader :workers
+
+    # @return [Symbol] +:ractor+ or +:thread+
+    attr_reader :mode
+
+    # @param app [Teek::App]
+    # @param chunks [Array] inputs, one block call each
+    # @param workers [Integer, nil] worker count (default
+    #   {BackgroundPool.size}, at most one per chunk)
+    # @param mode [Symbol, nil] +:ractor+ or +:thread+ (default +:ractor+
+    #   where supported)
+    # @param move [Boolean] +:ractor+ mode: move results back to the main
+    #   Ractor instead of copying them (ignored in +:thread+ mode)
+    # @yield [chunk, index] runs on a worker for every chunk
+    # @raise [ArgumentError] if +mode+ is unknown or unavailable
+    def initialize(app, chunks, workers: nil, mode: nil, move: true, &block)
+      raise ArgumentError, "parallel_map needs a block" unless block
+      mode ||= BackgroundWork::RACTOR_SUPPORTED ? :ractor : :thread
+      unless mode == :thread || (mode == :ractor && BackgroundWork::RACTOR_SUPPORTED)
+        raise ArgumentError, "Unknown or unsupported parallel_map mode: #{mode}"
+      end
+
+      @app = app
+      @chunks = chunks.to_a
+      @block = block
+      @mode = mode
+      @move = move ? true : false
+      @workers = (workers || BackgroundPool.size).to_i.clamp(1, [@chunks.size, 1].max)
+      @callbacks = { progress: nil, done: nil }
+      @started = false
+      @done = false
+
+      @scheduler = Scheduler.new(@chunks.size, @workers)
+      @output_queue = Thread::Queue.new # [index, status, value]
+      @finished = {}                    # out-of-order results by index
+      @results = []
+      @running = @chunks.empty? ? 0 : @workers
+
+      @wakeup_pending = false
+      @drain_proc = proc { drain_output }
+    end
+
+    # @yield [result, index] called on the main thread for each chunk, in
+    #   chunk order
+    # @return [self]
+    def on_progress(&block)
+      @callbacks[:progress] = block
+      maybe_start
+      self
+    end
+
+    # @yield [results] called on the main thread once every chunk has been
+    #   delivered (or, after {#stop}, with the results delivered so far)
+    # @return [self]
+    def on_done(&block)
+      @callbacks[:done] = block
+      maybe_start
+      self
+    end
+
+    # Start the workers. Called automatically by {#on_progress} and
+    # {#on_done}.
+    #
+    # @return [self]
+    def start
+      return self if @started
+      @started = true
+
+      if @chunks.empty?
+        notify_main
+      elsif @mode == :ractor
+        start_ractors
+      else
+        start_threads
+      end
+      self
+    end
+
+    # Hand out no more chunks. Chunks already running finish and are
+    # delivered if they are next in order; then {#on_done} fires.
+    #
+    # @return [self]
+    def stop
+      @scheduler.cancel
+      self
+    end
+
+    # Stop and drop any further output; no more callbacks fire.
+    #
+    # @return [self]
+    def close
+      @scheduler.cancel
+      @done = true
+      self
+    end
+
+    # @return [Boolean]
+    def done?
+      @done
+    end
+
+    # @return [Integer] number of steals so far
+    def steals
+      @scheduler.steals
+    end
+
+    private
+
+    def maybe_start
+      start unless @started
+    end
+
+    def start_threads
+      @threads = Array.new(@workers) do |worker|
+        Thread.new do
+          Thread.current[:tk_in_background_work] = true
+          while (index = @scheduler.take(worker))
+            @output_queue << run_chunk(index)
+            notify_main
+          end
+          @output_queue << [nil, :exit]
+          notify_main
+        end
+      end
+    end
+
+    def run_chunk(index)
+      [index, :ok, @block.call(@chunks[index], index)]
+    rescue => e
+      [index, :error, "#{e.class}: #{e.message}\n#{e.backtrace.first(3).join("\n")}"]
+    end
+
+    def start_ractors
+      isolation_error = false
+      begin
+        fn = Ractor.shareable_proc(&@block)
+      rescue Ractor::IsolationError
+        isolation_error = true
+      end
+      if isolation_error
+        raise Ractor::IsolationError,
+          "parallel_map block must not reference outside variables (including `app`). " \
+          "Pass everything it needs in the chunks."
+      end
+
+      out = Ractor::Port.new
+      ractors = Array.new(@workers) do |worker|
+        Ractor.new(worker, out, fn, @move) do |id, port, f, move|
+          # :nocov: -- Coverage.so cannot observe execution inside a Ractor
+          while (job = Ractor.receive)
+            index, chunk = job
+            begin
+              port.send([id, index, :ok, f.call(chunk, index)], move: move)
+            rescue => e
+              port.send([id, index, :error, "#{e.class}: #{e.message}\n#{e.backtrace.first(3).join("\n")}"])
+            end
+          end
+          # :nocov:
+        end
+      end
+
+      # Dispatcher: every worker has one chunk in flight; each result that
+      # comes back earns its worker the next index (its own or stolen).
+      @dispatch_thread = Thread.new do
+        live = 0
+        ractors.each_with_index { |r, w| live += 1 if feed(r, w) }
+        while live > 0
+          worker, index, status, value = out.receive
+          @output_queue << [index, status, value]
+          notify_main
+          live -= 1 unless feed(ractors[worker], worker)
+        end
+      end
+    end
+
+    # Send +worker+ its next chunk, or nil to let it exit.
+    def feed(ractor, worker)
+      index = @scheduler.take(worker)
+      ractor.send(index && [index, @chunks[index]])
+      return true if index
+      @output_queue << [nil, :exit]
+      notify_main
+      false
+    end
+
+    # Worker side: ask the main thread to drain the output queue (at most
+    # one drain queued at a time, as in BackgroundThread).
+    def notify_main
+      return if @wakeup_pending
+      @wakeup_pending = true
+      @app.interp.queue_for_main(@drain_proc)
+    rescue Teek::TclError
+      # Interpreter gone, nothing left to deliver to
+    end
+
+    def drain_output
+      @wakeup_pending = false
+      return if @done
+
+      until @output_queue.empty?
+        index, status, value = @output_queue.pop(true)
+        case status
+        when :ok
+          @finished[index] = value
+        when :error
+          report_error(index, value)
+          @finished[index] = nil
+        when :exit
+          @running -= 1
+        end
+      end
+
+      while @finished.key?(@results.size)
+        index = @results.size
+        value = @finished.delete(index)
+        @results << value
+        @callbacks[:progress]&.call(value, index)
+        return if @done # closed from the callback
+      end
+
+      finish if @results.size == @chunks.size || @running <= 0
+    end
+
+    def finish
+      @done = true
+      @callbacks[:done]&.call(@results)
+    end
+
+    def report_error(index, message)
+      if Teek::BackgroundWork.abort_on_error
+        raise RuntimeError, "[ParallelMap] chunk #{index} failed: #{message}"
+      else
+        warn "[ParallelMap] chunk #{index} failed: #{message}"
+      end
+    end
+
+    # Per-worker index deques with stealing. Owners take from the front
+    # (lowest index first, which keeps in-order delivery flowing); thieves
+    # take the back half of the fullest deque.
+    #
+    # @api private
+    class Scheduler
+      # @return [Integer]
+      attr_reader :steals
+
+      def initialize(count, workers)
+        @mutex = Mutex.new
+        @deques = Array.new(workers) { [] }
+        count.times { |i| @deques[i % workers] << i }
+        @steals = 0
+      end
+
+      # @return [Integer, nil] the next chunk index for +worker+, or nil
+      #   when no work is left anywhere
+      def take(worker)
+        @mutex.synchronize do
+          own = @deques[worker]
+          return own.shift unless own.empty?
+
+          victim = @deques.max_by(&:size)
+          return nil if victim.empty?
+          @steals += 1
+          own.concat(victim.pop((victim.size + 1) / 2))
+          own.shift
+        end
+      end
+
+      # Drop all remaining indices.
+      def cancel
+        @mutex.synchronize { @deques.each(&:clear) }
+      end
+    end
+  end
+
+  class BackgroundWork
+    # Map a block over +chunks+ in parallel; see {ParallelMap}.
+    #
+    # @param app [Teek::App]
+    # @param chunks [Array]
+    # @param workers [Integer, nil]
+    # @param mode [Symbol, nil] +:ractor+ or +:thread+
+    # @param move [Boolean] move results back instead of copying them
+    #   (+:ractor+ mode)
+    # @yield [chunk, index]
+    # @return [ParallelMap]
+    def self.parallel_map(app, chunks, workers: nil, mode: nil, move: true, &block)
+      ParallelMap.new(app, chunks, workers: workers, mode: mode, move: move, &block)
+    end
+  end
+end
@@ -75,6 +75,60 @@ module Teek
           end
         end
       end
+
+      # Decode a PNG or PPM/PGM image off the main thread.
+      #
+      # Tk's own +-file+ loading decodes on the main thread, freezing the
+      # UI for large images. This returns an empty photo immediately and
+      # decodes on a worker thread in native code with the GVL released;
+      # once done, the pixels land in the photo with a single
+      # +Tk_PhotoPutBlock+ on the main thread and the block is called.
+      # Widgets can be given the photo right away - Tk redraws them when
+      # the pixels arrive.
+      #
+      # @example Open an image-heavy screen without blocking input
+      #   tiles = paths.map do |path|
+      #     Teek::Photo.decode_async(app, path) { |photo| relayout }
+      #   end
+      #
+      # @param app [Teek::App] the application instance
+      # @param source [String, #to_path] a file path, or a String holding
+      #   the encoded image (recognized by its PNG / PPM signature)
+      # @param name [String, nil] Tcl image name (auto-generated if nil)
+      # @param on_error [Proc, nil] called on the main thread with the
+      #   exception if reading or decoding fails; when nil the error is
+      #   reported with +warn+ and the photo stays empty
+      # @yield [photo] on the main thread once the pixels are in place
+      # @return [Photo] the (initially empty) photo
+      def decode_async(app, source, name: nil, on_error: nil, &on_load)
+        photo = new(app, name: name)
+        source = source.to_path if source.respond_to?(:to_path)
+
+        Thread.new do
+          decoded = error = nil
+          begin
+            decoded = Teek._decode_image(source)
+          rescue StandardError => e
+            error = e
+          end
+
+          begin
+            app.interp.queue_for_main(proc {
+              if error
+                on_error ? on_error.call(error) : warn("Teek::Photo.decode_async: #{error.message}")
+              elsif photo.exist?
+                width, height, rgba = decoded
+                photo.put_block(rgba, width, height)
+                on_load&.call(photo)
+              end
+            })
+          rescue Teek::TclError
+            # interpreter torn down while we were decoding - nowhere to deliver
+          end
+        end
+
+        photo
+      end
     end
 
     # Create a new photo image.
@@ -130,28 +184,43 @@ module Teek
       @app.command(@name, *args, **kwargs)
     end
 
-    # Write RGBA pixel data to the image.
+    # Write pixel data to the image.
     #
-    # @param pixel_data [String] binary string, 4 bytes (RGBA) per pixel
+    # +:rgba+ and +:argb+ data is handed to Tk as-is. +:rgb+, +:gray+ and
+    # premultiplied data are converted to RGBA first by native SIMD
+    # kernels (+Teek.pixel_convert_impl+ names the set in use).
+    #
+    # Tk reads +pixel_data+ in place, String or IO::Buffer alike. Frames
+    # produced by a +:ractor+ BackgroundWork arrive without a copy when
+    # the worker yields them frozen or moved (see
+    # {BackgroundRactor4x::BackgroundWork::TaskContext#yield}), so they go
+    # from the worker's memory to Tk untouched.
+    #
+    # @param pixel_data [String, IO::Buffer] 4 bytes per pixel for
+    #   +:rgba+/+:argb+, 3 for +:rgb+, 1 for +:gray+
     # @param width [Integer] width of the pixel block
     # @param height [Integer] height of the pixel block
     # @param x [Integer] destination X offset
     # @param y [Integer] destination Y offset
-    # @param format [:rgba, :argb] pixel format
+    # @param format [:rgba, :argb, :rgb, :gray] pixel format (+:argb+ is
+    #   0xAARRGGBB integers, i.e. B,G,R,A bytes on little-endian hosts)
+    # @param premultiplied [Boolean] color channels are already multiplied
+    #   by alpha (as produced by most compositors); undone before writing
     # @param composite [:set, :overlay] compositing rule
     # @return [self]
-    def put_block(pixel_data, width, height, x: 0, y: 0, format: :rgba, composite: :set)
-      opts = { x: x, y: y, format: format, composite: composite }
+    def put_block(pixel_data, width, height, x: 0, y: 0, format: :rgba,
+                  premultiplied: false, composite: :set)
+      opts = { x: x, y: y, format: format, premultiplied: premultiplied, composite: composite }
       @app.interp.photo_put_block(@name, pixel_data, width, height, opts)
       self
     end
 
-    # Write RGBA pixel data with zoom and subsample.
+    # Write pixel data with zoom and subsample.
     #
     # Zoom replicates each pixel (zoom=3 makes each source pixel 3x3).
     # Subsample skips source pixels (subsample=2 takes every other pixel).
     #
-    # @param pixel_data [String] binary string, 4 bytes (RGBA) per pixel
+    # @param pixel_data [String, IO::Buffer] sized for +format+ as in {#put_block}
     # @param width [Integer] source width in pixels
     # @param height [Integer] source height in pixels
     # @param x [Integer] destination X offset
@@ -160,23 +229,160 @@ module Teek
     # @param zoom_y [Integer] vertical zoom factor
     # @param subsample_x [Integer] horizontal subsample factor
     # @param subsample_y [Integer] vertical subsample factor
-    # @param format [:rgba, :argb] pixel format
+    # @param format [:rgba, :argb, :rgb, :gray] pixel format
+    # @param premultiplied [Boolean] color channels are already multiplied by alpha
     # @param composite [:set, :overlay] compositing rule
     # @return [self]
     def put_zoomed_block(pixel_data, width, height,
                          x: 0, y: 0, zoom_x: 1, zoom_y: 1,
                          subsample_x: 1, subsample_y: 1,
-                         format: :rgba, composite: :set)
+                         format: :rgba, premultiplied: false, composite: :set)
       opts = {
         x: x, y: y,
         zoom_x: zoom_x, zoom_y: zoom_y,
         subsample_x: subsample_x, subsample_y: subsample_y,
-        format: format, composite: composite
+        format: format, premultiplied: premultiplied, composite: composite
       }
       @app.interp.photo_put_zoomed_block(@name, pixel_data, width, height, opts)
       self
     end
 
+    # Write a raw frame straight from a memory-mapped file.
+    #
+    # The file is mapped read-only and Tk reads the frame directly from
+    # the mapped pages, so there's no Ruby String and no extra copy per
+    # frame. The mapping is created on first use and kept for later calls
+    # with the same +path_or_fd+ - it's remapped only if the file's size
+    # changes, or a path comes to name a different file (a writer that
+    # renames each finished frame into place). Mappings are released by
+    # {#delete} or {#close_mmaps}.
+    #
+    # Writers must not truncate the file below a frame being read - as
+    # with any mmap, that kills the process with SIGBUS.
+    #
+    # @example Camera frames in shared memory
+    #   loop do
+    #     wait_for_frame
+    #     photo.put_from_mmap("/dev/shm/cam0", width: 1280, height: 720, format: :rgb)
+    #   end
+    #
+    # @param path_or_fd [String, #to_path, IO, Integer, MappedFile] the
+    #   file to map. IOs and descriptors stay owned by the caller and must
+    #   stay open while in use here.
+    # @param offset [Integer] byte offset of the frame's first pixel
+    # @param width [Integer] frame width in pixels
+    # @param height [Integer] frame height in pixels
+    # @param stride [Integer, nil] bytes per row in the file (nil for
+    #   tightly packed rows)
+    # @param format [:rgba, :argb, :rgb, :gray] pixel format, as in {#put_block}
+    # @param x [Integer] destination X offset
+    # @param y [Integer] destination Y offset
+    # @param composite [:set, :overlay] compositing rule
+    # @return [self]
+    # @raise [ArgumentError] if the frame runs past the end of the file
+    def put_from_mmap(path_or_fd, width:, height:, offset: 0, stride: nil,
+                      format: :rgba, x: 0, y: 0, composite: :set)
+      mapped = if path_or_fd.is_a?(MappedFile)
+                 path_or_fd
+               else
+                 @mapped_files ||= {}
+                 key = path_or_fd.respond_to?(:to_path) ? path_or_fd.to_path : path_or_fd
+                 @mapped_files[key] ||= MappedFile.new(key)
+               end
+      opts = { offset: offset, width: width, height: height, stride: stride,
+               format: format, x: x, y: y, composite: composite }
+      mapped.put_photo(@app.interp, @name, opts)
+      self
+    end
+
+    # Unmap every file mapped by {#put_from_mmap}.
+    #
+    # @return [void]
+    def close_mmaps
+      return unless @mapped_files
+      @mapped_files.each_value(&:close)
+      @mapped_files = nil
+    end
+
+    # Scale this image (or a region of it) into another photo at any ratio.
+    #
+    # Unlike {#put_zoomed_block} and Tk's +copy -zoom+, the ratio needn't
+    # be an integer. Runs natively across several threads with the GVL
+    # released, and writes the result to +dest+ in one block.
+    #
+    # @example HiDPI: scale a 1x asset by 1.5
+    #   icon.resample_to(icon2x, width: 48, height: 48)
+    #
+    # @param dest [Photo] destination image (may be +self+)
+    # @param width [Integer, nil] destination width (nil for +dest+'s width)
+    # @param height [Integer, nil] destination height (nil for +dest+'s height)
+    # @param x [Integer] destination X offset
+    # @param y [Integer] destination Y offset
+    # @param from [Array<Integer>, nil] source region +[x, y, width, height]+
+    #   (nil for the whole image)
+    # @param filter [:nearest, :bilinear, :area] +:area+ averages every
+    #   covered source pixel - best for thumbnails; +:bilinear+ suits
+    #   upscaling and mild reductions; +:nearest+ keeps hard pixel edges
+    # @param threads [Integer, nil] worker thread cap (nil for CPU count)
+    # @param composite [:set, :overlay] compositing rule
+    # @return [self]
+    def resample_to(dest, width: nil, height: nil, x: 0, y: 0, from: nil,
+                    filter: :bilinear, threads: nil, composite: :set)
+      opts = { x: x, y: y, filter: filter, composite: composite }
+      opts[:width] = width if width
+      opts[:height] = height if height
+      opts[:threads] = threads if threads
+      if from
+        opts[:src_x], opts[:src_y], opts[:src_width], opts[:src_height] = from
+      end
+      @app.interp.photo_resample(@name, dest.name, opts)
+      self
+    end
+
+    # A new photo holding this image scaled to +width+ x +height+.
+    #
+    # @example Thumbnail grid
+    #   thumbs = photos.map { |p| p.scaled(96, 72, filter: :area) }
+    #
+    # @param width [Integer] new width
+    # @param height [Integer] new height
+    # @param filter [:nearest, :bilinear, :area] see {#resample_to}
+    # @return [Photo]
+    def scaled(width, height, filter: :bilinear)
+      dest = Photo.new(@app, width: width, height: height)
+      resample_to(dest, width: width, height: height, filter: filter)
+      dest
+    end
+
+    # Create a {PhotoFramebuffer} targeting this image: a persistent RGBA
+    # buffer in C memory that remembers which regions were written, so
+    # {PhotoFramebuffer#flush} pushes only those regions instead of the
+    # whole image. For paint-style apps that change a few pixels per event.
+    #
+    # The framebuffer starts fully transparent and clean; pass
+    # +reload: true+ to start from the image's current pixels instead.
+    #
+    # @example Draw a few pixels, push only what changed
+    #   fb = photo.framebuffer
+    #   fb.set_pixel(10, 10, 255, 0, 0)
+    #   fb.fill_rect(40, 40, 8, 8, 0, 0, 255)
+    #   fb.flush  # => 2 (one Tk_PhotoPutBlock per dirty region)
+    #
+    # @param width [Integer, nil] buffer width (nil for the image's width)
+    # @param height [Integer, nil] buffer height (nil for the image's height)
+    # @param reload [Boolean] copy the image's current pixels into the buffer
+    # @return [PhotoFramebuffer]
+    def framebuffer(width: nil, height: nil, reload: false)
+      if width.nil? || height.nil?
+        w, h = get_size
+        width ||= w
+        height ||= h
+      end
+      fb = PhotoFramebuffer.new(@app.interp, @name, width, height)
+      fb.reload if reload
+      fb
+    end
+
     # Read pixel data from the image.
     #
     # @param x [Integer] source X offset
@@ -184,10 +390,13 @@ module Teek
     # @param width [Integer, nil] region width (nil for full image)
     # @param height [Integer, nil] region height (nil for full image)
     # @param unpack [Boolean] if true, return flat array of integers instead of binary string
+    # @param format [:rgba, :argb, :rgb, :gray] layout of the returned pixels
+    # @param premultiply [Boolean] multiply color channels by alpha
     # @return [Hash] +{ data: String, width: Integer, height: Integer }+ or
     #   +{ pixels: Array<Integer>, width: Integer, height: Integer }+ if unpack is true
-    def get_image(x: nil, y: nil, width: nil, height: nil, unpack: false)
-      opts = { unpack: unpack }
+    def get_image(x: nil, y: nil, width: nil, height: nil, unpack: false,
+                  format: :rgba, premultiply: false)
+      opts = { unpack: unpack, format: format, premultiply: premultiply }
       opts[:x] = x if x
       opts[:y] = y if y
       opts[:width] = width if width
@@ -195,6 +404,37 @@ module Teek
       @app.interp.photo_get_image(@name, opts)
     end
 
+    # Read pixel data into an existing buffer instead of allocating a new
+    # String per call - for capture and analysis loops that read the same
+    # region every frame.
+    #
+    # A String buffer is resized to exactly +width * height+ times the
+    # format's bytes per pixel (a no-op once it's the right size, so its
+    # memory is reused). An IO::Buffer must already be at least that large.
+    #
+    # @example Reuse one buffer across frames
+    #   buf = String.new(capacity: 640 * 480 * 4, encoding: Encoding::BINARY)
+    #   loop { photo.read_into(buf); analyze(buf) }
+    #
+    # @param buffer [String, IO::Buffer] destination, pixels written from byte 0
+    # @param x [Integer] source X offset
+    # @param y [Integer] source Y offset
+    # @param width [Integer, nil] region width (nil for full image)
+    # @param height [Integer, nil] region height (nil for full image)
+    # @param format [:rgba, :argb, :rgb, :gray] layout of the written pixels
+    # @param premultiply [Boolean] multiply color channels by alpha
+    # @return [Array<Integer>] [width, height] of the region written
+    #   (clamped to the image, same as {#get_image})
+    def read_into(buffer, x: nil, y: nil, width: nil, height: nil,
+                  format: :rgba, premultiply: false)
+      opts = { format: format, premultiply: premultiply }
+      opts[:x] = x if x
+      opts[:y] = y if y
+      opts[:width] = width if width
+      opts[:height] = height if height
+      @app.interp.photo_read_into(@name, buffer, opts)
+    end
+
     # Read a single pixel.
     #
     # @param x [Integer] X coordinate
@@ -254,6 +494,7 @@ module Teek
     # @return [void]
     def delete
       ObjectSpace.undefine_finalizer(self)
+      close_mmaps
       @app.tcl_eval("image delete #{@name}")
     end
 
@@ -0,0 +1,288 @@
+# frozen_string_literal: true
+
+module Teek
+  # Many small images packed into one large {Photo}.
+  #
+  # Tile maps and sprite sheets otherwise end up as one Tk photo per tile:
+  # hundreds of Tcl image commands, each with its own pixel buffer and
+  # its own {Photo} finalizer. An atlas stores every sprite in a single
+  # photo and hands out lightweight {Sprite} views - just a rectangle.
+  # A view only becomes a real Tk image when something needs an image
+  # name (a canvas item, a label), at which point its pixels are copied
+  # out of the atlas buffer with one +Tk_PhotoPutBlock+
+  # ({Interp#photo_copy_region}). Sprites that are never displayed cost
+  # nothing beyond their pixels in the atlas.
+  #
+  # Sprites are placed with a shelf packer: rows of sprites, each new
+  # sprite going into the shortest row it fits in. The atlas photo has a
+  # fixed width and grows downward as rows are added.
+  #
+  # Materialized sprite images belong to the atlas and are deleted with
+  # it; there are no per-sprite finalizers.
+  #
+  # @example Tile map
+  #   atlas = Teek::PhotoAtlas.new(app)
+  #   Dir["tiles/*.png"].each { |path| atlas.add_file(File.basename(path, ".png"), path) }
+  #   canvas.command(:create, :image, x, y, image: atlas["grass"], anchor: :nw)
+  class PhotoAtlas
+    # A rectangle of the atlas. Behaves like an image name wherever one is
+    # expected (+to_s+ materializes it), so it can be passed straight to
+    # +image:+ options.
+    class Sprite
+      attr_reader :atlas, :key, :x, :y, :width, :height
+
+      # @api private
+      def initialize(atlas, key, x, y, width, height)
+        @atlas = atlas
+        @key = key
+        @x = x
+        @y = y
+        @width = width
+        @height = height
+        @image_name = nil
+      end
+
+      # The Tk image name for this sprite, creating and filling the image
+      # from the atlas on first use.
+      #
+      # @return [String]
+      def image_name
+        @image_name ||= @atlas.materialize(self)
+      end
+      alias to_s image_name
+
+      # @return [Boolean] whether a Tk image has been created for this sprite
+      def materialized?
+        !@image_name.nil?
+      end
+
+      # Delete this sprite's Tk image, if any. The sprite stays in the
+      # atlas and is materialized again the next time it's used.
+      #
+      # @return [void]
+      def release
+        return unless @image_name
+        @atlas.app.tcl_eval("catch {image delete #{@image_name}}")
+        @image_name = nil
+      end
+
+      # Copy the atlas pixels into the materialized image again, after the
+      # sprite has been redrawn with {PhotoAtlas#replace}.
+      #
+      # @api private
+      def refresh
+        return unless @image_name
+        @atlas.app.interp.photo_copy_region(@atlas.photo.name, @image_name,
+          src_x: @x, src_y: @y, width: @width, height: @height)
+      end
+
+      # Read the sprite's pixels from the atlas.
+      #
+      # @return [String] RGBA bytes, +width * height * 4+ long
+      def pixels
+        @atlas.photo.get_image(x: @x, y: @y, width: @width, height: @height)[:data]
+      end
+
+      def inspect
+        "#<Teek::PhotoAtlas::Sprite #{@key.inspect} #{@width}x#{@height}+#{@x}+#{@y}>"
+      end
+    end
+
+    attr_reader :app, :photo, :width, :padding
+
+    @counter = 0
+
+    class << self
+      # @api private
+      def next_prefix
+        @counter += 1
+        "teek_atlas#{@counter}"
+      end
+    end
+
+    # @param app [Teek::App] the application instance
+    # @param width [Integer] atlas width in pixels; sprites wider than this
+    #   can't be added
+    # @param height [Integer] initial atlas height; grows as needed
+    # @param padding [Integer] transparent pixels left between sprites
+    def initialize(app, width: 1024, height: 256, padding: 1)
+      raise ArgumentError, "width must be positive" unless width > 0
+      raise ArgumentError, "padding must be non-negative" if padding < 0
+
+      @app = app
+      @width = width
+      @padding = padding
+      @photo = Photo.new(app, width: width, height: height)
+      @prefix = self.class.next_prefix
+      @sprites = {}
+      @shelves = [] # [y, height, next_x]
+      @bottom = 0
+      @image_count = 0
+    end
+
+    # Add a sprite from raw pixel data.
+    #
+    # @param key [Object] lookup key for {#[]}
+    # @param pixel_data [String] pixels as for {Photo#put_block}
+    # @param width [Integer]
+    # @param height [Integer]
+    # @param format [:rgba, :argb, :rgb, :gray] layout of +pixel_data+
+    # @return [Sprite]
+    # @raise [ArgumentError] if +key+ is already taken or the sprite is
+    #   wider than the atlas
+    def add(key, pixel_data, width, height, format: :rgba)
+      sprite = allocate_sprite(key, width, height)
+      @photo.put_block(pixel_data, width, height, x: sprite.x, y: sprite.y, format: format)
+      sprite
+    end
+
+    # Add a sprite decoded from a PNG or PPM/PGM file (or String holding
+    # one), without going through a temporary Tk photo.
+    #
+    # @param key [Object]
+    # @param source [String, #to_path]
+    # @return [Sprite]
+    def add_file(key, source)
+      source = source.to_path if source.respond_to?(:to_path)
+      width, height, rgba = Teek._decode_image(source)
+      add(key, rgba, width, height)
+    end
+
+    # Add a sprite copied from (a region of) an existing photo. The source
+    # can be deleted afterwards.
+    #
+    # @param key [Object]
+    # @param source [Photo, String] photo or Tcl image name
+    # @param from [Array<Integer>, nil] source region +[x, y, width, height]+
+    # @return [Sprite]
+    def add_photo(key, source, from: nil)
+      src_x, src_y, width, height = from || [0, 0, *@app.interp.photo_get_size(source.to_s)]
+      sprite = allocate_sprite(key, width, height)
+      @app.interp.photo_copy_region(source.to_s, @photo.name,
+        src_x: src_x, src_y: src_y, width: width, height: height,
+        x: sprite.x, y: sprite.y)
+      sprite
+    end
+
+    # Overwrite a sprite's pixels in place. Its size can't change.
+    # Already-materialized images are updated too.
+    #
+    # @param key [Object]
+    # @param pixel_data [String]
+    # @param format [:rgba, :argb, :rgb, :gray]
+    # @return [Sprite]
+    def replace(key, pixel_data, format: :rgba)
+      sprite = fetch(key)
+      @photo.put_block(pixel_data, sprite.width, sprite.height,
+                       x: sprite.x, y: sprite.y, format: format)
+      sprite.refresh
+      sprite
+    end
+
+    # @param key [Object]
+    # @return [Sprite, nil]
+    def [](key)
+      @sprites[key]
+    end
+
+    # @param key [Object]
+    # @return [Sprite]
+    # @raise [KeyError] if no sprite has that key
+    def fetch(key)
+      @sprites.fetch(key)
+    end
+
+    # @return [Boolean]
+    def key?(key)
+      @sprites.key?(key)
+    end
+
+    # @return [Array<Object>] sprite keys in insertion order
+    def keys
+      @sprites.keys
+    end
+
+    # @return [Integer] number of sprites
+    def size
+      @sprites.size
+    end
+
+    # @yield [sprite]
+    def each(&block)
+      @sprites.each_value(&block)
+    end
+
+    # Height of the atlas area in use (the photo itself may be taller).
+    #
+    # @return [Integer]
+    def used_height
+      @bottom
+    end
+
+    # Delete every materialized sprite image but keep the atlas, e.g.
+    # when leaving a level whose tiles will be used again later.
+    #
+    # @return [void]
+    def release_all
+      @sprites.each_value(&:release)
+    end
+
+    # Delete the atlas photo and all sprite images.
+    #
+    # @return [void]
+    def delete
+      release_all
+      @sprites.clear
+      @shelves.clear
+      @photo.delete
+    end
+
+    # Create the Tk image for a sprite and fill it from the atlas.
+    #
+    # @api private
+    def materialize(sprite)
+      @image_count += 1
+      name = "#{@prefix}_#{@image_count}"
+      @app.command(:image, :create, :photo, name, width: sprite.width, height: sprite.height)
+      @app.interp.photo_copy_region(@photo.name, name,
+        src_x: sprite.x, src_y: sprite.y, width: sprite.width, height: sprite.height)
+      name
+    end
+
+    private
+
+    def allocate_sprite(key, width, height)
+      raise ArgumentError, "width and height must be positive" unless width > 0 && height > 0
+      raise ArgumentError, "sprite #{key.inspect} already in atlas" if @sprites.key?(key)
+      if width > @width
+        raise ArgumentError, "sprite #{key.inspect} is #{width}px wide, atlas is #{@width}px"
+      end
+
+      x, y = place(width + @padding, height + @padding)
+      @photo.expand(@width, y + height) if y + height > @photo.get_size[1]
+      @sprites[key] = Sprite.new(self, key, x, y, width, height)
+    end
+
+    # Shelf packing: the shortest shelf that's tall enough and has room,
+    # otherwise a new shelf at the bottom. Cell sizes include padding,
+    # except that the last column/row may run flush to the atlas edge.
+    def place(cell_w, cell_h)
+      best = nil
+      @shelves.each do |shelf|
+        next if shelf[1] < cell_h
+        next if shelf[2] + cell_w - @padding > @width
+        best = shelf if best.nil? || shelf[1] < best[1]
+      end
+
+      unless best
+        best = [@bottom, cell_h, 0]
+        @shelves << best
+        @bottom += cell_h
+      end
+
+      x = best[2]
+      best[2] += cell_w
+      [x, best[0]]
+    end
+  end
+end
@@ -10,6 +10,8 @@
 # The implementation is selected automatically based on Ruby version.
 
 require_relative 'background_thread'
+require_relative 'background_pool'
+require_relative 'parallel_map'
 
 if Ractor.respond_to?(:shareable_proc)
   require_relative 'background_ractor4x'
@@ -25,6 +27,11 @@ module Teek
   #   is released during blocking calls. Always available.
   # - +:ractor+ — true parallel execution via Ractor (Ruby 4.x+ only); best
   #   for CPU-bound work.
+  # - +:pool+ — like +:thread+, but tasks share a fixed-size pool of threads
+  #   per app and wait in a priority queue (+priority:+); for many small jobs.
+  #   See {BackgroundPool}.
+  #
+  # For splitting one CPU-bound job across cores, see {.parallel_map}.
   #
   # @example Basic usage
   #   task = Teek::BackgroundWork.new(app, data, mode: :thread) do |t, d|
@@ -44,10 +51,13 @@ module Teek
   #   Teek::BackgroundWork.abort_on_error = false
   class BackgroundWork
     class << self
-      # @return [Integer] UI poll interval in milliseconds (default 16)
+      # @return [Integer] UI poll interval in milliseconds for +:ractor+
+      #   mode (default 16). +:thread+ mode delivers results as they're
+      #   yielded and doesn't poll.
       attr_accessor :poll_ms
       # @return [Boolean] when true, only the latest progress value per poll
-      #   cycle is delivered (default true)
+      #   cycle is delivered (default true). Ignored by tasks created with
+      #   a +capacity:+, whose overflow policy decides instead.
       attr_accessor :drop_intermediate
       # @return [Boolean] when true, raise on ractor errors instead of warning
       #   (default false)
@@ -80,6 +90,7 @@ module Teek
 
     # Register built-in modes
     register_background_mode :thread, Teek::BackgroundThread::BackgroundWork
+    register_background_mode :pool, Teek::BackgroundPool::BackgroundWork
 
     # Ractor mode only available on Ruby 4.x+
     if RACTOR_SUPPORTED
@@ -91,25 +102,28 @@ module Teek
 
     # @param app [Teek::App] the application instance
     # @param data [Object] data passed to the worker block
-    # @param mode [Symbol] +:thread+ or +:ractor+
+    # @param mode [Symbol] +:thread+, +:pool+ or +:ractor+
     # @param worker [Class, nil] optional worker class (must respond to +#call(task, data)+)
+    # @param options [Hash] mode-specific options: +priority:+ for +:pool+;
+    #   +capacity:+, +overflow:+ and +merge:+ for +:thread+ and +:pool+
+    #   (a bounded output queue, see {OutputChannel})
     # @yield [task, data] block executed in the background
     # @yieldparam task [BackgroundThread::BackgroundWork::TaskContext, BackgroundRactor4x::BackgroundWork::TaskContext]
     # @yieldparam data [Object]
     # @raise [ArgumentError] if mode is unknown
-    def initialize(app, data, mode: :thread, worker: nil, &block)
+    def initialize(app, data, mode: :thread, worker: nil, **options, &block)
       impl_class = self.class.background_mode_class(mode)
       unless impl_class
         available = self.class.background_modes.keys.join(', ')
         raise ArgumentError, "Unknown mode: #{mode}. Available: #{available}"
       end
 
-      @impl = impl_class.new(app, data, worker: worker, &block)
+      @impl = impl_class.new(app, data, worker: worker, **options, &block)
       @mode = mode
       @name = nil
     end
 
-    # @return [Symbol] the active mode (+:thread+ or +:ractor+)
+    # @return [Symbol] the active mode (+:thread+, +:pool+ or +:ractor+)
     def mode
       @mode
     end
@@ -124,6 +138,13 @@ module Teek
       @impl.paused?
     end
 
+    # Output queue metrics (+:thread+ and +:pool+ modes); see
+    # {OutputChannel#stats}.
+    # @return [Hash, nil] nil in modes without an output channel
+    def output_stats
+      @impl.output_stats if @impl.respond_to?(:output_stats)
+    end
+
     # @yield [value] called on the main thread with each result
     # @return [self]
     def on_progress(&block)
@@ -238,8 +259,8 @@ module Teek
         @task = task
       end
 
-      def yield(value)
-        @task.yield(value)
+      def yield(value, move: false)
+        @task.yield(value, move: move)
       end
     end
   end
@@ -0,0 +1,156 @@
+# frozen_string_literal: true
+
+require 'json'
+
+module Teek
+  # Event-loop latency tracer, for finding what stalls the UI thread.
+  #
+  # While tracing, the C extension records a span for each
+  # {Interp#mainloop} iteration (the notifier +wait+ and the event
+  # handling after it, +DoOneEvent+), each Ruby callback run from Tcl,
+  # each event queued from a background thread, and spans reported by
+  # other extensions (teek-sdl2's +Renderer#present+). Spans go into a
+  # fixed-size ring buffer, so tracing can stay on in the field: the
+  # newest +capacity+ spans are always there to dump after a stall.
+  #
+  # {.dump} writes Chrome trace JSON - open it in +chrome://tracing+ or
+  # https://ui.perfetto.dev.
+  #
+  # Setting +TEEK_TRACE=path.json+ starts tracing at load and dumps to
+  # that path at exit.
+  #
+  # @example Catch 100 ms stalls
+  #   Teek::Tracer.start(min_us: 1_000)
+  #   app.mainloop
+  #   Teek::Tracer.stalls(100).each { |s| warn "#{s.name} #{s.detail}: #{s.duration_us / 1000} ms" }
+  #   Teek::Tracer.dump("trace.json", app: app)
+  module Tracer
+    # Span kinds - values match enum teek_trace_kind in tcltkbridge.h
+    KINDS = %i[iteration wait callback thread_event external].freeze
+
+    # One recorded span. +value+ is the callback id for +:callback+ and
+    # the time spent waiting in the queue (us) for +:thread_event+.
+    Span = Struct.new(:kind, :name, :detail, :value, :start_us, :duration_us)
+
+    DEFAULT_CAPACITY = 16_384
+
+    class << self
+      # Start recording. Spans already in the ring are kept unless the
+      # capacity changes.
+      #
+      # @param capacity [Integer] spans kept (rounded up to a power of two)
+      # @param min_us [Integer] drop spans shorter than this
+      # @return [void]
+      def start(capacity: DEFAULT_CAPACITY, min_us: 0)
+        Teek._trace_start(capacity, min_us)
+      end
+
+      # Stop recording; the spans stay available.
+      # @return [void]
+      def stop
+        Teek._trace_stop
+      end
+
+      # @return [Boolean]
+      def tracing?
+        Teek._trace_enabled?
+      end
+
+      # Discard all recorded spans.
+      # @return [void]
+      def clear
+        Teek._trace_clear
+      end
+
+      # @return [Array<Span>] recorded spans, oldest first
+      def spans
+        snapshot.last
+      end
+
+      # @return [Integer] spans lost to the ring wrapping around
+      def overwritten
+        snapshot.first
+      end
+
+      # Spans of real work (not notifier waits) that took at least
+      # +threshold_ms+, longest first.
+      #
+      # @param threshold_ms [Numeric]
+      # @return [Array<Span>]
+      def stalls(threshold_ms = 100)
+        limit = threshold_ms * 1000
+        spans.reject { |s| s.kind == :wait }
+             .select { |s| s.duration_us >= limit }
+             .sort_by { |s| -s.duration_us }
+      end
+
+      # The trace as a Chrome trace event Hash.
+      #
+      # @param app [Teek::App, nil] when given, callback spans also name
+      #   what registered them (e.g. +[:bind, ".b"]+) from its callback
+      #   registry
+      # @return [Hash]
+      def to_chrome_trace(app: nil)
+        owners = app ? callback_owners(app) : {}
+        pid = Process.pid
+        overwritten, recorded = snapshot
+
+        events = [
+          { name: 'process_name', ph: 'M', pid: pid, tid: 1, args: { name: 'teek' } },
+          { name: 'thread_name', ph: 'M', pid: pid, tid: 1, args: { name: 'main (Tcl)' } },
+        ]
+        recorded.each do |span|
+          events << chrome_event(span, pid, owners)
+        end
+
+        { traceEvents: events, displayTimeUnit: 'ms',
+          otherData: { overwritten: overwritten } }
+      end
+
+      # Write the trace as Chrome trace JSON.
+      #
+      # @param path [String]
+      # @param app [Teek::App, nil] see {.to_chrome_trace}
+      # @return [String] path
+      def dump(path, app: nil)
+        File.write(path, JSON.generate(to_chrome_trace(app: app)))
+        path
+      end
+
+      private
+
+      def snapshot
+        overwritten, raw = Teek._trace_snapshot
+        [overwritten, raw.map { |kind, *rest| Span.new(KINDS.fetch(kind, :external), *rest) }]
+      end
+
+      def chrome_event(span, pid, owners)
+        event = { name: span.name, cat: span.kind.to_s, ph: 'X', pid: pid, tid: 1,
+                  ts: span.start_us, dur: span.duration_us }
+        case span.kind
+        when :callback
+          event[:name] = "callback #{span.value}"
+          args = { id: span.value }
+          args[:widget] = span.detail if span.detail
+          args[:owner] = owners[span.value].inspect if owners.key?(span.value)
+          event[:args] = args
+        when :thread_event
+          event[:args] = { queue_wait_us: span.value }
+          event[:args][:command] = span.detail if span.detail
+        when :external
+          event[:args] = { detail: span.detail } if span.detail
+        end
+        event
+      end
+
+      def callback_owners(app)
+        app.callback_registry.owners
+      end
+    end
+  end
+end
+
+if (trace_path = ENV['TEEK_TRACE']) && !trace_path.empty?
+  Teek::Tracer.start
+  at_exit { Teek::Tracer.dump(trace_path) }
+end
@@ -0,0 +1,441 @@
+# frozen_string_literal: true
+
+module Teek
+  # A scrolling list/table that only ever materializes the rows on screen.
+  #
+  # +ttk::treeview+ keeps every item in Tk and needs one +insert+ per row,
+  # which stops being usable somewhere around a few tens of thousands of
+  # rows. VirtualList draws onto a plain canvas instead: it keeps one
+  # pool of canvas items per visible row slot, asks the data provider
+  # only for the rows scrolled into view, and on scroll recycles the
+  # slots - rows that stay visible are just moved, and only slots that
+  # wrap around to a new row get new text. Row count is limited only by
+  # what the provider can serve.
+  #
+  # Fetched rows are cached already truncated to their column widths
+  # ({App#fit_text}), so scrolling back and forth costs no provider calls
+  # and no text measuring.
+  #
+  # The provider is any object with +size+ and either +rows(first, count)+
+  # (preferred - one call per newly exposed range) or +[](index)+. A row
+  # is an Array with one value per column (a bare value for single-column
+  # lists). An Array works as-is; a native extension can implement
+  # +rows+ to serve straight from its own storage.
+  #
+  # @example A million-row log view
+  #   provider = Struct.new(:log) do
+  #     def size = log.line_count
+  #     def rows(first, count) = log.lines(first, count).map { |l| [l.time, l.level, l.text] }
+  #   end.new(log)
+  #   list = Teek::VirtualList.new(app, provider,
+  #     columns: [{ title: 'Time', width: 90 }, { title: 'Level', width: 60 }, { title: 'Message' }])
+  #   app.command(:pack, list, fill: :both, expand: 1)
+  #   list.on_select { |index| show_details(index) }
+  #   # ... later, when lines were appended:
+  #   list.reload
+  class VirtualList
+    # @api private
+    Column = Struct.new(:title, :width, :anchor, :stretch)
+
+    # @api private
+    Slot = Struct.new(:tag, :bg, :texts, :row, :y, :selected, :hidden)
+
+    attr_reader :app, :frame, :canvas, :scrollbar, :provider, :columns,
+                :row_height, :font, :selection
+
+    # @param app [Teek::App]
+    # @param provider [#size] row source, see class docs
+    # @param parent [String, Widget, nil] parent widget path
+    # @param columns [Array<Hash>, nil] +{ title:, width:, anchor: }+ per
+    #   column; a column without +width:+ takes the space left over. nil
+    #   means one untitled column.
+    # @param font [String] font description for rows and header
+    # @param row_height [Integer, nil] pixels per row (nil: font linespace + 4)
+    # @param width [Integer] initial canvas width
+    # @param height [Integer] initial canvas height
+    # @param cache_rows [Integer] how many fetched rows to keep (never
+    #   fewer than fit on screen)
+    # @param colors [Hash] overrides for +:background+, +:foreground+,
+    #   +:stripe+, +:header+, +:select_background+, +:select_foreground+
+    # @raise [ArgumentError] if +row_height+ isn't positive
+    def initialize(app, provider, parent: nil, columns: nil, font: 'TkDefaultFont',
+                   row_height: nil, width: 400, height: 300, cache_rows: 4096,
+                   colors: {})
+      @app = app
+      @provider = provider
+      @font = font
+      @font_handle = app.font_handle(font)
+      @row_height = (row_height || app.font_metrics(@font_handle)[:linespace] + 4).to_i
+      raise ArgumentError, "row_height must be positive (got #{row_height.inspect})" unless @row_height.positive?
+      @cache_rows = cache_rows
+      @colors = DEFAULT_COLORS.merge(colors)
+      @columns = build_columns(columns)
+      @header_height = @columns.any?(&:title) ? @row_height + 2 : 0
+
+      @offset = 0
+      @selection = nil
+      @slots = []
+      @row_cache = {}
+      @canvas_width = width
+      @view_height = height - @header_height
+      @on_select = nil
+
+      build_widgets(parent, width, height)
+      layout_columns
+      draw_header
+      render
+    end
+
+    # @return [String] the outer frame's path, so the list can be passed
+    #   straight to +pack+/+grid+
+    def to_s
+      @frame.to_s
+    end
+
+    # @yield [index] when the selected row changes (nil when cleared)
+    # @return [void]
+    def on_select(&block)
+      @on_select = block
+    end
+
+    # Re-read the provider: drops cached rows and redraws. Call after the
+    # data or its size changed.
+    #
+    # @return [void]
+    def reload
+      @row_cache.clear
+      @slots.each { |slot| slot.row = nil }
+      @selection = nil if @selection && @selection >= @provider.size
+      render
+    end
+
+    # Drop cached rows in +range+ (e.g. rows that were edited) and redraw.
+    #
+    # @param range [Range]
+    # @return [void]
+    def invalidate(range)
+      range.each { |i| @row_cache.delete(i) }
+      @slots.each { |slot| slot.row = nil if slot.row && range.cover?(slot.row) }
+      render
+    end
+
+    # @return [Range] indices of the rows at least partly on screen
+    def visible_range
+      first = @offset / @row_height
+      last = [(@offset + @view_height - 1) / @row_height, @provider.size - 1].min
+      first..last
+    end
+
+    # Scroll so that row +index+ is fully visible.
+    #
+    # @param index [Integer]
+    # @return [void]
+    def see(index)
+      top = index * @row_height
+      if top < @offset
+        scroll_to(top)
+      elsif top + @row_height > @offset + @view_height
+        scroll_to(top + @row_height - @view_height)
+      end
+    end
+
+    # Select row +index+ (nil to clear) and scroll it into view.
+    #
+    # @param index [Integer, nil]
+    # @return [void]
+    def select(index)
+      index = nil if index && (index < 0 || index >= @provider.size)
+      return if index == @selection
+
+      @selection = index
+      see(index) if index
+      render
+      @on_select&.call(index)
+    end
+
+    # Scroll to a pixel offset from the top of the content.
+    #
+    # @param offset [Integer]
+    # @return [void]
+    def scroll_to(offset)
+      @offset = offset.to_i
+      render
+    end
+
+    # Scroll by a number of rows (negative is up).
+    #
+    # @param rows [Integer]
+    # @return [void]
+    def scroll_rows(rows)
+      scroll_to(@offset + rows * @row_height)
+    end
+
+    # Bring the canvas up to date: clamp the offset, fetch and fit any
+    # newly exposed rows, then move or refill the slots.
+    #
+    # @return [void]
+    def render
+      total = @provider.size
+      max_offset = [total * @row_height - @view_height, 0].max
+      @offset = @offset.clamp(0, max_offset)
+
+      nslots = @view_height / @row_height + 2
+      grow_slots(nslots) if nslots > @slots.size
+      nslots = @slots.size
+
+      first = @offset / @row_height
+      last = [first + nslots, total].min
+      fetch(first, last) if first < last
+
+      shift = @offset % @row_height
+      shown = Array.new(nslots, false)
+      (first...last).each do |row|
+        shown[row % nslots] = true
+        place_slot(@slots[row % nslots], row, @header_height + (row - first) * @row_height - shift)
+      end
+      @slots.each_with_index { |slot, k| hide_slot(slot) unless shown[k] }
+
+      update_scrollbar(total)
+    end
+
+    # @api private
+    DEFAULT_COLORS = {
+      background: 'white', foreground: 'black', stripe: '#f3f3f3',
+      header: '#e4e4e4', select_background: '#3874d8', select_foreground: 'white'
+    }.freeze
+
+    # Horizontal text padding inside a cell
+    # @api private
+    CELL_PAD = 4
+
+    private
+
+    def build_columns(specs)
+      specs ||= [{}]
+      specs.map do |spec|
+        Column.new(spec[:title], spec[:width], (spec[:anchor] || :w).to_sym, spec[:width].nil?)
+      end
+    end
+
+    def build_widgets(parent, width, height)
+      @frame = @app.create_widget('ttk::frame', parent: parent)
+      @canvas = @app.create_widget('canvas', parent: @frame,
+        width: width, height: height, highlightthickness: 0, borderwidth: 0,
+        background: @colors[:background], takefocus: 1)
+      @scrollbar = @app.create_widget('ttk::scrollbar', parent: @frame, orient: :vertical,
+        command: proc { |*args| on_scrollbar(*args) })
+      @cpath = @canvas.to_s
+
+      @app.command(:grid, @canvas, row: 0, column: 0, sticky: :nsew)
+      @app.command(:grid, @scrollbar, row: 0, column: 1, sticky: :ns)
+      @app.command(:grid, :rowconfigure, @frame, 0, weight: 1)
+      @app.command(:grid, :columnconfigure, @frame, 0, weight: 1)
+
+      @app.bind(@canvas, 'Configure', :width, :height) { |w, h| on_resize(w.to_i, h.to_i) }
+      @app.bind(@canvas, 'Button-1', :y) { |y| on_click(y.to_i) }
+      @app.bind(@canvas, 'MouseWheel', :mouse_wheel) { |d| on_wheel(d.to_i) }
+      @app.bind(@canvas, 'Button-4') { scroll_rows(-3) }
+      @app.bind(@canvas, 'Button-5') { scroll_rows(3) }
+      page = proc { [@view_height / @row_height - 1, 1].max }
+      {
+        'Up' => -> { -1 }, 'Down' => -> { 1 },
+        'Prior' => -> { -page.call }, 'Next' => -> { page.call },
+        'Home' => -> { -@provider.size }, 'End' => -> { @provider.size }
+      }.each do |key, delta|
+        @app.bind(@canvas, key) { move_selection(delta.call) }
+      end
+    end
+
+    # Give stretch columns the width the fixed ones leave over.
+    def layout_columns
+      fixed = @columns.reject(&:stretch).sum(&:width)
+      stretchy = @columns.select(&:stretch)
+      unless stretchy.empty?
+        each = [(@canvas_width - fixed) / stretchy.size, 20].max
+        stretchy.each { |col| col.width = each }
+      end
+      x = 0
+      @column_x = @columns.map { |col| x.tap { x += col.width } }
+    end
+
+    def draw_header
+      @app.tcl_invoke(@cpath, 'delete', 'header')
+      return if @header_height.zero?
+
+      @app.tcl_invoke(@cpath, 'create', 'rectangle', '0', '0', @canvas_width.to_s,
+                      @header_height.to_s, '-fill', @colors[:header], '-outline', '',
+                      '-tags', 'header')
+      @columns.each_with_index do |col, i|
+        title = @app.fit_text(@font_handle, [col.title.to_s], [col.width - 2 * CELL_PAD, 0].max).first
+        @app.tcl_invoke(@cpath, 'create', 'text', text_x(i).to_s, (@header_height / 2).to_s,
+                        '-text', title, '-anchor', col.anchor.to_s, '-font', @font,
+                        '-fill', @colors[:foreground], '-tags', 'header')
+      end
+      @app.tcl_invoke(@cpath, 'raise', 'header')
+    end
+
+    def text_x(col_index)
+      col = @columns[col_index]
+      left = @column_x[col_index]
+      case col.anchor
+      when :e, :ne, :se then left + col.width - CELL_PAD
+      when :center, :n, :s then left + col.width / 2
+      else left + CELL_PAD
+      end
+    end
+
+    def grow_slots(count)
+      (@slots.size...count).each do |k|
+        tag = "vslot#{k}"
+        bg = @app.tcl_invoke(@cpath, 'create', 'rectangle', '0', '0', '0', '0',
+                             '-outline', '', '-state', 'hidden', '-tags', tag)
+        texts = @columns.each_index.map do |i|
+          @app.tcl_invoke(@cpath, 'create', 'text', text_x(i).to_s, '0', '-anchor',
+                          @columns[i].anchor.to_s, '-font', @font, '-state', 'hidden',
+                          '-tags', tag)
+        end
+        @slots << Slot.new(tag, bg, texts, nil, nil, false, true)
+      end
+      # Slot rows are reassigned by row % slot count, so a new pool size
+      # means every slot may be showing the wrong row
+      @slots.each { |slot| slot.row = nil }
+      @app.tcl_invoke(@cpath, 'raise', 'header') unless @header_height.zero?
+    end
+
+    # Fetch and fit every uncached row in first...last with one provider call.
+    def fetch(first, last)
+      missing = (first...last).reject { |i| @row_cache.key?(i) }
+      return if missing.empty?
+
+      from = missing.first
+      count = missing.last - from + 1
+      rows = if @provider.respond_to?(:rows)
+               @provider.rows(from, count)
+             else
+               (from...from + count).map { |i| @provider[i] }
+             end
+
+      cells = rows.map { |row| row.is_a?(Array) ? row : [row] }
+      fitted_columns = @columns.each_with_index.map do |col, c|
+        @app.fit_text(@font_handle, cells.map { |row| row[c].to_s },
+                      [col.width - 2 * CELL_PAD, 0].max)
+      end
+      cells.each_index do |r|
+        @row_cache[from + r] = fitted_columns.map { |column| column[r] }
+      end
+
+      # Oldest first, but never the rows being shown
+      excess = @row_cache.size - [@cache_rows, @slots.size].max
+      return unless excess > 0
+      @row_cache.each_key.lazy.reject { |i| i >= first && i < last }.first(excess)
+                .each { |i| @row_cache.delete(i) }
+    end
+
+    def place_slot(slot, row, y)
+      selected = row == @selection
+      if slot.row != row
+        texts = @row_cache[row] || Array.new(@columns.size, '')
+        slot.texts.each_with_index do |id, i|
+          @app.tcl_invoke(@cpath, 'itemconfigure', id, '-text', texts[i])
+        end
+        slot.selected = nil
+      end
+      if slot.selected != selected || slot.row != row
+        bg = if selected then @colors[:select_background]
+             elsif row.odd? then @colors[:stripe]
+             else @colors[:background]
+             end
+        fg = selected ? @colors[:select_foreground] : @colors[:foreground]
+        @app.tcl_invoke(@cpath, 'itemconfigure', slot.bg, '-fill', bg)
+        slot.texts.each { |id| @app.tcl_invoke(@cpath, 'itemconfigure', id, '-fill', fg) }
+        slot.selected = selected
+      end
+      if slot.y.nil?
+        @app.tcl_invoke(@cpath, 'coords', slot.bg, '0', y.to_s, @canvas_width.to_s,
+                        (y + @row_height).to_s)
+        slot.texts.each_with_index do |id, i|
+          @app.tcl_invoke(@cpath, 'coords', id, text_x(i).to_s, (y + @row_height / 2).to_s)
+        end
+      elsif slot.y != y
+        @app.tcl_invoke(@cpath, 'move', slot.tag, '0', (y - slot.y).to_s)
+      end
+      @app.tcl_invoke(@cpath, 'itemconfigure', slot.tag, '-state', 'normal') if slot.hidden
+      slot.row = row
+      slot.y = y
+      slot.hidden = false
+    end
+
+    def hide_slot(slot)
+      return if slot.hidden
+      @app.tcl_invoke(@cpath, 'itemconfigure', slot.tag, '-state', 'hidden')
+      slot.hidden = true
+      slot.row = nil
+    end
+
+    def update_scrollbar(total)
+      content = total * @row_height
+      if content <= 0 || content <= @view_height
+        @app.tcl_invoke(@scrollbar.to_s, 'set', '0', '1')
+      else
+        lo = @offset.fdiv(content)
+        hi = (@offset + @view_height).fdiv(content)
+        @app.tcl_invoke(@scrollbar.to_s, 'set', lo.to_s, hi.to_s)
+      end
+    end
+
+    def on_scrollbar(action, amount = nil, unit = nil)
+      case action
+      when 'moveto'
+        scroll_to((amount.to_f * @provider.size * @row_height).round)
+      when 'scroll'
+        step = unit == 'pages' ? [@view_height - @row_height, @row_height].max : @row_height
+        scroll_to(@offset + amount.to_i * step)
+      end
+    end
+
+    def on_wheel(delta)
+      return if delta.zero?
+      # Windows reports multiples of 120 per notch (3 rows each); macOS
+      # reports small deltas of any size, one row per event
+      rows = delta.abs >= 120 ? delta.abs / 120 * 3 : 1
+      scroll_rows(delta.positive? ? -rows : rows)
+    end
+
+    def on_click(y)
+      @app.tcl_invoke('focus', @cpath)
+      return if y < @header_height
+      index = (y - @header_height + @offset) / @row_height
+      select(index) if index < @provider.size
+    end
+
+    def move_selection(delta)
+      return if @provider.size.zero?
+      current = @selection || (delta.positive? ? -1 : @provider.size)
+      select((current + delta).clamp(0, @provider.size - 1))
+    end
+
+    def on_resize(width, height)
+      view = height - @header_height
+      return if width == @canvas_width && view == @view_height
+
+      width_changed = width != @canvas_width
+      @canvas_width = width
+      @view_height = [view, 0].max
+      if width_changed && @columns.any?(&:stretch)
+        layout_columns
+        @row_cache.clear
+        rebuild_slots
+        draw_header
+      elsif width_changed
+        @slots.each { |slot| slot.y = nil }
+        draw_header
+      end
+      render
+    end
+
+    def rebuild_slots
+      @slots.each { |slot| @app.tcl_invoke(@cpath, 'delete', slot.tag) }
+      @slots.clear
+    end
+  end
+end
@@ -12,6 +12,15 @@ module Teek
   #
   # @see https://www.tcl-lang.org/man/tcl9.0/TkCmd/winfo.htm winfo
   class Winfo
+    # One window from {#subtree}. +parent+ is the index of the parent
+    # window's entry in the same result (nil for the root); +x+/+y+ are
+    # screen coordinates.
+    WindowInfo = Struct.new(:path, :class_name, :parent, :x, :y, :width, :height,
+                            :mapped, :toplevel) do
+      alias_method :mapped?, :mapped
+      alias_method :toplevel?, :toplevel
+    end
+
     # @api private
     def initialize(app)
       @app = app
@@ -95,6 +104,27 @@ module Teek
       query('ismapped', path) == '1'
     end
 
+    # Geometry of a window and every descendant, gathered in a single
+    # native call ({Interp#subtree_geometry}) instead of one query per
+    # window per attribute.
+    #
+    # @example Outline every mapped widget
+    #   app.winfo.subtree.select(&:mapped?).each do |w|
+    #     overlay.rect(w.x, w.y, w.width, w.height)
+    #   end
+    #
+    # @param root [String, Widget] where to start (default: the main window)
+    # @return [Array<WindowInfo>] depth-first, root first
+    def subtree(root = '.')
+      raw = @app.interp.subtree_geometry(root.to_s)
+      paths = raw[:paths]
+      classes = raw[:classes]
+      raw[:geometry].unpack('l*').each_slice(6).with_index.map do |(parent, x, y, w, h, flags), i|
+        WindowInfo.new(paths[i], classes[i], parent < 0 ? nil : parent, x, y, w, h,
+                       flags & 1 != 0, flags & 2 != 0)
+      end
+    end
+
     private
 
     def query(subcommand, path)
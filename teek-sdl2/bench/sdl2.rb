@@ -0,0 +1,142 @@
+# frozen_string_literal: true
+
+# teek-sdl2 rendering, texture upload and audio paths. Runs headless: with
+# no DISPLAY it uses SDL's dummy video and audio drivers, and draws into
+# an offscreen software renderer, so the numbers measure teek-sdl2 and
+# SDL's CPU paths rather than a GPU or a compositor.
+#
+#   rake sdl2:bench
+#   rake sdl2:bench BENCH=texture BENCH_TIME=3
+#
+# Output goes to tmp/bench/sdl2-<commit>.json in the same format as the
+# bridge suite, so `rake bench:compare` works on it too.
+
+unless ENV['DISPLAY'] || RUBY_PLATFORM =~ /darwin|mingw|mswin/
+  ENV['SDL_VIDEODRIVER'] ||= 'dummy'
+  ENV['SDL_AUDIODRIVER'] ||= 'dummy'
+end
+
+require 'teek/sdl2'
+require_relative '../../bench/bench_helper'
+
+WIDTH = 640
+HEIGHT = 480
+
+renderer = Teek::SDL2.create_offscreen_renderer(WIDTH, HEIGHT)
+suite = TeekBench::Suite.new('sdl2')
+suite.meta(sdl: Teek::SDL2.sdl_version, video_driver: ENV['SDL_VIDEODRIVER'],
+           audio_driver: ENV['SDL_AUDIODRIVER'])
+
+puts "teek-sdl2 benchmarks (SDL #{Teek::SDL2.sdl_version}, #{RUBY_DESCRIPTION})\n\n"
+
+# MB/s for a benchmark that moves +bytes+ per op
+mb_per_sec = ->(result, bytes) { (bytes * result[:ops_per_sec] / 1e6).round(1) }
+
+# ---------------------------------------------------------
+# Texture upload
+# ---------------------------------------------------------
+
+[[64, 64], [256, 240], [640, 480], [1280, 720]].each do |w, h|
+  texture = renderer.create_texture(w, h, :streaming)
+  frame = ([0xFF, 200, 100, 50].pack('C4') * (w * h)).freeze
+
+  result = suite.measure('texture_update', size: "#{w}x#{h}", bytes: frame.bytesize) do |n|
+    n.times { texture.update(frame) }
+  end
+  puts format("%-34s %12.1f MB/s", '', mb_per_sec.(result, frame.bytesize)) if result
+
+  texture.destroy
+end
+
+# ---------------------------------------------------------
+# Pixel conversion
+# ---------------------------------------------------------
+
+# NES-sized frame, the optcarrot case pack_uint32 exists for
+nes = Array.new(256 * 240) { |i| 0xFF000000 | (i * 2654435761 & 0xFFFFFF) }.freeze
+suite.measure('pixels_pack_uint32', size: '256x240') do |n|
+  n.times { Teek::SDL2::Pixels.pack_uint32(nes, 256, 240) }
+end
+
+{ rgba8888: 4, rgb888: 3, gray8: 1 }.each do |format, bpp|
+  source = Random.new(format.hash).bytes(WIDTH * HEIGHT * bpp).freeze
+  result = suite.measure('pixels_convert', from: format, size: "#{WIDTH}x#{HEIGHT}",
+                         bytes: source.bytesize) do |n|
+    n.times { Teek::SDL2::Pixels.convert(source, WIDTH, HEIGHT, format) }
+  end
+  puts format("%-34s %12.1f MB/s", '', mb_per_sec.(result, source.bytesize)) if result
+end
+
+# ---------------------------------------------------------
+# Draw calls
+# ---------------------------------------------------------
+
+suite.measure('fill_rect', size: '32x32') do |n|
+  n.times { |i| renderer.fill_rect(i % (WIDTH - 32), i % (HEIGHT - 32), 32, 32, 255, 0, 0) }
+end
+
+suite.measure('draw_line') do |n|
+  n.times { |i| renderer.draw_line(0, i % HEIGHT, WIDTH - 1, HEIGHT - 1 - i % HEIGHT, 0, 255, 0) }
+end
+
+sprite = renderer.create_texture(32, 32, :streaming)
+sprite.update(([0xFF, 0, 0, 255].pack('C4') * (32 * 32)).freeze)
+src = [0, 0, 32, 32]
+
+suite.measure('copy', size: '32x32') do |n|
+  n.times { |i| renderer.copy(sprite, src, [i % (WIDTH - 32), i % (HEIGHT - 32), 32, 32]) }
+end
+
+suite.measure('copy', size: "#{WIDTH}x#{HEIGHT}", scaled: true) do |n|
+  n.times { renderer.copy(sprite, nil, nil) }
+end
+
+# A sprite-game frame: clear, 200 sprites, present
+suite.measure('frame', sprites: 200, group: :macro) do |n|
+  n.times do
+    renderer.clear
+    200.times { |i| renderer.copy(sprite, src, [(i * 37) % (WIDTH - 32), (i * 53) % (HEIGHT - 32), 32, 32]) }
+    renderer.present
+  end
+end
+
+sprite.destroy
+
+# ---------------------------------------------------------
+# Text
+# ---------------------------------------------------------
+
+font_path = File.join(Teek::SDL2::ASSETS_DIR, 'JetBrainsMonoNL-Regular.ttf')
+font = renderer.load_font(font_path, 16)
+
+['FPS: 60', 'The quick brown fox jumps over the lazy dog 0123456789'].each do |text|
+  suite.measure('font_render_text', chars: text.length) do |n|
+    n.times { font.render_text(text, 255, 255, 255).destroy }
+  end
+end
+
+font.destroy
+
+# ---------------------------------------------------------
+# Audio
+# ---------------------------------------------------------
+
+if Teek::SDL2::AudioStream.available?
+  stream = Teek::SDL2::AudioStream.new(frequency: 44100, format: :s16, channels: 2)
+
+  # One 60 Hz video frame worth of stereo s16 audio, and a 10 ms chunk
+  [735, 441].each do |samples|
+    chunk = ([0, 0].pack('s<2') * samples).freeze
+    suite.measure('audio_stream_queue', samples: samples, bytes: chunk.bytesize) do |n|
+      n.times { stream.queue(chunk) }
+      stream.clear
+    end
+  end
+
+  stream.destroy
+else
+  puts "(no audio device - skipping audio_stream_queue)"
+end
+
+suite.write
+renderer.destroy
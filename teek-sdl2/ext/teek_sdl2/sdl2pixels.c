@@ -47,10 +47,69 @@ pixels_pack_uint32(VALUE self, VALUE ary, VALUE vw, VALUE vh)
     return result;
 }
 
+/* ---------------------------------------------------------
+ * Shared conversion kernels
+ *
+ * teek ships SIMD pixel conversion (tkpixconv.c) and exports the entry
+ * point as an Integer via Teek._pixel_convert_fn - the reverse of how we
+ * hand sdl2_event_check to Teek._register_event_source. Looked up once,
+ * on first use; with an older teek that lacks it we fall back to the
+ * scalar loop below.
+ * --------------------------------------------------------- */
+
+/* Mirrors enum teek_pixfmt in teek's tcltkbridge.h - values must match.
+ * Named by byte order in memory. */
+enum {
+    TEEK_PIXFMT_RGBA = 0,
+    TEEK_PIXFMT_BGRA = 1,
+    TEEK_PIXFMT_ARGB = 2,
+    TEEK_PIXFMT_ABGR = 3,
+    TEEK_PIXFMT_RGB  = 4,
+    TEEK_PIXFMT_GRAY = 5
+};
+
+typedef int (*teek_pixconv_fn)(const unsigned char *src, int src_fmt,
+                               unsigned char *dst, int dst_fmt,
+                               size_t npixels, int flags);
+
+static teek_pixconv_fn shared_pixconv;
+static int shared_pixconv_looked_up;
+
+static teek_pixconv_fn
+get_shared_pixconv(void)
+{
+    if (!shared_pixconv_looked_up) {
+        ID id = rb_intern("_pixel_convert_fn");
+        shared_pixconv_looked_up = 1;
+        if (rb_respond_to(mTeek, id)) {
+            VALUE addr = rb_funcall(mTeek, id, 0);
+            shared_pixconv = (teek_pixconv_fn)(uintptr_t)NUM2ULL(addr);
+        }
+    }
+    return shared_pixconv;
+}
+
+/* Source formats accepted by Pixels.convert. pos[] gives the byte
+ * offset of R, G, B, A within a source pixel (-1: no alpha, use 0xFF). */
+static const struct {
+    const char *name;
+    const char *label;
+    int teek_fmt;
+    int bytes;
+    int pos[4];
+} convert_formats[] = {
+    { "rgba8888", "RGBA8888", TEEK_PIXFMT_RGBA, 4, { 0, 1, 2, 3 } },
+    { "bgra8888", "BGRA8888", TEEK_PIXFMT_BGRA, 4, { 2, 1, 0, 3 } },
+    { "abgr8888", "ABGR8888", TEEK_PIXFMT_ABGR, 4, { 3, 2, 1, 0 } },
+    { "rgb888",   "RGB888",   TEEK_PIXFMT_RGB,  3, { 0, 1, 2, -1 } },
+    { "gray8",    "GRAY8",    TEEK_PIXFMT_GRAY, 1, { 0, 0, 0, -1 } },
+};
+
 /*
  * Teek::SDL2::Pixels.convert(source, width, height, from_format) -> String
  *
- * Converts a pixel byte string from one format to ARGB8888.
+ * Converts a pixel byte string from one format to ARGB8888 (bytes
+ * A, R, G, B).
  *
  * Supported from_format values:
  *   :argb8888 - passthrough (no conversion)
@@ -58,6 +117,9 @@ pixels_pack_uint32(VALUE self, VALUE ary, VALUE vw, VALUE vh)
  *   :bgra8888 - BGRA -> ARGB byte shuffle
  *   :abgr8888 - ABGR -> ARGB byte shuffle
  *   :rgb888   - 3-byte RGB -> 4-byte ARGB (adds 0xFF alpha)
+ *   :gray8    - 1-byte gray -> 4-byte ARGB (adds 0xFF alpha)
+ *
+ * Uses teek's SIMD kernels when available (see get_shared_pixconv).
  */
 static VALUE
 pixels_convert(VALUE self, VALUE source, VALUE vw, VALUE vh, VALUE format)
@@ -68,7 +130,9 @@ pixels_convert(VALUE self, VALUE source, VALUE vw, VALUE vh, VALUE format)
     const uint8_t *src;
     uint8_t *dst;
     VALUE result;
+    teek_pixconv_fn conv;
     ID fmt;
+    size_t f;
     long i;
 
     Check_Type(source, T_STRING);
@@ -83,77 +147,41 @@ pixels_convert(VALUE self, VALUE source, VALUE vw, VALUE vh, VALUE format)
         return rb_str_dup(source);
     }
 
-    /* :rgba8888 — RGBA -> ARGB */
-    if (fmt == rb_intern("rgba8888")) {
-        if (RSTRING_LEN(source) < npixels * 4) {
-            rb_raise(rb_eArgError, "source too short for %ldx%d RGBA8888", (long)w, h);
-        }
-        result = rb_str_new(NULL, npixels * 4);
-        dst = (uint8_t *)RSTRING_PTR(result);
-        for (i = 0; i < npixels; i++) {
-            long off = i * 4;
-            dst[off + 0] = src[off + 3]; /* A */
-            dst[off + 1] = src[off + 0]; /* R */
-            dst[off + 2] = src[off + 1]; /* G */
-            dst[off + 3] = src[off + 2]; /* B */
-        }
-        return result;
+    for (f = 0; f < sizeof(convert_formats) / sizeof(convert_formats[0]); f++) {
+        if (fmt == rb_intern(convert_formats[f].name)) break;
+    }
+    if (f == sizeof(convert_formats) / sizeof(convert_formats[0])) {
+        rb_raise(rb_eArgError, "unknown pixel format: %"PRIsVALUE, format);
     }
 
-    /* :bgra8888 — BGRA -> ARGB */
-    if (fmt == rb_intern("bgra8888")) {
-        if (RSTRING_LEN(source) < npixels * 4) {
-            rb_raise(rb_eArgError, "source too short for %ldx%d BGRA8888", (long)w, h);
-        }
-        result = rb_str_new(NULL, npixels * 4);
-        dst = (uint8_t *)RSTRING_PTR(result);
-        for (i = 0; i < npixels; i++) {
-            long off = i * 4;
-            dst[off + 0] = src[off + 3]; /* A */
-            dst[off + 1] = src[off + 2]; /* R */
-            dst[off + 2] = src[off + 1]; /* G */
-            dst[off + 3] = src[off + 0]; /* B */
-        }
-        return result;
+    if (RSTRING_LEN(source) < npixels * convert_formats[f].bytes) {
+        rb_raise(rb_eArgError, "source too short for %ldx%d %s",
+                 (long)w, h, convert_formats[f].label);
     }
 
-    /* :abgr8888 — ABGR -> ARGB */
-    if (fmt == rb_intern("abgr8888")) {
-        if (RSTRING_LEN(source) < npixels * 4) {
-            rb_raise(rb_eArgError, "source too short for %ldx%d ABGR8888", (long)w, h);
-        }
-        result = rb_str_new(NULL, npixels * 4);
-        dst = (uint8_t *)RSTRING_PTR(result);
-        for (i = 0; i < npixels; i++) {
-            long off = i * 4;
-            dst[off + 0] = src[off + 0]; /* A */
-            dst[off + 1] = src[off + 3]; /* R */
-            dst[off + 2] = src[off + 2]; /* G */
-            dst[off + 3] = src[off + 1]; /* B */
-        }
+    result = rb_str_new(NULL, npixels * 4);
+    dst = (uint8_t *)RSTRING_PTR(result);
+
+    conv = get_shared_pixconv();
+    if (conv && conv(src, convert_formats[f].teek_fmt, dst, TEEK_PIXFMT_ARGB,
+                     (size_t)npixels, 0) == 0) {
         return result;
     }
 
-    /* :rgb888 — 3-byte RGB -> 4-byte ARGB */
-    if (fmt == rb_intern("rgb888")) {
-        if (RSTRING_LEN(source) < npixels * 3) {
-            rb_raise(rb_eArgError, "source too short for %ldx%d RGB888", (long)w, h);
-        }
-        result = rb_str_new(NULL, npixels * 4);
-        dst = (uint8_t *)RSTRING_PTR(result);
+    /* Scalar fallback */
+    {
+        const int *pos = convert_formats[f].pos;
+        int bytes = convert_formats[f].bytes;
         for (i = 0; i < npixels; i++) {
-            long src_off = i * 3;
-            long dst_off = i * 4;
-            dst[dst_off + 0] = 0xFF;           /* A */
-            dst[dst_off + 1] = src[src_off + 0]; /* R */
-            dst[dst_off + 2] = src[src_off + 1]; /* G */
-            dst[dst_off + 3] = src[src_off + 2]; /* B */
+            const uint8_t *p = src + i * bytes;
+            uint8_t *d = dst + i * 4;
+            d[0] = pos[3] < 0 ? 0xFF : p[pos[3]]; /* A */
+            d[1] = p[pos[0]];                     /* R */
+            d[2] = p[pos[1]];                     /* G */
+            d[3] = p[pos[2]];                     /* B */
         }
-        return result;
     }
-
-    rb_raise(rb_eArgError, "unknown pixel format: %"PRIsVALUE, format);
-    return Qnil; /* unreachable */
+    return result;
 }
 
 void
@@ -1,4 +1,5 @@
 #include "teek_sdl2.h"
+#include "ruby/io/buffer.h"
 
 /* ---------------------------------------------------------
  * Layer 1: Pure SDL2 surface management
@@ -118,6 +119,39 @@ renderer_clear(int argc, VALUE *argv, VALUE self)
     return self;
 }
 
+/* ---------------------------------------------------------
+ * Tracer hook
+ *
+ * Presents show up in Teek::Tracer traces as "present" spans (vsync
+ * waits included), through the function pointers teek exports as
+ * Teek._trace_fn_ptrs - looked up once, like Teek._pixel_convert_fn in
+ * sdl2pixels.c. With an older teek that lacks them, presents aren't
+ * traced.
+ * --------------------------------------------------------- */
+
+/* Mirrors TEEK_TRACE_EXTERNAL in teek's tcltkbridge.h - value must match */
+#define TEEK_TRACE_EXTERNAL 4
+
+typedef long long (*teek_trace_begin_fn)(void);
+typedef void (*teek_trace_span_fn)(int kind, const char *name, const char *detail,
+                                   long long value, long long start_us);
+
+static teek_trace_begin_fn trace_begin;
+static teek_trace_span_fn trace_span;
+static int trace_looked_up;
+
+static void
+lookup_trace_fns(void)
+{
+    ID id = rb_intern("_trace_fn_ptrs");
+    trace_looked_up = 1;
+    if (rb_respond_to(mTeek, id)) {
+        VALUE ptrs = rb_funcall(mTeek, id, 0);
+        trace_begin = (teek_trace_begin_fn)(uintptr_t)NUM2ULL(rb_ary_entry(ptrs, 0));
+        trace_span = (teek_trace_span_fn)(uintptr_t)NUM2ULL(rb_ary_entry(ptrs, 1));
+    }
+}
+
 /*
  * Teek::SDL2::Renderer#present
  */
@@ -125,7 +159,14 @@ static VALUE
 renderer_present(VALUE self)
 {
     struct sdl2_renderer *ren = get_renderer(self);
+    long long start = 0;
+
+    if (!trace_looked_up) lookup_trace_fns();
+    if (trace_begin) start = trace_begin();
+
     SDL_RenderPresent(ren->renderer);
+
+    if (start) trace_span(TEEK_TRACE_EXTERNAL, "present", NULL, 0, start);
     return self;
 }
 
@@ -596,22 +637,41 @@ renderer_create_texture(int argc, VALUE *argv, VALUE self)
  * Teek::SDL2::Texture#update(pixels)
  *
  * Updates the entire texture with pixel data.
- * pixels must be a String of w*h*4 bytes (ARGB8888).
+ * pixels must be a String or IO::Buffer of w*h*4 bytes (ARGB8888).
+ * SDL reads the bytes in place, so a frozen String or an IO::Buffer
+ * handed over from a Ractor worker is uploaded without another copy.
  */
 static VALUE
 texture_update(VALUE self, VALUE pixels)
 {
     struct sdl2_texture *t = get_texture(self);
-    Check_Type(pixels, T_STRING);
+    const void *ptr;
+    size_t len;
+    int is_buffer = 0;
+    int rc;
+
+    if (RB_TYPE_P(pixels, T_STRING)) {
+        ptr = RSTRING_PTR(pixels);
+        len = (size_t)RSTRING_LEN(pixels);
+    } else if (rb_obj_is_kind_of(pixels, rb_cIOBuffer)) {
+        rb_io_buffer_get_bytes_for_reading(pixels, &ptr, &len);
+        is_buffer = 1;
+    } else {
+        rb_raise(rb_eTypeError, "pixel data must be a String or IO::Buffer (got %s)",
+                 rb_obj_classname(pixels));
+    }
 
     long expected = (long)t->w * t->h * 4;
-    if (RSTRING_LEN(pixels) != expected) {
+    if ((long)len != expected) {
         rb_raise(rb_eArgError, "pixel data must be %ld bytes (got %ld)",
-                 expected, RSTRING_LEN(pixels));
+                 expected, (long)len);
     }
 
     int pitch = t->w * 4;
-    if (SDL_UpdateTexture(t->texture, NULL, RSTRING_PTR(pixels), pitch) != 0) {
+    if (is_buffer) rb_io_buffer_lock(pixels);
+    rc = SDL_UpdateTexture(t->texture, NULL, ptr, pitch);
+    if (is_buffer) rb_io_buffer_unlock(pixels);
+    if (rc != 0) {
         rb_raise(eSDL2Error, "SDL_UpdateTexture: %s", SDL_GetError());
     }
     return self;
@@ -867,6 +927,55 @@ sdl2_compose_blend_mode(VALUE self,
     return INT2NUM((int)bm);
 }
 
+/* ---------------------------------------------------------
+ * Offscreen renderer
+ * --------------------------------------------------------- */
+
+/*
+ * Teek::SDL2.create_offscreen_renderer(width, height) -> Renderer
+ *
+ * Creates a hidden SDL2 window with a software renderer and no vsync.
+ * Needs no Tk and works under SDL's "dummy" video driver, so it's what
+ * the benchmarks and headless tests draw into. Present never blocks on
+ * a display refresh; read results back with Renderer#read_pixels.
+ */
+static VALUE
+sdl2_create_offscreen_renderer(VALUE self, VALUE vw, VALUE vh)
+{
+    int w = NUM2INT(vw);
+    int h = NUM2INT(vh);
+
+    if (w <= 0 || h <= 0) {
+        rb_raise(rb_eArgError, "width and height must be positive");
+    }
+
+    ensure_sdl2_init();
+
+    SDL_Window *window = SDL_CreateWindow("teek-sdl2 offscreen",
+                                          SDL_WINDOWPOS_UNDEFINED,
+                                          SDL_WINDOWPOS_UNDEFINED,
+                                          w, h, SDL_WINDOW_HIDDEN);
+    if (!window) {
+        rb_raise(eSDL2Error, "SDL_CreateWindow: %s", SDL_GetError());
+    }
+
+    SDL_Renderer *sdl_ren = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+    if (!sdl_ren) {
+        SDL_DestroyWindow(window);
+        rb_raise(eSDL2Error, "SDL_CreateRenderer: %s", SDL_GetError());
+    }
+
+    VALUE obj = rb_obj_alloc(cRenderer);
+    struct sdl2_renderer *r;
+    TypedData_Get_Struct(obj, struct sdl2_renderer, &renderer_type, r);
+    r->window = window;
+    r->renderer = sdl_ren;
+    r->owned_window = 1;
+    r->destroyed = 0;
+
+    return obj;
+}
+
 /* ---------------------------------------------------------
  * Init
  * --------------------------------------------------------- */
@@ -913,4 +1022,7 @@ Init_sdl2surface(VALUE mTeekSDL2)
 
     /* Module-level blend mode composition */
     rb_define_module_function(mTeekSDL2, "compose_blend_mode", sdl2_compose_blend_mode, 6);
+
+    rb_define_module_function(mTeekSDL2, "create_offscreen_renderer",
+                             sdl2_create_offscreen_renderer, 2);
 }
@@ -120,6 +120,20 @@ module Teek
 
     # @!endgroup
 
+    # @!group Rendering (C-defined module functions)
+
+    # @!method self.create_offscreen_renderer(width, height)
+    #   Create a {Renderer} on a hidden window with SDL's software
+    #   renderer, without Tk. Works under +SDL_VIDEODRIVER=dummy+, so
+    #   benchmarks and headless tests can draw and {Renderer#read_pixels}
+    #   without a display. {Renderer#present} never waits for vsync.
+    #   @param width [Integer]
+    #   @param height [Integer]
+    #   @return [Renderer]
+    #   @raise [Teek::SDL2::Error] if SDL can't create the window or renderer
+
+    # @!endgroup
+
     # @!group Blending (C-defined module functions)
 
     # @!method self.compose_blend_mode(src_color_factor, dst_color_factor, color_op, src_alpha_factor, dst_alpha_factor, alpha_op)
@@ -9,7 +9,9 @@ module Teek
     # convenience wrappers with keyword arguments.
     #
     # You don't create a Renderer directly — it's created automatically
-    # by {Viewport} and accessible via {Viewport#renderer}.
+    # by {Viewport} and accessible via {Viewport#renderer}. For drawing
+    # without Tk (benchmarks, headless tests) use
+    # {Teek::SDL2.create_offscreen_renderer}.
     #
     # ## C-defined methods
     #
@@ -12,7 +12,7 @@ module Teek
     #
     # These are defined in the C extension (+sdl2surface.c+):
     #
-    # - {#update} — upload pixel data from a String
+    # - {#update} — upload pixel data from a String or IO::Buffer
     # - {#width} — texture width in pixels
     # - {#height} — texture height in pixels
     # - {#blend_mode=} — set the texture blend mode
@@ -30,8 +30,10 @@ module Teek
 
       # @!method update(pixel_data)
       #   Upload pixel data to the texture. The data must be a binary String
-      #   of ARGB8888 pixels (4 bytes per pixel, width * height * 4 total).
-      #   @param pixel_data [String] raw pixel bytes
+      #   or IO::Buffer of ARGB8888 pixels (4 bytes per pixel, width * height * 4
+      #   total). It is read in place, so frames yielded frozen or moved from a
+      #   +:ractor+ BackgroundWork reach the GPU without an extra copy.
+      #   @param pixel_data [String, IO::Buffer] raw pixel bytes
       #   @return [self]
 
       # @!method width
@@ -77,6 +77,24 @@ class TestRenderer < Minitest::Test
     viewport.destroy
   end
 
+  tk_test "texture update accepts an IO::Buffer" do
+    require "teek/sdl2"
+
+    app.show
+    app.update
+    viewport = Teek::SDL2::Viewport.new(app, width: 100, height: 100)
+
+    tex = viewport.renderer.create_texture(16, 16, :streaming)
+    buf = IO::Buffer.for([0xFF, 0x00, 0xFF, 0x00].pack('C*') * (16 * 16))
+    assert_same tex, tex.update(buf)
+    refute buf.locked?
+    assert_raises(ArgumentError) { tex.update(IO::Buffer.for("short")) }
+    assert_raises(TypeError) { tex.update([0] * 1024) }
+
+    tex.destroy
+    viewport.destroy
+  end
+
   tk_test "all draw methods work together in one frame" do
     require "teek/sdl2"
 
@@ -21,4 +21,21 @@ class TestSDL2 < Minitest::Test
   def test_module_structure
     assert_kind_of Module, Teek::SDL2
   end
+
+  def test_offscreen_renderer_draws_without_tk
+    r = Teek::SDL2.create_offscreen_renderer(32, 16)
+    assert_equal [32, 16], r.output_size
+
+    r.clear(0, 0, 0)
+    r.fill_rect(0, 0, 32, 16, 255, 0, 0)
+    pixels = r.read_pixels
+    assert_equal 32 * 16 * 4, pixels.bytesize
+    refute_equal "\0" * pixels.bytesize, pixels
+  ensure
+    r&.destroy
+  end
+
+  def test_offscreen_renderer_rejects_empty_size
+    assert_raises(ArgumentError) { Teek::SDL2.create_offscreen_renderer(0, 10) }
+  end
 end
@@ -185,6 +185,17 @@ class Teek::TestWorker
       Hash[*@app.split_list(list_str)]
     end
 
+    # The -text of every text item on a canvas that isn't hidden, in
+    # stacking order - what a canvas-drawn widget (see
+    # test_virtual_list.rb) is showing.
+    def visible_canvas_texts(canvas)
+      @app.command(canvas, :find, :all).split.filter_map do |id|
+        next unless @app.command(canvas, :type, id) == 'text'
+        next if @app.command(canvas, :itemcget, id, '-state') == 'hidden'
+        @app.command(canvas, :itemcget, id, '-text')
+      end
+    end
+
     # @return [Integer] the running Tcl interpreter's major version (8 or 9)
     def tcl_major_version
       @app.tcl_eval('info patchlevel').split('.').first.to_i
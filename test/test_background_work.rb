@@ -224,6 +224,24 @@ class TestBackgroundWork < Minitest::Test
     assert_includes progress_values, 1.0
   end
 
+  tk_test "background_work :thread pushes results without after timers" do
+    got = []
+    task = Teek::BackgroundWork.new(app, nil, mode: :thread) do |t, _|
+      t.yield(:first)
+      t.wait_message
+      t.yield(:second)
+    end.on_progress { |v| got << v }
+
+    wait_until(timeout: 2.0) { got == [:first] }
+    assert_equal [:first], got
+    # Idle task waiting on a message: nothing scheduled on the Tcl side
+    assert_empty app.tcl_eval('after info')
+
+    task.send_message(:go)
+    wait_until(timeout: 2.0) { task.done? }
+    assert_equal [:first, :second], got
+  end
+
   tk_test "RactorStream should yield values to callback" do
     Teek::BackgroundWork.drop_intermediate = false
 
@@ -358,6 +376,335 @@ class TestBackgroundWork < Minitest::Test
   tk_test "background_modes lists registered modes" do
     modes = Teek::BackgroundWork.background_modes
     assert modes.key?(:thread), "thread mode should be registered"
+    assert modes.key?(:pool), "pool mode should be registered"
+  end
+
+  # ---------------------------------------------------------
+  # :pool mode
+  # ---------------------------------------------------------
+
+  tk_test "pool mode runs many tasks on a bounded set of threads" do
+    Teek::BackgroundPool.shutdown(app)
+    saved_size = Teek::BackgroundPool.size
+    Teek::BackgroundPool.size = 2
+
+    lock = Mutex.new
+    running = 0
+    peak = 0
+    done = 0
+    12.times do |i|
+      Teek::BackgroundWork.new(app, i, mode: :pool) do |t, n|
+        lock.synchronize { running += 1; peak = [peak, running].max }
+        sleep 0.01
+        lock.synchronize { running -= 1 }
+        t.yield(n)
+      end.on_done { done += 1 }
+    end
+
+    wait_until(timeout: 5.0) { done == 12 }
+    assert_equal 12, done
+    assert_operator peak, :<=, 2
+    assert_operator Teek::BackgroundPool.for(app).thread_count, :<=, 2
+  ensure
+    Teek::BackgroundPool.shutdown(app)
+    Teek::BackgroundPool.size = saved_size
+  end
+
+  tk_test "pool mode runs higher priority tasks first" do
+    Teek::BackgroundPool.shutdown(app)
+    saved_size = Teek::BackgroundPool.size
+    Teek::BackgroundPool.size = 1
+
+    order = []
+    blocker = Teek::BackgroundWork.new(app, nil, mode: :pool) { |t, _| t.wait_message }
+    blocker.start
+    [[:low, 0], [:high, 5], [:mid, 1]].each do |name, priority|
+      Teek::BackgroundWork.new(app, name, mode: :pool, priority: priority) do |t, n|
+        t.yield(n)
+      end.on_progress { |n| order << n }
+    end
+    blocker.send_message(:go)
+
+    wait_until(timeout: 5.0) { order.size == 3 }
+    assert_equal [:high, :mid, :low], order
+  ensure
+    Teek::BackgroundPool.shutdown(app)
+    Teek::BackgroundPool.size = saved_size
+  end
+
+  tk_test "stopping a queued pool task cancels it" do
+    Teek::BackgroundPool.shutdown(app)
+    saved_size = Teek::BackgroundPool.size
+    Teek::BackgroundPool.size = 1
+
+    ran = false
+    done = false
+    blocker = Teek::BackgroundWork.new(app, nil, mode: :pool) { |t, _| t.wait_message }
+    blocker.start
+    queued = Teek::BackgroundWork.new(app, nil, mode: :pool) { |_t, _| ran = true }
+                                 .on_done { done = true }
+    queued.stop
+    blocker.send_message(:go)
+
+    wait_until(timeout: 3.0) { done && blocker.done? }
+    assert done, "on_done should fire for a cancelled task"
+    refute ran, "a cancelled task should never run"
+  ensure
+    Teek::BackgroundPool.shutdown(app)
+    Teek::BackgroundPool.size = saved_size
+  end
+
+  # ---------------------------------------------------------
+  # parallel_map
+  # ---------------------------------------------------------
+
+  tk_test "parallel_map delivers every result in chunk order" do
+    chunks = (0...40).to_a
+    seen = []
+    results = nil
+    job = Teek::BackgroundWork.parallel_map(app, chunks, workers: 4, mode: :thread) do |n, _i|
+      sleep(0.001 * ((n * 7) % 5))
+      n * n
+    end
+    job.on_progress { |value, index| seen << [index, value] }
+       .on_done { |all| results = all }
+
+    wait_until(timeout: 5.0) { results }
+    assert_equal chunks.map { |n| n * n }, results
+    assert_equal chunks.map { |n| [n, n * n] }, seen
+    assert job.done?
+    assert_equal 4, job.workers
+  end
+
+  tk_test "parallel_map steals work from a busy worker" do
+    results = nil
+    # Round-robin dealing gives worker 0 every slow chunk
+    job = Teek::BackgroundWork.parallel_map(app, (0...16).to_a, workers: 2, mode: :thread) do |n, _i|
+      sleep 0.02 if n.even?
+      n
+    end.on_done { |all| results = all }
+
+    wait_until(timeout: 5.0) { results }
+    assert_equal (0...16).to_a, results
+    assert_operator job.steals, :>=, 1
+  end
+
+  tk_test "parallel_map stop hands out no more chunks" do
+    ran = 0
+    lock = Mutex.new
+    results = nil
+    job = Teek::BackgroundWork.parallel_map(app, (0...50).to_a, workers: 1, mode: :thread) do |n, _i|
+      lock.synchronize { ran += 1 }
+      sleep 0.01
+      n
+    end
+    job.on_progress { |_value, index| job.stop if index == 2 }
+       .on_done { |all| results = all }
+
+    wait_until(timeout: 5.0) { results }
+    assert_operator results.size, :<, 50
+    assert_equal (0...results.size).to_a, results
+    assert_equal ran, results.size
+  end
+
+  tk_test "parallel_map move: false copies results a worker keeps" do
+    skip "Ractor mode requires Ruby 4.x+" unless Ractor.respond_to?(:shareable_proc)
+    results = nil
+    # Each worker reuses one buffer; moving it out would break the next chunk
+    Teek::BackgroundWork.parallel_map(app, [1, 2, 3], workers: 1, mode: :ractor, move: false) do |n, _i|
+      buf = (Ractor.current[:buf] ||= +'')
+      buf.replace(n.to_s)
+    end.on_done { |all| results = all }
+    wait_until(timeout: 5.0) { results }
+    assert_equal %w[1 2 3], results
+  end
+
+  tk_test "parallel_map with no chunks finishes immediately" do
+    results = nil
+    Teek::BackgroundWork.parallel_map(app, [], mode: :thread) { |n, _i| n }
+                        .on_done { |all| results = all }
+    wait_until(timeout: 2.0) { results }
+    assert_equal [], results
+  end
+
+  # ---------------------------------------------------------
+  # Cancellation
+  # ---------------------------------------------------------
+
+  tk_test "stop interrupts a worker blocked in a cancellable read" do
+    reader, writer = IO.pipe
+    done = false
+    reached = false
+    task = Teek::BackgroundWork.new(app, reader) do |t, io|
+      t.cancellable { io.read }
+      reached = true
+    end.on_done { done = true }
+
+    sleep 0.05
+    task.stop
+    wait_until(timeout: 2.0) { done }
+    assert done, "stop should interrupt the blocked read"
+    refute reached
+  ensure
+    reader&.close
+    writer&.close
+  end
+
+  tk_test "stop is held back outside cancellable blocks" do
+    steps = []
+    done = false
+    task = Teek::BackgroundWork.new(app, nil) do |t, _|
+      sleep 0.1
+      steps << :outside
+      t.cancellable { steps << :inside }
+    end.on_done { done = true }
+
+    sleep 0.02
+    task.stop
+    wait_until(timeout: 2.0) { done }
+    assert_equal [:outside], steps
+    assert task.done?
+  end
+
+  tk_test "on_cancel callbacks run when the task is stopped" do
+    reader, writer = IO.pipe
+    error = nil
+    done = false
+    task = Teek::BackgroundWork.new(app, reader) do |t, io|
+      t.token.on_cancel { io.close }
+      begin
+        io.read
+      rescue IOError => e
+        error = e
+      end
+    end.on_done { done = true }
+
+    sleep 0.05
+    task.stop
+    wait_until(timeout: 2.0) { done }
+    assert_kind_of IOError, error
+  ensure
+    writer&.close
+  end
+
+  tk_test "with_timeout raises Timeout::Error at the deadline" do
+    result = nil
+    done = false
+    worker = nil
+    Teek::BackgroundWork.new(app, nil) do |t, _|
+      worker = Thread.current
+      t.with_timeout(0.05) do
+        t.with_timeout(10) { sleep 5 }
+      end
+    rescue Timeout::Error
+      t.yield(:timed_out)
+    end.on_progress { |r| result = r }.on_done { done = true }
+
+    started = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+    wait_until(timeout: 2.0) { done && !worker.alive? }
+    assert_operator Process.clock_gettime(Process::CLOCK_MONOTONIC) - started, :<, 1.0
+    assert_equal :timed_out, result
+    assert done, "on_done should fire"
+    assert_equal false, worker.status, "no exception should escape the worker"
+  end
+
+  tk_test "nested with_timeout on the enclosing deadline times out once" do
+    Teek::BackgroundWork.drop_intermediate = false
+    results = []
+    done = false
+    worker = nil
+    Teek::BackgroundWork.new(app, nil) do |t, _|
+      worker = Thread.current
+      5.times do
+        t.with_timeout(0.02) do
+          # Same deadline as the enclosing call
+          t.with_timeout(t.token.remaining) { sleep 5 }
+        end
+      rescue Timeout::Error
+        t.yield(:timed_out)
+      end
+    end.on_progress { |r| results << r }.on_done { done = true }
+
+    wait_until(timeout: 2.0) { done && !worker.alive? }
+    Teek::BackgroundWork.drop_intermediate = true
+
+    assert done, "on_done should fire"
+    assert_equal [:timed_out] * 5, results
+    assert_equal false, worker.status, "no exception should escape the worker"
+  end
+
+  # ---------------------------------------------------------
+  # Bounded output
+  # ---------------------------------------------------------
+
+  tk_test "capacity with :block paces the worker and delivers everything" do
+    got = []
+    done = false
+    task = Teek::BackgroundWork.new(app, nil, capacity: 4, overflow: :block) do |t, _|
+      200.times { |i| t.yield(i) }
+    end
+    task.on_progress { |v| got << v }.on_done { done = true }
+
+    wait_until(timeout: 5.0) { done }
+    assert_equal (0...200).to_a, got
+    stats = task.output_stats
+    assert_operator stats[:high_water], :<=, 4
+    assert_equal 0, stats[:dropped]
+    assert_equal 0, stats[:depth]
+  end
+
+  tk_test "capacity with :drop_oldest keeps the newest results" do
+    got = []
+    done = false
+    task = Teek::BackgroundWork.new(app, nil, capacity: 3, overflow: :drop_oldest) do |t, _|
+      50.times { |i| t.yield(i) }
+    end
+    task.pause
+    task.on_progress { |v| got << v }.on_done { done = true }
+    sleep 0.2
+    task.resume
+
+    wait_until(timeout: 5.0) { done }
+    assert_equal [47, 48, 49], got
+    assert_equal 47, task.output_stats[:dropped]
+  end
+
+  tk_test "capacity with :coalesce merges into the newest result" do
+    got = []
+    done = false
+    task = Teek::BackgroundWork.new(app, nil, capacity: 2, overflow: :coalesce,
+                                              merge: ->(older, newer) { older + newer }) do |t, _|
+      10.times { t.yield(1) }
+    end
+    task.pause
+    task.on_progress { |v| got << v }.on_done { done = true }
+    sleep 0.2
+    task.resume
+
+    wait_until(timeout: 5.0) { done }
+    assert_equal 10, got.sum
+    assert_equal 8, task.output_stats[:coalesced]
+  end
+
+  tk_test "stop releases a worker blocked on a full channel" do
+    done = false
+    task = Teek::BackgroundWork.new(app, nil, capacity: 1, overflow: :block) do |t, _|
+      loop { t.yield(1) }
+    end
+    task.pause
+    task.on_done { done = true }
+    sleep 0.05
+    task.stop
+    task.resume
+
+    wait_until(timeout: 2.0) { done }
+    assert done
+  end
+
+  tk_test "unknown overflow policy raises" do
+    assert_raises(ArgumentError) do
+      Teek::BackgroundWork.new(app, nil, capacity: 2, overflow: :explode) { |_t, _| }
+    end
   end
 
   tk_test "RactorStream should handle errors in work block" do
@@ -0,0 +1,253 @@
+# frozen_string_literal: true
+
+# Tests for Teek::CanvasScene and the batched canvas natives
+# (Interp#canvas_apply, canvas_create_many, canvas_set_coords_many).
+
+require 'minitest/autorun'
+require_relative 'tk_test_helper'
+
+class TestCanvasScene < Minitest::Test
+  include TeekTestHelper
+
+  tk_test "canvas_apply runs a batch and returns created ids" do
+    app.command(:canvas, '.cs_apply')
+    ids = app.interp.canvas_apply('.cs_apply', [
+      ['create', 'rectangle', [0, 0, 10, 10], '-fill', 'red'],
+      ['create', :oval, [1.5, 2.5, 8, 9]],
+      [:itemconfigure, 'all', '-width', 3],
+    ])
+
+    assert_equal 2, ids.size
+    assert ids.all?(Integer)
+    assert_equal 'red', app.command('.cs_apply', :itemcget, ids[0], '-fill')
+    assert_equal 3.0, app.command('.cs_apply', :itemcget, ids[1], '-width').to_f
+    assert_equal '1.5 2.5 8.0 9.0', app.command('.cs_apply', :coords, ids[1])
+    assert_equal [], app.interp.canvas_apply('.cs_apply', [])
+
+    app.command(:destroy, '.cs_apply')
+  end
+
+  tk_test "canvas_apply reports the failing op" do
+    app.command(:canvas, '.cs_err')
+    id = app.command('.cs_err', :create, :line, 0, 0, 5, 5).to_i
+
+    err = assert_raises(Teek::TclError) do
+      app.interp.canvas_apply('.cs_err', [['coords', id, [1, 1, 6, 6]], ['bogus']])
+    end
+    assert_match(/canvas op 1/, err.message)
+    assert_equal '1.0 1.0 6.0 6.0', app.command('.cs_err', :coords, id)
+
+    err = assert_raises(Teek::TclError) do
+      app.interp.canvas_apply('.cs_err', [['create', 'line', [0, 0, 1, 1]],
+                                          ['create', 'line', [0, 0, 2, 2]],
+                                          ['bogus']])
+    end
+    assert_equal 2, err.failed_index
+    assert_equal 2, err.created_ids.size
+    err.created_ids.each { |cid| assert_equal 'line', app.command('.cs_err', :type, cid) }
+
+    assert_raises(TypeError) { app.interp.canvas_apply('.cs_err', [['coords', id, Object.new]]) }
+    assert_raises(ArgumentError) { app.interp.canvas_apply('.cs_err', [[]]) }
+
+    app.command(:destroy, '.cs_err')
+  end
+
+  tk_test "commit creates items and sends only what changed" do
+    app.command(:canvas, '.cs_scene')
+    scene = Teek::CanvasScene.new(app, '.cs_scene')
+    items = 10.times.map { |i| scene.add(:rectangle, [i, 0, i + 5, 5], fill: 'red') }
+
+    assert_equal 10, scene.commit
+    assert items.all?(&:created?)
+    assert_equal 10, app.command('.cs_scene', :find, :all).split.size
+
+    items[3].move(2, 2)
+    items[4][:fill] = 'blue'
+    items[5][:fill] = 'red'
+    assert_equal 2, scene.commit
+    assert_equal 1, scene.last_commit[:skipped]
+    assert_equal '5.0 2.0 10.0 7.0', app.command('.cs_scene', :coords, items[3].id)
+    assert_equal 'blue', app.command('.cs_scene', :itemcget, items[4].id, '-fill')
+
+    assert_equal 0, scene.commit
+    refute scene.dirty?
+
+    app.command(:destroy, '.cs_scene')
+  end
+
+  tk_test "changes that cancel out within a frame send nothing" do
+    app.command(:canvas, '.cs_noop')
+    scene = Teek::CanvasScene.new(app, '.cs_noop')
+    item = scene.add(:oval, [0, 0, 4, 4], outline: 'black')
+    scene.commit
+
+    item.move(3, 0)
+    item.move(-3, 0)
+    item[:outline] = 'green'
+    item[:outline] = 'black'
+
+    assert_equal 0, scene.commit
+    app.command(:destroy, '.cs_noop')
+  end
+
+  tk_test "deleted items leave the canvas on the next commit" do
+    app.command(:canvas, '.cs_del')
+    scene = Teek::CanvasScene.new(app, '.cs_del')
+    kept = scene.add(:line, [0, 0, 1, 1])
+    gone = scene.add(:line, [2, 2, 3, 3])
+    never = scene.add(:line, [4, 4, 5, 5])
+    never.delete
+    scene.commit
+
+    gone.delete
+    assert_equal 1, scene.commit
+    assert_equal [kept.id.to_s], app.command('.cs_del', :find, :all).split
+    assert_equal [kept], scene.items
+
+    scene.clear
+    scene.commit
+    assert_empty app.command('.cs_del', :find, :all)
+
+    app.command(:destroy, '.cs_del')
+  end
+
+  tk_test "a failed commit leaves its changes pending" do
+    app.command(:canvas, '.cs_fail')
+    scene = Teek::CanvasScene.new(app, '.cs_fail')
+    item = scene.add(:rectangle, [0, 0, 5, 5], fill: 'red')
+    scene.commit
+
+    item.move(1, 1)
+    item[:fill] = 'not-a-color'
+    assert_raises(Teek::TclError) { scene.commit }
+    assert scene.dirty?
+
+    item[:fill] = 'blue'
+    assert_equal 2, scene.commit
+    assert_equal '1.0 1.0 6.0 6.0', app.command('.cs_fail', :coords, item.id)
+    assert_equal 'blue', app.command('.cs_fail', :itemcget, item.id, '-fill')
+
+    app.command(:destroy, '.cs_fail')
+  end
+
+  tk_test "a failed create keeps the items created before it" do
+    app.command(:canvas, '.cs_dup')
+    scene = Teek::CanvasScene.new(app, '.cs_dup')
+    good = 3.times.map { |i| scene.add(:rectangle, [i, 0, i + 5, 5], fill: 'red') }
+    bad = scene.add(:rectangle, [0, 0, 1, 1], fill: 'not-a-color')
+
+    2.times do
+      assert_raises(Teek::TclError) { scene.commit }
+      assert good.all?(&:created?)
+      refute bad.created?
+      assert_equal 3, app.command('.cs_dup', :find, :all).split.size
+    end
+
+    bad[:fill] = 'blue'
+    assert_equal 1, scene.commit
+    assert_equal 4, app.command('.cs_dup', :find, :all).split.size
+    refute scene.dirty?
+
+    app.command(:destroy, '.cs_dup')
+  end
+
+  # ---------------------------------------------------------
+  # canvas_create_many / canvas_set_coords_many
+  # ---------------------------------------------------------
+
+  tk_test "canvas_create_many creates one item per coordinate group" do
+    app.command(:canvas, '.cs_many')
+    coords = [0, 0, 2, 2, 10, 10, 12, 12, 20, 20, 22, 22].pack('d*')
+    ids = app.interp.canvas_create_many('.cs_many', :oval, coords,
+                                        options: { fill: 'red', tags: 'pts' })
+
+    assert_equal 3, ids.size
+    assert_equal ids.map(&:to_s), app.command('.cs_many', :find, :withtag, :pts).split
+    assert_equal '10.0 10.0 12.0 12.0', app.command('.cs_many', :coords, ids[1])
+    assert_equal 'red', app.command('.cs_many', :itemcget, ids[2], '-fill')
+
+    lines = app.interp.canvas_create_many('.cs_many', 'line', [0, 0, 5, 0, 5, 5].pack('f*'),
+                                          per_item: 6, format: :float32)
+    assert_equal '0.0 0.0 5.0 0.0 5.0 5.0', app.command('.cs_many', :coords, lines[0])
+
+    app.command(:destroy, '.cs_many')
+  end
+
+  tk_test "canvas_create_many reads an IO::Buffer" do
+    app.command(:canvas, '.cs_iobuf')
+    buf = IO::Buffer.for([1.5, 2.5, 3.5, 4.5].pack('d*'))
+    ids = app.interp.canvas_create_many('.cs_iobuf', :text, buf, options: { text: 'x' })
+
+    assert_equal 2, ids.size
+    assert_equal '3.5 4.5', app.command('.cs_iobuf', :coords, ids[1])
+    app.command(:destroy, '.cs_iobuf')
+  end
+
+  tk_test "canvas_set_coords_many moves items from a packed buffer" do
+    app.command(:canvas, '.cs_move')
+    ids = app.interp.canvas_create_many('.cs_move', :rectangle, ([0.0] * 8).pack('d*'))
+
+    updated = app.interp.canvas_set_coords_many('.cs_move', ids,
+                                                [1, 2, 3, 4, 5, 6, 7, 8].pack('d*'))
+    assert_equal 2, updated
+    assert_equal '1.0 2.0 3.0 4.0', app.command('.cs_move', :coords, ids[0])
+    assert_equal '5.0 6.0 7.0 8.0', app.command('.cs_move', :coords, ids[1])
+
+    app.command(:destroy, '.cs_move')
+  end
+
+  tk_test "packed coordinate batches validate their input" do
+    app.command(:canvas, '.cs_bad')
+    interp = app.interp
+
+    assert_raises(TypeError) { interp.canvas_create_many('.cs_bad', :oval, [0.0] * 8) }
+    assert_raises(ArgumentError) { interp.canvas_create_many('.cs_bad', :polygon, ([0.0] * 6).pack('d*')) }
+    assert_raises(ArgumentError) { interp.canvas_create_many('.cs_bad', :oval, ([0.0] * 3).pack('d*')) }
+    assert_raises(ArgumentError) { interp.canvas_create_many('.cs_bad', :oval, 'abc') }
+    assert_raises(ArgumentError) { interp.canvas_set_coords_many('.cs_bad', [1, 2], ([0.0] * 3).pack('d*')) }
+    assert_raises(TypeError) { interp.canvas_set_coords_many('.cs_bad', ['1'], ([0.0] * 2).pack('d*')) }
+    assert_raises(Teek::TclError) { interp.canvas_create_many('.nope', :oval, ([0.0] * 4).pack('d*')) }
+
+    app.command(:destroy, '.cs_bad')
+  end
+
+  tk_test "canvas_create_many reports the items created before a failure" do
+    app.command(:canvas, '.cs_part')
+    # Stands in for the canvas, rejecting the third create
+    app.tcl_eval(<<~'TCL')
+      set ::cs_calls 0
+      proc cs_flaky {args} {
+        if {[incr ::cs_calls] == 3} { error "rejected" }
+        .cs_part {*}$args
+      }
+    TCL
+    coords = (0...16).map(&:to_f).pack('d*')
+
+    err = assert_raises(Teek::TclError) { app.interp.canvas_create_many('cs_flaky', :oval, coords) }
+    assert_equal 2, err.failed_index
+    assert_equal app.command('.cs_part', :find, :all).split.map(&:to_i), err.created_ids
+
+    app.tcl_eval('rename cs_flaky {}')
+    app.command(:destroy, '.cs_part')
+  end
+
+  tk_test "packed buffers are unlocked when a batch raises" do
+    app.command(:canvas, '.cs_unlock')
+    interp = app.interp
+    packed = ([0.0] * 8).pack('d*')
+
+    assert_raises(ArgumentError) { interp.canvas_create_many('.cs_unlock', :oval, packed, per_item: 3) }
+    assert_raises(TypeError) do
+      interp.canvas_create_many('.cs_unlock', :oval, packed, options: { fill: Object.new })
+    end
+    assert_raises(Teek::TclError) { interp.canvas_create_many('.nope', :oval, packed) }
+    assert_raises(Teek::TclError) { interp.canvas_set_coords_many('.nope', [1, 2], packed) }
+    packed << ([1.0] * 4).pack('d*') # raises if still locked
+
+    buffer = IO::Buffer.for(packed.dup)
+    assert_raises(Teek::TclError) { interp.canvas_create_many('.nope', :oval, buffer) }
+    refute buffer.locked?
+
+    app.command(:destroy, '.cs_unlock')
+  end
+end
@@ -0,0 +1,300 @@
+# frozen_string_literal: true
+
+# Tests for Teek._register_event_source (tkeventsource.c). Check
+# functions are Fiddle closures, standing in for the C function pointers
+# a consumer like teek-sdl2 passes.
+
+require 'minitest/autorun'
+require_relative 'tk_test_helper'
+
+class TestEventSource < Minitest::Test
+  include TeekTestHelper
+
+  tk_test "event-driven source runs only when woken" do
+    require 'fiddle'
+    runs = 0
+    check = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| runs += 1 }
+    src = Teek._register_event_source(check.to_i, 0, nil)
+    begin
+      refute src.polled?
+      5.times { app.update }
+      assert_equal 0, runs
+
+      src.wake
+      app.update
+      assert_equal 1, runs
+      app.update
+      assert_equal 1, runs
+    ensure
+      src.unregister
+    end
+    refute src.registered?
+  end
+
+  tk_test "interval 0 is event-driven too" do
+    require 'fiddle'
+    runs = 0
+    check = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| runs += 1 }
+    src = Teek._register_event_source(check.to_i, 0, 0)
+    begin
+      refute src.polled?
+      sleep 0.01
+      app.update
+      assert_equal 0, runs
+    ensure
+      src.unregister
+    end
+  end
+
+  tk_test "watch_fd runs check_fn when a pipe becomes readable" do
+    require 'fiddle'
+    r, w = IO.pipe
+    got = +''
+    check = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) do |_|
+      got << r.read_nonblock(64, exception: false).to_s
+    end
+    src = Teek._register_event_source(check.to_i, 0, nil)
+    begin
+      src.watch_fd(r.fileno)
+      app.update
+      assert_empty got
+
+      w.write('ping')
+      deadline = Process.clock_gettime(Process::CLOCK_MONOTONIC) + 2
+      app.update until got == 'ping' || Process.clock_gettime(Process::CLOCK_MONOTONIC) > deadline
+      assert_equal 'ping', got
+
+      assert src.unwatch_fd(r.fileno)
+      refute src.unwatch_fd(r.fileno)
+      w.write('pong')
+      sleep 0.01
+      app.update
+      assert_equal 'ping', got
+    ensure
+      src.unregister
+      r.close
+      w.close
+    end
+  end
+
+  tk_test "two sources can watch the same fd" do
+    require 'fiddle'
+    r, w = IO.pipe
+    runs = Hash.new(0)
+    check_a = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| runs[:a] += 1 }
+    check_b = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) do |_|
+      runs[:b] += 1
+      r.read_nonblock(64, exception: false)
+    end
+    a = Teek._register_event_source(check_a.to_i, 0, nil, priority: 1)
+    b = Teek._register_event_source(check_b.to_i, 0, nil)
+    begin
+      a.watch_fd(r.fileno)
+      b.watch_fd(r.fileno)
+      w.write('x')
+      app.update
+      assert_equal 1, runs[:a]
+      assert_equal 1, runs[:b]
+
+      # Unwatching one leaves the other's handler in place
+      a.unwatch_fd(r.fileno)
+      w.write('x')
+      app.update
+      assert_equal 1, runs[:a]
+      assert_equal 2, runs[:b]
+    ensure
+      a.unregister
+      b.unregister
+      r.close
+      w.close
+    end
+  end
+
+  tk_test "wake from another thread" do
+    require 'fiddle'
+    runs = 0
+    check = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| runs += 1 }
+    src = Teek._register_event_source(check.to_i, 0, nil)
+    begin
+      Thread.new { src.wake }.join
+      app.update
+      assert_equal 1, runs
+
+      # The C entry point, as an audio or decoder thread would call it
+      wake = Fiddle::Function.new(Teek._event_source_wake_fn_ptr, [Fiddle::TYPE_VOIDP], Fiddle::TYPE_VOID)
+      Thread.new { wake.call(src.handle) }.join
+      app.update
+      assert_equal 2, runs
+    ensure
+      src.unregister
+    end
+  end
+
+  tk_test "wake_after fires once at its deadline" do
+    require 'fiddle'
+    fired_at = []
+    check = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) do |_|
+      fired_at << Process.clock_gettime(Process::CLOCK_MONOTONIC)
+    end
+    src = Teek._register_event_source(check.to_i, 0, nil)
+    begin
+      armed = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      src.wake_after(20)
+      app.update
+      assert_empty fired_at
+
+      app.update while fired_at.empty? && Process.clock_gettime(Process::CLOCK_MONOTONIC) - armed < 2
+      assert_equal 1, fired_at.size
+      assert_operator fired_at.first - armed, :>=, 0.015
+
+      sleep 0.03
+      app.update
+      assert_equal 1, fired_at.size
+    ensure
+      src.unregister
+    end
+  end
+
+  tk_test "cancel_wake disarms the deadline" do
+    require 'fiddle'
+    runs = 0
+    check = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| runs += 1 }
+    src = Teek._register_event_source(check.to_i, 0, nil)
+    begin
+      src.wake_after(10)
+      assert src.cancel_wake
+      refute src.cancel_wake
+      sleep 0.03
+      app.update
+      assert_equal 0, runs
+    ensure
+      src.unregister
+    end
+  end
+
+  # -- Multiplexer ---------------------------------------------------------
+
+  tk_test "higher priority sources run first in a turn" do
+    require 'fiddle'
+    order = []
+    low_fn = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| order << :low }
+    high_fn = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| order << :high }
+    low = Teek._register_event_source(low_fn.to_i, 0, nil)
+    high = Teek._register_event_source(high_fn.to_i, 0, nil, priority: 10)
+    begin
+      assert_equal 10, high.priority
+      low.wake
+      high.wake
+      app.interp.do_one_event(Teek::ALL_EVENTS | Teek::DONT_WAIT)
+      assert_equal [:high, :low], order
+    ensure
+      low.unregister
+      high.unregister
+    end
+  end
+
+  tk_test "polled source is skipped until its interval is due" do
+    require 'fiddle'
+    runs = 0
+    check = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| runs += 1 }
+    src = Teek._register_event_source(check.to_i, 0, 100)
+    begin
+      assert src.polled?
+      start = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      app.update while Process.clock_gettime(Process::CLOCK_MONOTONIC) - start < 0.05
+      assert_equal 1, runs
+
+      app.update while runs < 2 && Process.clock_gettime(Process::CLOCK_MONOTONIC) - start < 2
+      assert_equal 2, runs
+      assert_operator Process.clock_gettime(Process::CLOCK_MONOTONIC) - start, :>=, 0.09
+    ensure
+      src.unregister
+    end
+  end
+
+  tk_test "runs over budget_us are counted as overruns" do
+    require 'fiddle'
+    check = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| sleep 0.003 }
+    src = Teek._register_event_source(check.to_i, 0, nil, budget_us: 500)
+    begin
+      2.times do
+        src.wake
+        app.update
+      end
+      stats = src.stats
+      assert_equal 2, stats[:runs]
+      assert_equal 2, stats[:overruns]
+    ensure
+      src.unregister
+    end
+  end
+
+  tk_test "turn budget defers the remaining sources to the next turn" do
+    require 'fiddle'
+    order = []
+    slow_fn = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) do |_|
+      order << :slow
+      sleep 0.003
+    end
+    fast_fn = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| order << :fast }
+    slow = Teek._register_event_source(slow_fn.to_i, 0, nil, priority: 10)
+    fast = Teek._register_event_source(fast_fn.to_i, 0, nil)
+    Teek._event_source_turn_budget_us = 1000
+    begin
+      assert_equal 1000, Teek._event_source_turn_budget_us
+      slow.wake
+      fast.wake
+      app.interp.do_one_event(Teek::ALL_EVENTS | Teek::DONT_WAIT)
+      assert_equal [:slow], order
+      app.interp.do_one_event(Teek::ALL_EVENTS | Teek::DONT_WAIT)
+      assert_equal [:slow, :fast], order
+    ensure
+      Teek._event_source_turn_budget_us = 0
+      slow.unregister
+      fast.unregister
+    end
+  end
+
+  tk_test "stats report runs and time spent" do
+    require 'fiddle'
+    check = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| sleep 0.002 }
+    src = Teek._register_event_source(check.to_i, 0, nil)
+    begin
+      assert_equal({ runs: 0, overruns: 0, total_us: 0, max_us: 0 }, src.stats)
+      3.times do
+        src.wake
+        app.update
+      end
+      stats = src.stats
+      assert_equal 3, stats[:runs]
+      assert_equal 0, stats[:overruns]
+      assert_operator stats[:max_us], :>=, 2000
+      assert_operator stats[:total_us], :>=, 3 * 2000
+      assert_operator stats[:total_us], :>=, stats[:max_us]
+    ensure
+      src.unregister
+    end
+  end
+
+  tk_test "a check function can unregister the next source" do
+    require 'fiddle'
+    order = []
+    sources = {}
+    first_fn = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) do |_|
+      order << :first
+      sources[:second].unregister
+    end
+    second_fn = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| order << :second }
+    third_fn = Fiddle::Closure::BlockCaller.new(Fiddle::TYPE_VOID, [Fiddle::TYPE_VOIDP]) { |_| order << :third }
+    sources[:first] = Teek._register_event_source(first_fn.to_i, 0, nil, priority: 2)
+    sources[:second] = Teek._register_event_source(second_fn.to_i, 0, nil, priority: 1)
+    sources[:third] = Teek._register_event_source(third_fn.to_i, 0, nil)
+    begin
+      sources.each_value(&:wake)
+      app.interp.do_one_event(Teek::ALL_EVENTS | Teek::DONT_WAIT)
+      assert_equal [:first, :third], order
+    ensure
+      sources.each_value(&:unregister)
+    end
+  end
+end
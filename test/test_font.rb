@@ -96,4 +96,115 @@ class TestFont < Minitest::Test
     fitted = text[0, r[:bytes]]
     refute(fitted.include?('Wor') && !fitted.include?('World'), "expected word break, got '#{fitted}'")
   end
+
+  # -- font handles --
+
+  tk_test "font_handle is cached per description" do
+    h = app.font_handle('TkDefaultFont')
+    assert_kind_of Teek::FontHandle, h
+    assert_equal 'TkDefaultFont', h.name
+    assert_same h, app.font_handle('TkDefaultFont')
+    h.release
+  end
+
+  tk_test "handles measure the same as font descriptions" do
+    h = app.font_handle('Helvetica 12')
+    text = 'Hello World'
+    assert_equal app.text_width('Helvetica 12', text), app.text_width(h, text)
+    assert_equal app.font_metrics('Helvetica 12'), app.font_metrics(h)
+    assert_equal app.measure_chars('Helvetica 12', text, 40), app.measure_chars(h, text, 40)
+    h.release
+  end
+
+  tk_test "released handle raises and is replaced on next lookup" do
+    h = app.font_handle('TkFixedFont')
+    h.release
+    assert h.released?
+    h.release # no-op
+    assert_raises(Teek::TclError) { app.text_width(h, 'x') }
+    h2 = app.font_handle('TkFixedFont')
+    refute_same h, h2
+    refute h2.released?
+    h2.release
+  end
+
+  tk_test "font_handle raises for unknown font" do
+    assert_raises(Teek::TclError) { app.font_handle('{unbalanced') }
+  end
+
+  # -- text_widths --
+
+  tk_test "text_widths matches text_width per string" do
+    strings = ['', 'a', 'Hello', 'Hello World, this is longer', "caf\u00e9"]
+    expected = strings.map { |t| app.text_width('TkDefaultFont', t) }
+    assert_equal expected, app.text_widths('TkDefaultFont', strings)
+    assert_equal expected, app.text_widths(app.font_handle('TkDefaultFont'), strings)
+  end
+
+  tk_test "text_widths rejects non-string elements" do
+    assert_raises(TypeError) { app.text_widths('TkDefaultFont', ['a', 1]) }
+  end
+
+  # -- fit_text --
+
+  tk_test "fit_text leaves fitting strings untouched" do
+    short = 'Hi'
+    result = app.fit_text('TkDefaultFont', [short, ''], 500)
+    assert_same short, result[0]
+    assert_equal '', result[1]
+  end
+
+  tk_test "fit_text truncates with an ellipsis within the limit" do
+    font = 'TkDefaultFont'
+    text = 'The quick brown fox jumps over the lazy dog'
+    limit = app.text_width(font, text) / 2
+
+    fitted = app.fit_text(font, [text], limit).first
+    assert fitted.end_with?('...'), fitted
+    assert_operator app.text_width(font, fitted), :<=, limit
+    assert text.start_with?(fitted.delete_suffix('...'))
+
+    # One more character would no longer fit
+    prefix = fitted.delete_suffix('...')
+    longer = text[0, prefix.length + 1] + '...'
+    assert_operator app.text_width(font, longer), :>, limit
+  end
+
+  tk_test "fit_text agrees with measure_chars for Latin and non-Latin text" do
+    font = app.font_handle('TkDefaultFont')
+    texts = ["Caf\u00e9 cr\u00e8me br\u00fbl\u00e9e", "\u65e5\u672c\u8a9e\u306e\u30c6\u30ad\u30b9\u30c8\u3067\u3059"]
+    texts.each do |text|
+      limit = app.text_width(font, text) * 2 / 3
+      fitted = app.fit_text(font, [text], limit, ellipsis: '').first
+      expected = text.byteslice(0, app.measure_chars(font, text, limit)[:bytes])
+      assert_equal expected, fitted
+      assert fitted.valid_encoding?
+    end
+  end
+
+  tk_test "fit_text returns empty string when the ellipsis does not fit" do
+    assert_equal [''], app.fit_text('TkDefaultFont', ['Hello'], 1)
+  end
+
+  tk_test "fit_text rejects a negative width" do
+    assert_raises(ArgumentError) { app.fit_text('TkDefaultFont', ['x'], -1) }
+  end
+
+  tk_test "fit_text notices a named font being reconfigured" do
+    app.tcl_eval('font create TeekFitFont -family Helvetica -size 10')
+    begin
+      font = app.font_handle('TeekFitFont')
+      text = 'The quick brown fox jumps over the lazy dog'
+      limit = app.text_width(font, text) / 2
+      small = app.fit_text(font, [text], limit, ellipsis: '').first
+
+      app.tcl_eval('font configure TeekFitFont -size 20')
+      large = app.fit_text(font, [text], limit, ellipsis: '').first
+      expected = text.byteslice(0, app.measure_chars(font, text, limit)[:bytes])
+      assert_equal expected, large
+      assert_operator large.length, :<, small.length
+    ensure
+      app.tcl_eval('font delete TeekFitFont')
+    end
+  end
 end
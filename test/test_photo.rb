@@ -1,5 +1,6 @@
 # frozen_string_literal: true
 
+require 'tempfile'
 require 'minitest/autorun'
 require_relative 'tk_test_helper'
 
@@ -118,6 +119,29 @@ class TestPhoto < Minitest::Test
     p.delete
   end
 
+  tk_test "put_block reads frozen Strings and IO::Buffers in place" do
+    p = Teek::Photo.new(app, width: 2, height: 1)
+    frozen = Ractor.make_shareable(([10, 20, 30, 255] * 2).pack('C*'))
+    p.put_block(frozen, 2, 1)
+    assert_equal [10, 20, 30, 255], p.get_image.bytes.first(4)
+
+    buf = IO::Buffer.for(([40, 50, 60, 255] * 2).pack('C*'))
+    p.put_block(buf, 2, 1)
+    p.put_zoomed_block(IO::Buffer.for([1, 2, 3].pack('C*')), 1, 1, x: 1, format: :rgb)
+    assert_equal [40, 50, 60, 255, 1, 2, 3, 255], p.get_image.bytes
+    refute buf.locked?
+
+    assert_raises(ArgumentError) { p.put_block(IO::Buffer.for('abc'), 2, 1) }
+    assert_raises(TypeError) { p.put_block([0] * 8, 2, 1) }
+
+    # Objects with to_str are still accepted
+    pixels = Object.new
+    def pixels.to_str = ([70, 80, 90, 255] * 2).pack('C*')
+    p.put_block(pixels, 2, 1)
+    assert_equal [70, 80, 90, 255], p.get_image.bytes.first(4)
+    p.delete
+  end
+
   # ===========================================
   # Validation
   # ===========================================
@@ -193,6 +217,85 @@ class TestPhoto < Minitest::Test
     p.delete
   end
 
+  # ===========================================
+  # Pixel format conversion (tkpixconv.c kernels)
+  # ===========================================
+
+  tk_test "put_block RGB format adds opaque alpha" do
+    p = Teek::Photo.new(app, width: 20, height: 1)
+    # 20 pixels so the SIMD path and its scalar tail both run
+    rgb = (0...20).map { |i| [i, 100, 255 - i] }.flatten.pack('C*')
+    p.put_block(rgb, 20, 1, format: :rgb)
+
+    assert_equal [0, 100, 255, 255], p.get_pixel(0, 0)
+    assert_equal [19, 100, 236, 255], p.get_pixel(19, 0)
+
+    p.delete
+  end
+
+  tk_test "put_block gray format expands to RGB" do
+    p = Teek::Photo.new(app, width: 2, height: 1)
+    p.put_block([0, 200].pack('CC'), 2, 1, format: :gray)
+
+    assert_equal [0, 0, 0, 255], p.get_pixel(0, 0)
+    assert_equal [200, 200, 200, 255], p.get_pixel(1, 0)
+
+    p.delete
+  end
+
+  tk_test "put_block size check uses the format's bytes per pixel" do
+    p = Teek::Photo.new(app, width: 2, height: 2)
+    err = assert_raises(ArgumentError) do
+      p.put_block("\0" * 16, 2, 2, format: :rgb)
+    end
+    assert_includes err.message, "expected 12 bytes"
+
+    assert_raises(ArgumentError) { p.put_block("\0" * 16, 2, 2, format: :cmyk) }
+
+    p.delete
+  end
+
+  tk_test "put_block premultiplied input is unpremultiplied" do
+    p = Teek::Photo.new(app, width: 1, height: 1)
+    # 50% alpha red, premultiplied: R=128 stands for full red
+    p.put_block([128, 0, 0, 128].pack('CCCC'), 1, 1, premultiplied: true)
+
+    assert_equal [255, 0, 0, 128], p.get_pixel(0, 0)
+
+    p.delete
+  end
+
+  tk_test "get_image converts to the requested format" do
+    p = Teek::Photo.new(app, width: 2, height: 1)
+    p.put_block([10, 20, 30, 255, 255, 255, 255, 128].pack('C*'), 2, 1)
+
+    assert_equal [10, 20, 30, 255, 255, 255], p.get_image(format: :rgb)[:data].bytes
+    assert_equal [30, 20, 10, 255, 255, 255, 255, 128],
+                 p.get_image(format: :argb)[:data].bytes
+    # BT.601 luma: (77*10 + 150*20 + 29*30 + 128) >> 8 = 18
+    assert_equal [18, 255], p.get_image(format: :gray, unpack: true)[:pixels]
+    assert_equal [10, 20, 30, 255, 128, 128, 128, 128],
+                 p.get_image(premultiply: true)[:data].bytes
+
+    p.delete
+  end
+
+  tk_test "read_into sizes the buffer for the requested format" do
+    p = Teek::Photo.new(app, width: 4, height: 3)
+    p.put_block([1, 2, 3, 255].pack('CCCC') * 12, 4, 3)
+
+    buf = String.new(encoding: Encoding::BINARY)
+    assert_equal [4, 3], p.read_into(buf, format: :rgb)
+    assert_equal 36, buf.bytesize
+    assert_equal [1, 2, 3], buf.bytes.first(3)
+
+    p.delete
+  end
+
+  tk_test "pixel_convert_impl names the selected kernel set" do
+    assert_includes %w[avx2 ssse3 sse2 neon scalar], Teek.pixel_convert_impl
+  end
+
   # ===========================================
   # Composite rules
   # ===========================================
@@ -283,6 +386,140 @@ class TestPhoto < Minitest::Test
     p.delete
   end
 
+  # ===========================================
+  # put_from_mmap
+  # ===========================================
+
+  tk_test "put_from_mmap reads a frame at an offset with a row stride" do
+    red = [255, 0, 0, 255].pack('C*')
+    pad = "\xAA".b * 4
+    file = Tempfile.new(['frame', '.raw'], binmode: true)
+    file.write("HEADER16BYTES..." + (red * 2 + pad) * 2)
+    file.flush
+
+    p = Teek::Photo.new(app, width: 2, height: 2)
+    p.put_from_mmap(file.path, offset: 16, width: 2, height: 2, stride: 12)
+
+    assert_equal red * 4, p.get_image[:data]
+    p.delete
+    file.close!
+  end
+
+  tk_test "put_from_mmap reuses the mapping and sees rewritten frames" do
+    file = Tempfile.new(['frame', '.raw'], binmode: true)
+    file.write([10, 20, 30].pack('C*') * 4)
+    file.flush
+
+    p = Teek::Photo.new(app, width: 2, height: 2)
+    p.put_from_mmap(file.path, width: 2, height: 2, format: :rgb)
+    assert_equal [10, 20, 30, 255], p.get_pixel(1, 1)
+
+    file.rewind
+    file.write([200].pack('C') * 4 + [40, 50, 60].pack('C*') * 4)
+    file.flush
+    p.put_from_mmap(file.path, width: 2, height: 2, format: :gray)
+    assert_equal [200, 200, 200, 255], p.get_pixel(0, 0)
+    p.put_from_mmap(file.path, offset: 4, width: 2, height: 2, format: :rgb)
+    assert_equal [40, 50, 60, 255], p.get_pixel(1, 0)
+
+    p.delete
+    file.close!
+  end
+
+  tk_test "put_from_mmap accepts an open IO" do
+    file = Tempfile.new(['frame', '.raw'], binmode: true)
+    file.write([1, 2, 3, 4].pack('C*'))
+    file.flush
+
+    p = Teek::Photo.new(app, width: 1, height: 1)
+    p.put_from_mmap(file, width: 1, height: 1, format: :argb)
+    assert_equal [3, 2, 1, 4], p.get_pixel(0, 0)
+
+    p.delete
+    file.close!
+  end
+
+  tk_test "put_from_mmap rejects a frame past the end of the file" do
+    file = Tempfile.new(['frame', '.raw'], binmode: true)
+    file.write("\0" * 15)
+    file.flush
+
+    p = Teek::Photo.new(app, width: 2, height: 2)
+    assert_raises(ArgumentError) { p.put_from_mmap(file.path, width: 2, height: 2) }
+    assert_raises(ArgumentError) { p.put_from_mmap(file.path, width: 1, height: 1, stride: 3) }
+
+    p.delete
+    file.close!
+  end
+
+  # ===========================================
+  # resample_to / scaled
+  # ===========================================
+
+  tk_test "resample_to nearest at a non-integer ratio" do
+    src = Teek::Photo.new(app, width: 2, height: 1)
+    src.put_block([255, 0, 0, 255, 0, 0, 255, 255].pack('C*'), 2, 1)
+    dest = Teek::Photo.new(app, width: 3, height: 2)
+
+    src.resample_to(dest, filter: :nearest)
+
+    assert_equal [255, 0, 0, 255], dest.get_pixel(0, 1)
+    assert_equal [0, 0, 255, 255], dest.get_pixel(2, 1)
+
+    src.delete
+    dest.delete
+  end
+
+  tk_test "resample_to area averages the covered pixels" do
+    src = Teek::Photo.new(app, width: 4, height: 2)
+    row = [0, 0, 0, 255, 200, 100, 0, 255] * 2
+    src.put_block((row + row).pack('C*'), 4, 2)
+
+    dest = Teek::Photo.new(app, width: 1, height: 1)
+    src.resample_to(dest, filter: :area)
+
+    assert_equal [100, 50, 0, 255], dest.get_pixel(0, 0)
+
+    src.delete
+    dest.delete
+  end
+
+  tk_test "resample_to keeps a flat color flat with every filter" do
+    src = Teek::Photo.new(app, width: 37, height: 23)
+    src.put_block([12, 34, 56, 255].pack('C*') * (37 * 23), 37, 23)
+
+    %i[nearest bilinear area].each do |filter|
+      dest = src.scaled(301, 7, filter: filter)
+      assert_equal [301, 7], dest.get_size
+      data = dest.get_image[:data]
+      assert_equal [[12, 34, 56, 255]], data.unpack('C*').each_slice(4).to_a.uniq, filter.to_s
+      dest.delete
+    end
+
+    src.delete
+  end
+
+  tk_test "resample_to a source region at an offset" do
+    src = Teek::Photo.new(app, width: 4, height: 4)
+    src.put_block([0, 0, 0, 255].pack('C*') * 16, 4, 4)
+    src.put_block([0, 255, 0, 255].pack('C*') * 4, 2, 2, x: 2, y: 2)
+    dest = Teek::Photo.new(app, width: 10, height: 10)
+
+    src.resample_to(dest, width: 5, height: 5, x: 5, y: 5, from: [2, 2, 2, 2])
+
+    assert_equal [0, 0, 0, 0], dest.get_pixel(4, 4)
+    assert_equal [0, 255, 0, 255], dest.get_pixel(7, 7)
+
+    src.delete
+    dest.delete
+  end
+
+  tk_test "resample_to rejects an unknown filter" do
+    src = Teek::Photo.new(app, width: 2, height: 2)
+    assert_raises(ArgumentError) { src.resample_to(src, filter: :lanczos) }
+    src.delete
+  end
+
   # ===========================================
   # get_image
   # ===========================================
@@ -334,6 +571,107 @@ class TestPhoto < Minitest::Test
     p.delete
   end
 
+  # ===========================================
+  # decode_async
+  # ===========================================
+
+  tk_test "decode_async fills the photo from PPM bytes" do
+    ppm = "P6\n2 1\n255\n".b + [255, 0, 0, 0, 0, 255].pack('C*')
+    loaded = nil
+    p = Teek::Photo.decode_async(app, ppm) { |photo| loaded = photo }
+
+    wait_until(timeout: 3.0) { loaded }
+    assert_same p, loaded
+    assert_equal [2, 1], p.get_size
+    assert_equal [255, 0, 0, 255], p.get_pixel(0, 0)
+    assert_equal [0, 0, 255, 255], p.get_pixel(1, 0)
+
+    p.delete
+  end
+
+  tk_test "decode_async decodes a PNG file to the same pixels Tk does" do
+    path = File.expand_path('../sample/yam/assets/MINESWEEPER_1.png', __dir__)
+    loaded = false
+    p = Teek::Photo.decode_async(app, path) { loaded = true }
+    ref = Teek::Photo.new(app, file: path)
+
+    wait_until(timeout: 5.0) { loaded }
+    assert loaded, "decode should complete"
+    assert_equal ref.get_size, p.get_size
+    assert_equal ref.get_image[:data], p.get_image[:data]
+
+    p.delete
+    ref.delete
+  end
+
+  tk_test "decode_async reports errors through on_error" do
+    error = nil
+    p = Teek::Photo.decode_async(app, "/nonexistent/teek.png", on_error: ->(e) { error = e })
+
+    wait_until(timeout: 3.0) { error }
+    assert_kind_of SystemCallError, error
+    assert_equal [0, 0], p.get_size
+
+    p.delete
+  end
+
+  # ===========================================
+  # read_into
+  # ===========================================
+
+  tk_test "read_into fills a caller-provided String and reuses it" do
+    p = Teek::Photo.new(app, width: 4, height: 2)
+    p.put_block([10, 20, 30, 40].pack('CCCC') * 8, 4, 2)
+
+    buf = String.new(capacity: 32, encoding: Encoding::BINARY)
+    assert_equal [4, 2], p.read_into(buf)
+    assert_equal 32, buf.bytesize
+    assert_equal [10, 20, 30, 40], buf[0, 4].unpack('CCCC')
+    assert_equal p.get_image[:data], buf
+
+    # Same-size reads keep the same String object and contents layout
+    p.put_block([1, 2, 3, 4].pack('CCCC'), 1, 1, x: 3, y: 1)
+    same = buf
+    p.read_into(buf)
+    assert_same same, buf
+    assert_equal [1, 2, 3, 4], buf[-4, 4].unpack('CCCC')
+
+    p.delete
+  end
+
+  tk_test "read_into reads a clamped sub-region" do
+    p = Teek::Photo.new(app, width: 10, height: 10)
+    p.put_block([0, 255, 0, 255].pack('CCCC') * 100, 10, 10)
+
+    buf = "".b
+    assert_equal [3, 2], p.read_into(buf, x: 7, y: 8, width: 5, height: 5)
+    assert_equal 3 * 2 * 4, buf.bytesize
+
+    p.delete
+  end
+
+  tk_test "read_into writes into an IO::Buffer" do
+    p = Teek::Photo.new(app, width: 2, height: 2)
+    p.put_block([255, 0, 0, 255].pack('CCCC') * 4, 2, 2)
+
+    io_buf = IO::Buffer.new(64)
+    assert_equal [2, 2], p.read_into(io_buf)
+    assert_equal [255, 0, 0, 255], io_buf.get_string(0, 4).unpack('CCCC')
+
+    small = IO::Buffer.new(8)
+    err = assert_raises(ArgumentError) { p.read_into(small) }
+    assert_includes err.message, "too small"
+
+    p.delete
+  end
+
+  tk_test "read_into rejects frozen and non-buffer arguments" do
+    p = Teek::Photo.new(app, width: 1, height: 1)
+    assert_raises(FrozenError) { p.read_into("".freeze) }
+    assert_raises(TypeError) { p.read_into([]) }
+    p.delete
+  end
+
   # ===========================================
   # get_pixel
   # ===========================================
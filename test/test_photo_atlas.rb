@@ -0,0 +1,120 @@
+# frozen_string_literal: true
+
+# Tests for Teek::PhotoAtlas - many sprites packed into one photo, with
+# per-sprite Tk images created only when a sprite is actually used.
+
+require 'minitest/autorun'
+require_relative 'tk_test_helper'
+
+class TestPhotoAtlas < Minitest::Test
+  include TeekTestHelper
+
+  tk_test "sprites are packed without overlapping" do
+    atlas = Teek::PhotoAtlas.new(app, width: 64, height: 16, padding: 1)
+    sprites = 20.times.map do |i|
+      size = 5 + (i % 4) * 3
+      atlas.add(i, [i, 0, 0, 255].pack('C*') * (size * size), size, size)
+    end
+
+    sprites.combination(2).each do |a, b|
+      apart = a.x + a.width <= b.x || b.x + b.width <= a.x ||
+              a.y + a.height <= b.y || b.y + b.height <= a.y
+      assert apart, "#{a.inspect} overlaps #{b.inspect}"
+    end
+    sprites.each { |s| assert_operator s.x + s.width, :<=, 64 }
+
+    _, height = atlas.photo.get_size
+    assert_operator height, :>=, atlas.used_height - 1
+    assert_equal 20, atlas.size
+    atlas.delete
+  end
+
+  tk_test "sprites are not materialized until used" do
+    atlas = Teek::PhotoAtlas.new(app, width: 32, height: 32)
+    sprite = atlas.add(:red, [255, 0, 0, 255].pack('C*') * 16, 4, 4)
+    before = app.tcl_eval('image names').split.size
+
+    refute sprite.materialized?
+    name = sprite.to_s
+    assert sprite.materialized?
+    assert_equal name, atlas[:red].image_name
+    assert_equal before + 1, app.tcl_eval('image names').split.size
+    assert_equal '4 4', app.tcl_eval("list [image width #{name}] [image height #{name}]")
+    assert_equal [255, 0, 0, 255], app.interp.photo_get_pixel(name, 3, 3)
+
+    atlas.delete
+  end
+
+  tk_test "a sprite can be used directly as an image option" do
+    atlas = Teek::PhotoAtlas.new(app, width: 32, height: 32)
+    sprite = atlas.add(:blue, [0, 0, 255, 255].pack('C*') * 4, 2, 2)
+    app.command(:canvas, '.atlas_c')
+    id = app.command('.atlas_c', :create, :image, 0, 0, image: sprite, anchor: :nw)
+
+    assert_equal sprite.image_name, app.command('.atlas_c', :itemcget, id, '-image')
+
+    app.command(:destroy, '.atlas_c')
+    atlas.delete
+  end
+
+  tk_test "add_photo copies a region out of another photo" do
+    src = Teek::Photo.new(app, width: 4, height: 4)
+    src.put_block([0, 0, 0, 255].pack('C*') * 16, 4, 4)
+    src.put_block([0, 200, 0, 255].pack('C*') * 4, 2, 2, x: 2, y: 1)
+    atlas = Teek::PhotoAtlas.new(app, width: 16, height: 16)
+
+    sprite = atlas.add_photo(:green, src, from: [2, 1, 2, 2])
+    src.delete
+
+    assert_equal [2, 2], [sprite.width, sprite.height]
+    assert_equal [0, 200, 0, 255].pack('C*') * 4, sprite.pixels
+    atlas.delete
+  end
+
+  tk_test "replace updates the atlas and any materialized image" do
+    atlas = Teek::PhotoAtlas.new(app, width: 16, height: 16)
+    sprite = atlas.add(:tile, [0, 0, 0, 255].pack('C*') * 4, 2, 2)
+    name = sprite.image_name
+
+    atlas.replace(:tile, [9, 8, 7, 255].pack('C*') * 4)
+
+    assert_equal [9, 8, 7, 255], app.interp.photo_get_pixel(name, 1, 1)
+    assert_equal [9, 8, 7, 255].pack('C*') * 4, sprite.pixels
+    atlas.delete
+  end
+
+  tk_test "release deletes the image and the sprite rematerializes on demand" do
+    atlas = Teek::PhotoAtlas.new(app, width: 16, height: 16)
+    sprite = atlas.add(:s, [1, 2, 3, 255].pack('C*') * 4, 2, 2)
+    name = sprite.image_name
+
+    sprite.release
+    refute sprite.materialized?
+    refute_includes app.tcl_eval('image names').split, name
+
+    assert_equal [1, 2, 3, 255], app.interp.photo_get_pixel(sprite.to_s, 0, 0)
+    atlas.delete
+  end
+
+  tk_test "add rejects duplicate keys and oversized sprites" do
+    atlas = Teek::PhotoAtlas.new(app, width: 8, height: 8)
+    atlas.add(:a, [0, 0, 0, 255].pack('C*'), 1, 1)
+
+    assert_raises(ArgumentError) { atlas.add(:a, [0, 0, 0, 255].pack('C*'), 1, 1) }
+    assert_raises(ArgumentError) { atlas.add(:wide, [0, 0, 0, 255].pack('C*') * 9, 9, 1) }
+    atlas.delete
+  end
+
+  tk_test "photo_copy_region clamps to the source" do
+    src = Teek::Photo.new(app, width: 3, height: 3)
+    dst = Teek::Photo.new(app, width: 10, height: 10)
+
+    assert_equal [2, 1], app.interp.photo_copy_region(src.name, dst.name,
+                                                      src_x: 1, src_y: 2, width: 50, height: 50)
+    assert_equal [0, 0], app.interp.photo_copy_region(src.name, dst.name, src_x: 3)
+    assert_raises(Teek::TclError) { app.interp.photo_copy_region('nope', dst.name) }
+
+    src.delete
+    dst.delete
+  end
+end
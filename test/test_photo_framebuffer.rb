@@ -0,0 +1,120 @@
+# frozen_string_literal: true
+
+# Tests for Teek::PhotoFramebuffer (Photo#framebuffer) - the persistent
+# C-side RGBA buffer that tracks dirty rectangles and flushes only those
+# regions to its photo.
+
+require 'minitest/autorun'
+require_relative 'tk_test_helper'
+
+class TestPhotoFramebuffer < Minitest::Test
+  include TeekTestHelper
+
+  tk_test "framebuffer defaults to the photo's size and starts clean" do
+    p = Teek::Photo.new(app, width: 12, height: 7)
+    fb = p.framebuffer
+    assert_equal 12, fb.width
+    assert_equal 7, fb.height
+    assert_equal p.name, fb.photo_path
+    refute fb.dirty?
+    assert_equal 0, fb.flush
+    p.delete
+  end
+
+  tk_test "writes are invisible to the photo until flush" do
+    p = Teek::Photo.new(app, width: 10, height: 10)
+    fb = p.framebuffer
+    fb.set_pixel(3, 4, 255, 0, 0)
+
+    assert_equal [255, 0, 0, 255], fb.get_pixel(3, 4)
+    assert_equal [0, 0, 0, 0], p.get_pixel(3, 4)
+
+    assert_equal 1, fb.flush
+    assert_equal [255, 0, 0, 255], p.get_pixel(3, 4)
+    refute fb.dirty?
+    p.delete
+  end
+
+  tk_test "flush pushes only dirty regions" do
+    p = Teek::Photo.new(app, width: 100, height: 100)
+    p.put_block([0, 0, 255, 255].pack('CCCC') * 10_000, 100, 100)
+
+    fb = p.framebuffer
+    fb.set_pixel(1, 1, 255, 0, 0)
+    fb.set_pixel(98, 98, 0, 255, 0)
+    assert_equal [[1, 1, 1, 1], [98, 98, 1, 1]], fb.dirty_rects.sort
+
+    assert_equal 2, fb.flush
+    assert_equal [255, 0, 0, 255], p.get_pixel(1, 1)
+    assert_equal [0, 255, 0, 255], p.get_pixel(98, 98)
+    # Untouched pixels keep the photo's own content, not the
+    # framebuffer's transparent default
+    assert_equal [0, 0, 255, 255], p.get_pixel(50, 50)
+    p.delete
+  end
+
+  tk_test "adjacent writes merge into one dirty rect" do
+    p = Teek::Photo.new(app, width: 50, height: 50)
+    fb = p.framebuffer
+    10.times { |i| fb.set_pixel(5 + i, 5, 255, 255, 255) }
+    assert_equal [[5, 5, 10, 1]], fb.dirty_rects
+    p.delete
+  end
+
+  tk_test "scattered writes are capped to a bounded number of rects" do
+    p = Teek::Photo.new(app, width: 400, height: 400)
+    fb = p.framebuffer
+    20.times { |i| fb.set_pixel(i * 19, (i * 37) % 400, 1, 2, 3) }
+    assert_operator fb.dirty_rects.size, :<=, 8
+    fb.flush
+    20.times { |i| assert_equal [1, 2, 3, 255], p.get_pixel(i * 19, (i * 37) % 400) }
+    p.delete
+  end
+
+  tk_test "fill_rect and blit clip to the buffer" do
+    p = Teek::Photo.new(app, width: 10, height: 10)
+    fb = p.framebuffer
+
+    fb.fill_rect(-5, -5, 8, 8, 0, 255, 0, 128)
+    assert_equal [[0, 0, 3, 3]], fb.dirty_rects
+    fb.flush
+    assert_equal [0, 255, 0, 128], p.get_pixel(2, 2)
+    assert_equal [0, 0, 0, 0], p.get_pixel(3, 3)
+
+    red = [255, 0, 0, 255].pack('CCCC') * 16
+    fb.blit(red, 8, 8, 4, 4)
+    assert_equal [[8, 8, 2, 2]], fb.dirty_rects
+    fb.flush
+    assert_equal [255, 0, 0, 255], p.get_pixel(9, 9)
+    p.delete
+  end
+
+  tk_test "blit rejects wrong data size" do
+    p = Teek::Photo.new(app, width: 10, height: 10)
+    fb = p.framebuffer
+    err = assert_raises(ArgumentError) { fb.blit("short", 0, 0, 2, 2) }
+    assert_includes err.message, "size mismatch"
+    p.delete
+  end
+
+  tk_test "reload syncs the buffer from the photo" do
+    p = Teek::Photo.new(app, width: 4, height: 4)
+    p.put_block([9, 8, 7, 255].pack('CCCC') * 16, 4, 4)
+
+    fb = p.framebuffer(reload: true)
+    assert_equal [9, 8, 7, 255], fb.get_pixel(2, 2)
+    refute fb.dirty?
+    p.delete
+  end
+
+  tk_test "clear marks the whole buffer dirty" do
+    p = Teek::Photo.new(app, width: 6, height: 6)
+    p.put_block([255, 255, 255, 255].pack('CCCC') * 36, 6, 6)
+    fb = p.framebuffer
+    fb.clear
+    assert_equal [[0, 0, 6, 6]], fb.dirty_rects
+    fb.flush
+    assert_equal [0, 0, 0, 0], p.get_pixel(5, 5)
+    p.delete
+  end
+end
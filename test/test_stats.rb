@@ -0,0 +1,66 @@
+# frozen_string_literal: true
+
+# Tests for Teek.stats - bridge instrumentation counters (tkstats.c).
+
+require 'minitest/autorun'
+require_relative 'tk_test_helper'
+
+class TestStats < Minitest::Test
+  include TeekTestHelper
+
+  tk_test "stats are off by default and record nothing" do
+    Teek.reset_stats
+    refute Teek.stats_enabled?
+    app.interp.tcl_invoke('set', '::stats_x', '1')
+    assert_empty Teek.stats[:commands]
+  end
+
+  tk_test "tcl_invoke and tcl_eval are counted per command name" do
+    Teek.reset_stats
+    Teek.stats_enabled = true
+    begin
+      3.times { app.interp.tcl_invoke('set', '::stats_x', '1') }
+      app.interp.tcl_eval('incr ::stats_x; set ::stats_y 2')
+    ensure
+      Teek.stats_enabled = false
+    end
+
+    commands = Teek.stats[:commands]
+    assert_equal 3, commands['set'][:count]
+    assert_equal 1, commands['incr'][:count]
+    assert_equal 3, commands['set'][:histogram].values.sum
+    assert_operator commands['set'][:p99_us], :>=, commands['set'][:p50_us]
+  end
+
+  tk_test "callbacks and cross-thread events are timed" do
+    Teek.reset_stats
+    Teek.stats_enabled = true
+    begin
+      id = app.register_callback(proc { sleep 0.002 })
+      app.tcl_eval("ruby_callback #{id}")
+
+      Thread.new { app.interp.tcl_eval('set ::stats_z 1') }.tap do |t|
+        app.update while t.alive?
+      end.join
+    ensure
+      Teek.stats_enabled = false
+    end
+
+    stats = Teek.stats
+    assert_operator stats[:callbacks][:count], :>=, 1
+    assert_operator stats[:callbacks][:max_us], :>=, 2000
+    assert_operator stats[:thread_queue][:pushed], :>=, 1
+    assert_operator stats[:thread_queue][:wait][:count], :>=, 1
+  end
+
+  tk_test "reset_stats clears counters" do
+    Teek.stats_enabled = true
+    app.interp.tcl_invoke('set', '::stats_x', '1')
+    Teek.stats_enabled = false
+    Teek.reset_stats
+
+    stats = Teek.stats
+    assert_empty stats[:commands]
+    assert_equal 0, stats[:callbacks][:count]
+  end
+end
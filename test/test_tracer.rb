@@ -0,0 +1,104 @@
+# frozen_string_literal: true
+
+# Tests for Teek::Tracer - event-loop span recording (tktrace.c) and
+# Chrome trace export.
+
+require 'minitest/autorun'
+require_relative 'tk_test_helper'
+
+class TestTracer < Minitest::Test
+  include TeekTestHelper
+
+  tk_test "callbacks are recorded with id and widget" do
+    Teek::Tracer.clear
+    Teek::Tracer.start
+    begin
+      id = app.register_callback(proc { |_w| sleep 0.005 })
+      app.tcl_eval("ruby_callback #{id} .")
+    ensure
+      Teek::Tracer.stop
+    end
+
+    span = Teek::Tracer.spans.find { |s| s.kind == :callback && s.value == id }
+    assert span, "no callback span recorded"
+    assert_equal '.', span.detail
+    assert_operator span.duration_us, :>=, 5000
+  end
+
+  tk_test "numeric arguments are not taken for the widget" do
+    Teek::Tracer.clear
+    Teek::Tracer.start
+    begin
+      id = app.register_callback(proc { |*| })
+      app.tcl_eval("ruby_callback #{id} .5 .top_1")
+      app.tcl_eval("ruby_callback #{id} .25")
+    ensure
+      Teek::Tracer.stop
+    end
+
+    spans = Teek::Tracer.spans.select { |s| s.kind == :callback && s.value == id }
+    assert_equal ['.top_1', nil], spans.map(&:detail)
+  end
+
+  tk_test "queued thread events record their queue wait" do
+    Teek::Tracer.clear
+    Teek::Tracer.start
+    begin
+      t = Thread.new { app.interp.tcl_invoke('set', '::trace_x', '1') }
+      app.update while t.alive?
+      t.join
+    ensure
+      Teek::Tracer.stop
+    end
+
+    span = Teek::Tracer.spans.find { |s| s.kind == :thread_event }
+    assert span, "no thread event span recorded"
+    assert_equal 'queued invoke', span.name
+    assert_equal 'set', span.detail
+    assert_operator span.value, :>=, 0
+  end
+
+  tk_test "min_us drops short spans and stalls finds long ones" do
+    Teek::Tracer.clear
+    Teek::Tracer.start(min_us: 10_000)
+    begin
+      quick = app.register_callback(proc {})
+      slow = app.register_callback(proc { sleep 0.03 })
+      app.tcl_eval("ruby_callback #{quick}")
+      app.tcl_eval("ruby_callback #{slow}")
+    ensure
+      Teek::Tracer.stop
+    end
+
+    ids = Teek::Tracer.spans.select { |s| s.kind == :callback }.map(&:value)
+    refute_includes ids, quick
+    assert_includes ids, slow
+    assert_equal slow, Teek::Tracer.stalls(25).first.value
+  end
+
+  tk_test "dump writes Chrome trace JSON" do
+    require 'json'
+    require 'tmpdir'
+
+    Teek::Tracer.clear
+    Teek::Tracer.start
+    begin
+      id = app.register_callback(proc {})
+      app.tcl_eval("ruby_callback #{id}")
+    ensure
+      Teek::Tracer.stop
+    end
+
+    Dir.mktmpdir do |dir|
+      path = Teek::Tracer.dump(File.join(dir, 'trace.json'), app: app)
+      trace = JSON.parse(File.read(path))
+      events = trace['traceEvents'].select { |e| e['ph'] == 'X' }
+      refute_empty events
+      event = events.find { |e| e['name'] == "callback #{id}" }
+      assert event
+      assert_equal 'callback', event['cat']
+      assert_kind_of Integer, event['ts']
+      assert_kind_of Integer, event['dur']
+    end
+  end
+end
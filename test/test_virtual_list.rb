@@ -0,0 +1,144 @@
+# frozen_string_literal: true
+
+# Tests for Teek::VirtualList - a canvas-backed list that only fetches and
+# draws the rows scrolled into view.
+
+require 'minitest/autorun'
+require_relative 'tk_test_helper'
+
+class TestVirtualList < Minitest::Test
+  include TeekTestHelper
+
+  tk_test "only visible rows are fetched" do
+    provider = Class.new do
+      attr_reader :calls
+
+      def initialize
+        @calls = []
+      end
+
+      def size = 1_000_000
+
+      def rows(first, count)
+        @calls << [first, count]
+        (first...first + count).map { |i| ["row #{i}", i.to_s] }
+      end
+    end.new
+
+    list = Teek::VirtualList.new(app, provider, row_height: 20, height: 200,
+                                 columns: [{ width: 120 }, { width: 80 }])
+
+    assert_equal 1, provider.calls.size
+    first, count = provider.calls[0]
+    assert_equal 0, first
+    assert_operator count, :<=, 200 / 20 + 2
+
+    list.scroll_rows(1)
+    list.scroll_rows(-1)
+    assert_equal 2, provider.calls.size, "scrolling back should hit the row cache"
+
+    app.command(:destroy, list)
+  end
+
+  tk_test "scrolling moves the visible range" do
+    list = Teek::VirtualList.new(app, (0...500).to_a, row_height: 10, height: 100)
+
+    assert_equal 0..9, list.visible_range
+    list.scroll_rows(25)
+    assert_equal 25..34, list.visible_range
+    list.scroll_to(5)
+    assert_equal 0..10, list.visible_range
+    list.scroll_to(1_000_000)
+    assert_equal 490..499, list.visible_range
+
+    app.command(:destroy, list)
+  end
+
+  tk_test "slots show the rows in view" do
+    list = Teek::VirtualList.new(app, (0...100).map { |i| "item #{i}" },
+                                 row_height: 10, height: 50)
+    list.scroll_rows(40)
+
+    shown = visible_canvas_texts(list.canvas)
+    assert_includes shown, 'item 40'
+    assert_includes shown, 'item 44'
+    refute_includes shown, 'item 39'
+
+    app.command(:destroy, list)
+  end
+
+  tk_test "select reports the row and scrolls it into view" do
+    list = Teek::VirtualList.new(app, (0...100).to_a, row_height: 10, height: 50)
+    selected = []
+    list.on_select { |i| selected << i }
+
+    list.select(60)
+    assert_equal 60, list.selection
+    assert_includes list.visible_range, 60
+    list.select(60)
+    list.select(nil)
+    list.select(500)
+
+    assert_equal [60, nil], selected
+    app.command(:destroy, list)
+  end
+
+  tk_test "reload picks up a changed provider" do
+    data = (0...10).to_a
+    list = Teek::VirtualList.new(app, data, row_height: 10, height: 200)
+    assert_equal 0..9, list.visible_range
+
+    list.select(9)
+    data.slice!(5..)
+    list.reload
+
+    assert_equal 0..4, list.visible_range
+    assert_nil list.selection
+    app.command(:destroy, list)
+  end
+
+  tk_test "long cells are truncated to the column width" do
+    list = Teek::VirtualList.new(app, ['x' * 500], row_height: 20, height: 60,
+                                 columns: [{ width: 80 }])
+
+    text = app.command(list.canvas, :find, :all).split.map do |id|
+      app.command(list.canvas, :type, id) == 'text' ? app.command(list.canvas, :itemcget, id, '-text') : nil
+    end.compact.find { |t| t.start_with?('x') }
+
+    assert text.end_with?('...')
+    assert_operator app.text_width('TkDefaultFont', text), :<=, 80
+    app.command(:destroy, list)
+  end
+
+  tk_test "row_height must be positive" do
+    assert_raises(ArgumentError) { Teek::VirtualList.new(app, [1], row_height: 0) }
+    assert_raises(ArgumentError) { Teek::VirtualList.new(app, [1], row_height: -5) }
+  end
+
+  tk_test "small mouse wheel deltas scroll one row" do
+    list = Teek::VirtualList.new(app, (0...100).to_a, row_height: 10, height: 50)
+    list.scroll_rows(50)
+
+    list.send(:on_wheel, -7)
+    assert_equal 51, list.visible_range.first
+    list.send(:on_wheel, 2)
+    assert_equal 50, list.visible_range.first
+    list.send(:on_wheel, 240)
+    assert_equal 44, list.visible_range.first
+
+    app.command(:destroy, list)
+  end
+
+  tk_test "a tiny row cache still keeps every visible row" do
+    list = Teek::VirtualList.new(app, (0...100).map { |i| "item #{i}" },
+                                 row_height: 10, height: 50, cache_rows: 1)
+    list.scroll_rows(40)
+    list.scroll_rows(-3)
+
+    shown = visible_canvas_texts(list.canvas)
+    list.visible_range.each { |i| assert_includes shown, "item #{i}" }
+    refute_includes shown, ''
+
+    app.command(:destroy, list)
+  end
+end
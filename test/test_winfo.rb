@@ -94,4 +94,39 @@ class TestWinfo < Minitest::Test
     assert app.winfo.exists?(btn)
     assert_equal app.winfo.exists?(btn.path), app.winfo.exists?(btn)
   end
+
+  tk_test "winfo.subtree should list every descendant with its geometry" do
+    app.show
+    frame = app.create_widget('ttk::frame', width: 120, height: 80)
+    btn = app.create_widget('ttk::button', parent: frame, text: 'Hi')
+    label = app.create_widget('ttk::label', parent: frame, text: 'Lbl')
+    frame.pack
+    btn.pack
+    app.update
+
+    infos = app.winfo.subtree(frame)
+    assert_equal [frame.to_s, btn.to_s, label.to_s], infos.map(&:path)
+    assert_equal %w[TFrame TButton TLabel], infos.map(&:class_name)
+    assert_nil infos[0].parent
+    assert_equal [0, 0], infos[1..].map(&:parent)
+
+    b = infos[1]
+    assert b.mapped?
+    refute infos[2].mapped?, "unpacked label should not be mapped"
+    assert_equal [app.winfo.rootx(btn), app.winfo.rooty(btn)], [b.x, b.y]
+    assert_equal [app.winfo.width(btn), app.winfo.height(btn)], [b.width, b.height]
+  end
+
+  tk_test "winfo.subtree from the root includes toplevels" do
+    top = app.create_widget('toplevel')
+    infos = app.winfo.subtree
+    assert_equal '.', infos.first.path
+    entry = infos.find { |w| w.path == top.to_s }
+    assert entry, "toplevel missing from subtree"
+    assert entry.toplevel?
+  end
+
+  tk_test "subtree_geometry raises for a missing window" do
+    assert_raises(Teek::TclError) { app.interp.subtree_geometry('.nope') }
+  end
 end